@@ -0,0 +1,41 @@
+#include "frame_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+double FrameStats::Average() const {
+    if (samples_.empty())
+        return 0.0;
+    return std::accumulate(samples_.begin(), samples_.end(), 0.0) / static_cast<double>(samples_.size());
+}
+
+double FrameStats::Percentile(double p) const {
+    if (samples_.empty())
+        return 0.0;
+
+    std::vector<double> sorted = samples_;
+    auto rank = static_cast<size_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * sorted.size()));
+    auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(std::clamp<size_t>(rank, 1, sorted.size()) - 1);
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+double FrameStats::Min() const {
+    return samples_.empty() ? 0.0 : *std::min_element(samples_.begin(), samples_.end());
+}
+
+double FrameStats::Max() const {
+    return samples_.empty() ? 0.0 : *std::max_element(samples_.begin(), samples_.end());
+}
+
+void FrameStats::Report(std::ostream& out, const std::string& label) const {
+    double avg = Average();
+    out << std::fixed << std::setprecision(3)
+        << "[STATS] " << label << ": " << samples_.size() << " frames"
+        << " | avg " << avg << " ms (" << (avg > 0.0 ? 1000.0 / avg : 0.0) << " fps)"
+        << " | min " << Min() << " | p50 " << Percentile(50.0)
+        << " | p95 " << Percentile(95.0) << " | p99 " << Percentile(99.0)
+        << " | max " << Max() << " ms" << std::endl;
+    out.unsetf(std::ios::fixed);
+}
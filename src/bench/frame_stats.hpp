@@ -0,0 +1,45 @@
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+//
+// === FrameStats ===
+// Collects per-frame timings (milliseconds) and reports min/avg/percentiles.
+// Used by the headless runner; cheap enough to keep around in the editor.
+// With a window, only the last `window` samples are kept (ring buffer).
+//
+class FrameStats {
+public:
+    explicit FrameStats(size_t window = 0) : window_(window) {}
+
+    void Add(double milliseconds) {
+        if (window_ && samples_.size() == window_) {
+            samples_[next_] = milliseconds;
+            next_ = (next_ + 1) % window_;
+        } else {
+            samples_.push_back(milliseconds);
+        }
+    }
+    void Clear() {
+        samples_.clear();
+        next_ = 0;
+    }
+
+    [[nodiscard]] size_t Count() const { return samples_.size(); }
+    [[nodiscard]] double Average() const;
+    [[nodiscard]] double Percentile(double p) const; // p in [0, 100]
+    [[nodiscard]] double Min() const;
+    [[nodiscard]] double Max() const;
+
+    void Report(std::ostream& out, const std::string& label) const;
+
+private:
+    std::vector<double> samples_;
+    size_t window_ = 0;
+    size_t next_ = 0;
+};
+
+#endif // FRAME_STATS_HPP
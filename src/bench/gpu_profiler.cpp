@@ -0,0 +1,179 @@
+#include "gpu_profiler.hpp"
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+
+GpuProfiler& GpuProfiler::Instance() {
+    static GpuProfiler instance;
+    return instance;
+}
+
+//
+// === Zone ===
+//
+GpuProfiler::Zone::Zone(const char* name) : record_(Instance().Open(name)) {}
+
+GpuProfiler::Zone::~Zone() {
+    if (record_ >= 0)
+        Instance().Close(record_);
+}
+
+//
+// === Frames ===
+//
+void GpuProfiler::BeginFrame() {
+    if (!enabled_)
+        return;
+
+    // the slot we are about to reuse was filled kFrameLatency frames ago
+    FrameSlot& slot = frames_[current_];
+    Collect(slot);
+    slot.records.clear();
+    slot.usedQueries = 0;
+    stack_.clear();
+    inFrame_ = true;
+}
+
+void GpuProfiler::EndFrame() {
+    if (!inFrame_)
+        return;
+
+    // zones still open here were leaked by an early return, close them now
+    while (!stack_.empty())
+        Close(stack_.back());
+
+    inFrame_ = false;
+    current_ = (current_ + 1) % kFrameLatency;
+}
+
+void GpuProfiler::Reset() {
+    for (auto& zone : zones_) {
+        zone.gpu.Clear();
+        zone.cpu.Clear();
+    }
+    droppedFrames_ = 0;
+}
+
+double GpuProfiler::CpuNow() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+GLuint GpuProfiler::NextQuery(FrameSlot& slot) {
+    if (slot.usedQueries == slot.queries.size()) {
+        // grow in chunks, a new pass adds a couple of zones at most
+        size_t oldSize = slot.queries.size();
+        slot.queries.resize(oldSize + 16);
+        glGenQueries(16, slot.queries.data() + oldSize);
+    }
+    return slot.queries[slot.usedQueries++];
+}
+
+int GpuProfiler::Open(const char* name) {
+    if (!inFrame_)
+        return -1;
+
+    int depth = static_cast<int>(stack_.size());
+    auto [it, inserted] = zoneIndex_.try_emplace(name, static_cast<int>(zones_.size()));
+    if (inserted) {
+        zones_.push_back({});
+        zones_.back().name = name;
+        zones_.back().depth = depth;
+    }
+
+    FrameSlot& slot = frames_[current_];
+    GLuint query = NextQuery(slot);
+    glQueryCounter(query, GL_TIMESTAMP);
+
+    slot.records.push_back({it->second, query, 0, CpuNow(), 0.0});
+    int record = static_cast<int>(slot.records.size()) - 1;
+    stack_.push_back(record);
+    return record;
+}
+
+void GpuProfiler::Close(int record) {
+    if (!inFrame_ || stack_.empty())
+        return;
+
+    // closing out of order would break the nesting, so close everything above too
+    while (!stack_.empty()) {
+        int top = stack_.back();
+        stack_.pop_back();
+
+        FrameSlot& slot = frames_[current_];
+        Record& entry = slot.records[top];
+        entry.endQuery = NextQuery(slot);
+        glQueryCounter(entry.endQuery, GL_TIMESTAMP);
+        entry.cpuEnd = CpuNow();
+
+        if (top == record)
+            break;
+    }
+}
+
+void GpuProfiler::Collect(FrameSlot& slot) {
+    if (slot.records.empty())
+        return;
+
+    // timestamps complete in order, so the last one covers the whole frame
+    GLint available = 0;
+    glGetQueryObjectiv(slot.queries[slot.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        ++droppedFrames_;
+        return;
+    }
+
+    for (const Record& record : slot.records) {
+        if (!record.endQuery)
+            continue;
+
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(record.beginQuery, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(record.endQuery, GL_QUERY_RESULT, &end);
+
+        ZoneStats& zone = zones_[record.zone];
+        zone.gpu.Add(end > begin ? static_cast<double>(end - begin) / 1.0e6 : 0.0);
+        zone.cpu.Add(record.cpuEnd - record.cpuBegin);
+    }
+}
+
+//
+// === Output ===
+//
+void GpuProfiler::Report(std::ostream& out) const {
+    out << std::fixed << std::setprecision(3);
+    for (const auto& zone : zones_) {
+        out << "[PROFILER] " << std::string(zone.depth * 2, ' ') << zone.name << ": " << zone.gpu.Count()
+            << " frames | gpu avg " << zone.gpu.Average() << " p50 " << zone.gpu.Percentile(50.0) << " p95 "
+            << zone.gpu.Percentile(95.0) << " p99 " << zone.gpu.Percentile(99.0) << " ms | cpu avg "
+            << zone.cpu.Average() << " p95 " << zone.cpu.Percentile(95.0) << " ms" << std::endl;
+    }
+    if (droppedFrames_)
+        out << "[PROFILER] " << droppedFrames_ << " frames dropped (results not ready in time)" << std::endl;
+    out.unsetf(std::ios::fixed);
+}
+
+void GpuProfiler::DrawOverlay() const {
+    if (!overlayVisible_ || zones_.empty())
+        return;
+
+    ImDrawList* drawList = ImGui::GetForegroundDrawList();
+    ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+    const float padding = 5.f, lineH = 16.f, width = 330.f;
+    float height = lineH * (zones_.size() + 1) + padding * 2;
+    float x = displaySize.x - width - padding, y = padding;
+
+    drawList->AddRectFilled({x, y}, {x + width, y + height}, IM_COL32(40, 40, 40, 220));
+    drawList->AddRect({x, y}, {x + width, y + height}, IM_COL32(235, 203, 139, 200), 0.f, 0, 1.5f);
+    drawList->AddText({x + padding, y + padding}, IM_COL32(235, 203, 139, 255), "pass          gpu ms  p95     cpu ms");
+
+    char line[128];
+    float lineY = y + padding + lineH;
+    for (const auto& zone : zones_) {
+        std::snprintf(line, sizeof(line), "%*s%-*s %6.2f  %6.2f  %6.2f", zone.depth * 2, "",
+                      std::max(1, 12 - zone.depth * 2), zone.name.c_str(), zone.gpu.Average(),
+                      zone.gpu.Percentile(95.0), zone.cpu.Average());
+        drawList->AddText({x + padding, lineY}, IM_COL32(215, 153, 33, 255), line);
+        lineY += lineH;
+    }
+}
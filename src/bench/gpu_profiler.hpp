@@ -0,0 +1,108 @@
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+#include "frame_stats.hpp"
+#include <glad/glad.h>
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// === GpuProfiler ===
+// Scoped CPU + GPU timing per render pass. Each Zone takes a CPU timestamp
+// and issues a GL_TIMESTAMP query (glQueryCounter) when it opens and closes,
+// so zones nest freely, unlike GL_TIME_ELAPSED. Queries live in one slot per
+// frame in flight; a slot is read back kFrameLatency frames later, and only if
+// its last query is available, otherwise that frame is dropped. Nothing ever
+// waits on the GPU.
+//
+// GL thread only. Zones opened outside BeginFrame/EndFrame are ignored.
+//
+class GpuProfiler {
+  public:
+    static constexpr int kFrameLatency = 3;
+    static constexpr size_t kHistory = 240; // samples kept per zone
+
+    struct ZoneStats {
+        std::string name;
+        int depth = 0;
+        FrameStats gpu{kHistory};
+        FrameStats cpu{kHistory};
+    };
+
+    class Zone {
+      public:
+        explicit Zone(const char* name);
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+      private:
+        int record_;
+    };
+
+    static GpuProfiler& Instance();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    void BeginFrame();
+    void EndFrame();
+
+    void SetEnabled(bool enabled) { enabled_ = enabled; }
+    [[nodiscard]] bool IsEnabled() const { return enabled_; }
+
+    void SetOverlayVisible(bool visible) { overlayVisible_ = visible; }
+    [[nodiscard]] bool IsOverlayVisible() const { return overlayVisible_; }
+
+    // Adds the overlay to the current ImGui frame when visible.
+    void DrawOverlay() const;
+    // One line per zone, in first-seen order: avg/p50/p95/p99 for GPU and CPU.
+    void Report(std::ostream& out) const;
+    void Reset();
+
+    [[nodiscard]] const std::vector<ZoneStats>& GetZones() const { return zones_; }
+    [[nodiscard]] size_t GetDroppedFrames() const { return droppedFrames_; }
+
+  private:
+    struct Record {
+        int zone;
+        GLuint beginQuery;
+        GLuint endQuery;
+        double cpuBegin;
+        double cpuEnd;
+    };
+
+    struct FrameSlot {
+        std::vector<Record> records;
+        std::vector<GLuint> queries;
+        size_t usedQueries = 0;
+    };
+
+    // queries are left to the context teardown, the singleton outlives it
+    GpuProfiler() = default;
+
+    int Open(const char* name);
+    void Close(int record);
+    GLuint NextQuery(FrameSlot& slot);
+    void Collect(FrameSlot& slot);
+    double CpuNow() const;
+
+    bool enabled_ = true;
+    bool overlayVisible_ = false;
+    bool inFrame_ = false;
+    int current_ = 0;
+    size_t droppedFrames_ = 0;
+
+    std::array<FrameSlot, kFrameLatency> frames_;
+    std::vector<int> stack_;
+    std::vector<ZoneStats> zones_;
+    std::unordered_map<std::string, int> zoneIndex_;
+    std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+};
+
+#endif // GPU_PROFILER_HPP
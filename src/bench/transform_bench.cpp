@@ -0,0 +1,73 @@
+#include "transform_bench.hpp"
+#include "frame_stats.hpp"
+#include "../entity/transform_kernels.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace {
+
+template <typename Fn>
+double MedianNs(size_t count, int repeats, Fn&& fn) {
+    FrameStats stats;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        stats.Add(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return stats.Percentile(50.0) / static_cast<double>(std::max<size_t>(count, 1));
+}
+
+float MaxError(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b) {
+    float error = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i)
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                error = std::max(error, std::abs(a[i][c][r] - b[i][c][r]));
+    return error;
+}
+
+} // namespace
+
+namespace TransformBench {
+
+std::vector<Result> Run(size_t count, int repeats) {
+    // fixed seed so runs are comparable
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f), angle(-360.0f, 360.0f), scale(0.1f, 4.0f);
+    std::vector<Transform> transforms(count);
+    for (Transform& t : transforms) {
+        t.position = {position(rng), position(rng), position(rng)};
+        t.rotation = {angle(rng), angle(rng), angle(rng)};
+        t.scale = {scale(rng), scale(rng), scale(rng)};
+    }
+
+    std::vector<glm::mat4> reference(count), models(count);
+    std::vector<Result> results;
+
+    Result glmResult{"glm GetModelMatrix"};
+    glmResult.nsPerTransform = MedianNs(count, repeats, [&] {
+        for (size_t i = 0; i < count; ++i)
+            reference[i] = transforms[i].GetModelMatrix();
+    });
+    results.push_back(glmResult);
+
+    using TransformKernels::Path;
+    for (Path path : {Path::Scalar, Path::SSE2, Path::AVX2}) {
+        if (!TransformKernels::IsSupported(path))
+            continue;
+
+        Result result{std::string("kernel ") + TransformKernels::PathName(path)};
+        result.nsPerTransform = MedianNs(count, repeats, [&] {
+            TransformKernels::ComposeModelMatrices(transforms, models, path);
+        });
+        result.speedup = result.nsPerTransform > 0.0 ? glmResult.nsPerTransform / result.nsPerTransform : 0.0;
+        result.maxError = MaxError(reference, models);
+        results.push_back(result);
+    }
+    return results;
+}
+
+} // namespace TransformBench
@@ -0,0 +1,28 @@
+#ifndef TRANSFORM_BENCH_HPP
+#define TRANSFORM_BENCH_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//
+// === TransformBench ===
+// Micro-benchmark for model matrix composition: Transform::GetModelMatrix
+// (the glm translate/rotate x3/scale chain) against every TransformKernels
+// path the CPU supports, on the same random transforms. Reports the median
+// of `repeats` runs and the worst element error against the glm result.
+//
+namespace TransformBench {
+
+struct Result {
+    std::string name;
+    double nsPerTransform = 0.0;
+    double speedup = 1.0; // vs glm
+    float maxError = 0.0f;
+};
+
+std::vector<Result> Run(size_t count, int repeats = 9);
+
+} // namespace TransformBench
+
+#endif // TRANSFORM_BENCH_HPP
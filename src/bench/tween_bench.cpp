@@ -0,0 +1,56 @@
+#include "tween_bench.hpp"
+#include "frame_stats.hpp"
+#include "../world/tween_system.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace TweenBench {
+
+std::vector<Result> Run(size_t count, int repeats) {
+    // fixed seed so runs are comparable; long tweens so none finish mid-run
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> value(-100.0f, 100.0f), seconds(60.0f, 120.0f);
+    TweenSystem tweens;
+    for (size_t i = 0; i < count; ++i) {
+        static constexpr ParamType kTypes[] = {ParamType::Float, ParamType::Vec2, ParamType::Vec3, ParamType::Vec4};
+        size_t lanes = i % 4 + 1;
+        float from[4], to[4];
+        for (size_t l = 0; l < lanes; ++l) {
+            from[l] = value(rng);
+            to[l] = value(rng);
+        }
+        Tween tween = i % 8 == 7 ? Tween::Spring(seconds(rng), 2.0f, 0.4f) : Tween::Bezier(seconds(rng), 1.0f, 1.0f);
+        EntityHandle handle;
+        handle.index = static_cast<uint32_t>(i);
+        tweens.Add(handle, ParamKeys::Intensity, kTypes[lanes - 1], std::span<const float>(from, lanes),
+                   std::span<const float>(to, lanes), tween);
+    }
+
+    std::vector<Result> results;
+    double scalarNs = 0.0;
+    using TransformKernels::Path;
+    for (Path path : {Path::Scalar, Path::SSE2, Path::AVX2}) {
+        if (!TransformKernels::IsSupported(path))
+            continue;
+
+        FrameStats stats;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            tweens.Advance(1.0f / 60.0f, path);
+            auto end = std::chrono::steady_clock::now();
+            stats.Add(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+
+        Result result{std::string("advance ") + TransformKernels::PathName(path)};
+        result.msTotal = stats.Percentile(50.0) / 1e6;
+        result.nsPerTrack = stats.Percentile(50.0) / static_cast<double>(std::max<size_t>(count, 1));
+        if (path == Path::Scalar)
+            scalarNs = result.nsPerTrack;
+        result.speedup = result.nsPerTrack > 0.0 ? scalarNs / result.nsPerTrack : 0.0;
+        results.push_back(result);
+    }
+    return results;
+}
+
+} // namespace TweenBench
@@ -0,0 +1,29 @@
+#ifndef TWEEN_BENCH_HPP
+#define TWEEN_BENCH_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//
+// === TweenBench ===
+// Micro-benchmark for TweenSystem::Advance over every TransformKernels path
+// the CPU supports: count tracks on made-up entities, a mix of float and
+// vec2/3/4 lanes with every eighth a spring. Reports the median of
+// `repeats` runs per track; the write-back to CParams isn't included
+// (/tween shows what it wrote last frame).
+//
+namespace TweenBench {
+
+struct Result {
+    std::string name;
+    double nsPerTrack = 0.0;
+    double msTotal = 0.0;
+    double speedup = 1.0; // vs scalar
+};
+
+std::vector<Result> Run(size_t count, int repeats = 9);
+
+} // namespace TweenBench
+
+#endif // TWEEN_BENCH_HPP
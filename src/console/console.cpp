@@ -1,8 +1,76 @@
 #include "Console.hpp"
-#include <future>
+#include "../bench/gpu_profiler.hpp"
+#include "../bench/transform_bench.hpp"
+#include "../bench/tween_bench.hpp"
+#include "../entity/param_index.hpp"
+#include "../entity/transform_kernels.hpp"
+#include "../jobs/job_system.hpp"
+#include "../rendering/texture/texture_cache.hpp"
+#include "../world/scene_file.hpp"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
 
+namespace {
+
+std::string JoinArgs(std::vector<std::string>::const_iterator begin, std::vector<std::string>::const_iterator end) {
+    std::string joined;
+    for (auto it = begin; it != end; ++it)
+        joined += (joined.empty() ? "" : " ") + *it;
+    return joined;
+}
+
+// One number is a float, two to four make a vector, anything else is text.
+CParams::Value ParseParamValue(std::vector<std::string>::const_iterator begin,
+                               std::vector<std::string>::const_iterator end) {
+    float numbers[4] = {};
+    size_t count = 0;
+    for (auto it = begin; it != end; ++it, ++count) {
+        if (count == 4)
+            return JoinArgs(begin, end);
+        auto [last, error] = std::from_chars(it->data(), it->data() + it->size(), numbers[count]);
+        if (error != std::errc() || last != it->data() + it->size())
+            return JoinArgs(begin, end);
+    }
+
+    switch (count) {
+    case 1: return numbers[0];
+    case 2: return glm::vec2(numbers[0], numbers[1]);
+    case 3: return glm::vec3(numbers[0], numbers[1], numbers[2]);
+    case 4: return glm::vec4(numbers[0], numbers[1], numbers[2], numbers[3]);
+    default: return std::string();
+    }
+}
+
+// Int params stay int. Whatever is derived from the param follows at the
+// next param sync (World::SyncParams).
+void ApplyParam(BaseEntity &entity, const std::string &key, CParams::Value value) {
+    if (entity.Params().TypeOf(key) == ParamType::Int && std::holds_alternative<float>(value))
+        value = static_cast<int>(std::lround(std::get<float>(value)));
+    entity.Params().Set(key, std::move(value));
+}
+
+// What params took as one vector of {key, variant} entries, the layout
+// before type-segregated pools; the baseline /parammem compares against.
+size_t VariantLayoutBytes(const CParams &params) {
+    struct VariantEntry {
+        ParamKey key;
+        CParams::Value value;
+    };
+    size_t bytes = sizeof(std::pmr::vector<VariantEntry>) + sizeof(CParams::Observer *) + sizeof(EntityHandle) +
+                   params.Size() * sizeof(VariantEntry);
+    for (const CParams::Entry &entry : params.All()) {
+        if (entry.GetType() == ParamType::String && params.ReadString(entry).size() > std::string().capacity())
+            bytes += params.ReadString(entry).size() + 1;
+    }
+    return bytes;
+}
+
+} // namespace
+
 Console::Console(World *world, ImGuiIO *io) : WorldPointer(world), IOContext(io) {
     Log("[CONSOLE] Initialized console system");
     RegisterDefaultCommands();
@@ -119,8 +187,10 @@ void Console::Execute(const std::string &commandLine) {
     }
 }
 
+// Commands touch the World, so they stay on the main thread: the job runs at
+// the next frame's RunMainThreadJobs() instead of racing the frame.
 void Console::ExecuteAsync(const std::string &commandLine) {
-    std::thread([this, commandLine]() { Execute(commandLine); }).detach();
+    JobSystem::Instance().ScheduleOnMainThread([this, commandLine]() { Execute(commandLine); });
 }
 
 void Console::ExecuteScript(const std::string &script) {
@@ -391,7 +461,641 @@ void Console::RegisterDefaultCommands() {
                              size_t idx = 0;
                              for (auto &e : self->WorldPointer->GetEntities()) {
                                  if (e)
-                                     self->Log(std::to_string(idx++) + ": " + e->GetName());
+                                     self->Log(std::to_string(idx++) + ": " + std::string(e->GetName()));
                              }
                          }};
+
+    Commands["/lights"] = {"lights", "Shows clustered lighting statistics", [](Console *self, const std::vector<std::string> &) {
+                               const auto &lighting = self->WorldPointer->GetLighting();
+                               self->Log("Lights: " + std::to_string(self->WorldPointer->GetLightCount()) +
+                                         " (visible: " + std::to_string(lighting.GetLightCount()) + ")");
+                               self->Log("Cluster indices: " + std::to_string(lighting.GetIndexCount()) +
+                                         ", max per cluster: " + std::to_string(lighting.GetMaxLightsPerCluster()));
+                           }};
+
+    Commands["/spawn"] = {"spawn", "Spawns an entity: spawn <name> <mesh> <shader> [x y z]",
+                          [](Console *self, const std::vector<std::string> &args) {
+                              if (args.size() < 3) {
+                                  self->Log("[USAGE] spawn <name> <mesh> <shader> [x y z]");
+                                  return;
+                              }
+                              glm::vec3 position(0.0f);
+                              for (size_t i = 0; i < 3 && i + 3 < args.size(); ++i)
+                                  position[static_cast<int>(i)] = std::stof(args[i + 3]);
+
+                              auto entity = self->WorldPointer->CreateEntity(position, glm::vec3(0.0f),
+                                                                             glm::vec3(1.0f), args[0].c_str());
+                              entity->Params().Set(ParamKeys::Mesh, args[1]);
+                              entity->Params().Set(ParamKeys::Shader, args[2]);
+                          }};
+
+    Commands["/light"] = {"light", "Spawns a point light: light <name> <x> <y> <z> [r g b] [radius] [intensity]",
+                          [](Console *self, const std::vector<std::string> &args) {
+                              if (args.size() < 4) {
+                                  self->Log("[USAGE] light <name> <x> <y> <z> [r g b] [radius] [intensity]");
+                                  return;
+                              }
+                              glm::vec3 position(std::stof(args[1]), std::stof(args[2]), std::stof(args[3]));
+                              PointLight light;
+                              if (args.size() >= 7)
+                                  light.color = glm::vec3(std::stof(args[4]), std::stof(args[5]), std::stof(args[6]));
+                              if (args.size() >= 8)
+                                  light.radius = std::stof(args[7]);
+                              if (args.size() >= 9)
+                                  light.intensity = std::stof(args[8]);
+
+                              self->WorldPointer->CreateLight(position, light, args[0].c_str());
+                          }};
+
+    Commands["/textures"] = {"textures", "Lists textures with VRAM use and savings vs RGBA8",
+                             [](Console *self, const std::vector<std::string> &) {
+                                 auto &cache = TextureCache::Instance();
+                                 size_t total = 0, saved = 0;
+                                 for (const auto &texture : cache.GetTextures()) {
+                                     if (!texture->IsReady())
+                                         continue;
+                                     size_t bytes = texture->GetByteSize(), rgba8 = texture->GetRgba8Size();
+                                     size_t delta = rgba8 - std::min(rgba8, bytes);
+                                     total += bytes;
+                                     saved += delta;
+                                     self->Log(texture->GetPath() + " [" + BlockCompression::FormatName(texture->GetFormat()) +
+                                               "] " + std::to_string(bytes / 1024) + " KB, saved " +
+                                               std::to_string(delta / 1024) + " KB");
+                                 }
+                                 self->Log("Textures cached: " + std::to_string(cache.GetCachedCount()) +
+                                           ", pending: " + std::to_string(cache.GetPendingCount()) + ", VRAM " +
+                                           std::to_string(total / 1024) + " KB, saved " + std::to_string(saved / 1024) + " KB");
+                             }};
+
+    Commands["/texpack"] = {"texpack", "Texture packing on|off and array/batching stats",
+                            [](Console *self, const std::vector<std::string> &args) {
+                                auto &cache = TextureCache::Instance();
+                                if (!args.empty())
+                                    cache.SetPackingEnabled(args[0] == "on" || args[0] == "1");
+
+                                const TexturePacker &packer = cache.GetPacker();
+                                self->Log(std::string("Packing ") + (cache.IsPackingEnabled() ? "on" : "off") +
+                                          " (applies to textures loaded from now on)");
+                                self->Log("Arrays: " + std::to_string(packer.GetArrayCount()) + ", atlas entries: " +
+                                          std::to_string(packer.GetAtlasEntryCount()) + ", VRAM " +
+                                          std::to_string(packer.GetByteSize() / 1024) + " KB");
+                                self->Log("Last frame: " + std::to_string(self->WorldPointer->GetDrawCallCount()) +
+                                          " draw calls, " + std::to_string(self->WorldPointer->GetInstancedCount()) +
+                                          " instanced entities, " +
+                                          std::to_string(self->WorldPointer->GetChangedEntities().size()) +
+                                          " transforms rebuilt");
+                            }};
+
+    Commands["/resolution"] = {"resolution", "Dynamic resolution: [target <ms>] [pin <scale>|auto] [sharpen <0-1>] [on|off]",
+                               [](Console *self, const std::vector<std::string> &args) {
+                                   DynamicResolution *resolution = self->ResolutionPointer;
+                                   if (!resolution) {
+                                       self->Log("Dynamic resolution is not available");
+                                       return;
+                                   }
+
+                                   for (size_t i = 0; i < args.size(); ++i) {
+                                       bool hasValue = i + 1 < args.size();
+                                       if (args[i] == "target" && hasValue)
+                                           resolution->SetTargetTime(std::stof(args[++i]));
+                                       else if (args[i] == "pin" && hasValue)
+                                           resolution->PinScale(std::stof(args[++i]));
+                                       else if (args[i] == "auto")
+                                           resolution->Unpin();
+                                       else if (args[i] == "sharpen" && hasValue)
+                                           resolution->SetSharpness(std::stof(args[++i]));
+                                       else if (args[i] == "on" || args[i] == "off")
+                                           resolution->SetEnabled(args[i] == "on");
+                                       else
+                                           self->Log("Unknown option: " + args[i]);
+                                   }
+
+                                   std::ostringstream out;
+                                   out << std::fixed << std::setprecision(2) << "Resolution "
+                                       << (resolution->IsEnabled() ? "on" : "off") << ", scale " << resolution->GetScale()
+                                       << (resolution->IsPinned() ? " (pinned)" : " (auto)") << ", "
+                                       << resolution->GetRenderWidth() << "x" << resolution->GetRenderHeight()
+                                       << ", scene GPU " << resolution->GetGpuTime() << " ms / target "
+                                       << resolution->GetTargetTime() << " ms";
+                                   self->Log(out.str());
+                               }};
+
+    Commands["/profiler"] = {"profiler", "Per pass GPU/CPU timings: [overlay on|off] [reset] [on|off]",
+                             [](Console *self, const std::vector<std::string> &args) {
+                                 auto &profiler = GpuProfiler::Instance();
+                                 for (size_t i = 0; i < args.size(); ++i) {
+                                     if (args[i] == "overlay" && i + 1 < args.size())
+                                         profiler.SetOverlayVisible(args[++i] == "on");
+                                     else if (args[i] == "reset")
+                                         profiler.Reset();
+                                     else if (args[i] == "on" || args[i] == "off")
+                                         profiler.SetEnabled(args[i] == "on");
+                                     else
+                                         self->Log("Unknown option: " + args[i]);
+                                 }
+
+                                 std::ostringstream out;
+                                 profiler.Report(out);
+                                 std::istringstream lines(out.str());
+                                 for (std::string line; std::getline(lines, line);)
+                                     self->Log(line);
+                             }};
+
+    Commands["/clone"] = {"clone", "Spawns copies of an entity in a row: clone <entity> <count> [spacing]",
+                          [](Console *self, const std::vector<std::string> &args) {
+                              if (args.size() < 2) {
+                                  self->Log("[USAGE] clone <entity> <count> [spacing]");
+                                  return;
+                              }
+                              auto prototype = self->FindEntity(args[0]);
+                              if (!prototype) {
+                                  self->Log("[ERROR] Entity not found: " + args[0]);
+                                  return;
+                              }
+                              size_t count = std::stoul(args[1]);
+                              float spacing = args.size() > 2 ? std::stof(args[2]) : 2.0f;
+
+                              glm::vec3 origin = prototype->GetTransform().position;
+                              auto clones = self->WorldPointer->CreateEntities(count, *prototype);
+                              for (size_t i = 0; i < clones.size(); ++i) {
+                                  glm::vec3 position = origin + glm::vec3(spacing * static_cast<float>(i + 1), 0.0f, 0.0f);
+                                  clones[i]->Params().Set(ParamKeys::Position, position);
+                              }
+                          }};
+
+    Commands["/destroy"] = {"destroy", "Destroys every entity with that name at the end of the frame: destroy <name>",
+                            [](Console *self, const std::vector<std::string> &args) {
+                                if (args.empty()) {
+                                    self->Log("[USAGE] destroy <name>");
+                                    return;
+                                }
+                                auto handles = self->WorldPointer->GetStore().FindAll(args[0]);
+                                self->WorldPointer->DestroyEntities(handles);
+                                self->Log("Queued " + std::to_string(handles.size()) + " entities for destruction");
+                            }};
+
+    Commands["/bench"] = {"bench", "Micro-benchmarks: bench transforms|tweens [count] [repeats]",
+                          [](Console *self, const std::vector<std::string> &args) {
+                              if (args.empty() || (args[0] != "transforms" && args[0] != "tweens")) {
+                                  self->Log("[USAGE] bench transforms|tweens [count] [repeats]");
+                                  return;
+                              }
+                              if (args[0] == "tweens") {
+                                  size_t count = args.size() > 1 ? std::stoul(args[1]) : 100000;
+                                  int repeats = args.size() > 2 ? std::stoi(args[2]) : 9;
+                                  self->Log("[BENCH] " + std::to_string(count) + " tweens, median of " +
+                                            std::to_string(repeats) + ", " +
+                                            std::to_string(JobSystem::Instance().GetWorkerCount()) + " workers");
+                                  char line[160];
+                                  for (const auto &result : TweenBench::Run(count, repeats)) {
+                                      std::snprintf(line, sizeof(line), "[BENCH] %-20s %8.2f ns/track  %7.3f ms  %5.2fx",
+                                                    result.name.c_str(), result.nsPerTrack, result.msTotal,
+                                                    result.speedup);
+                                      self->Log(line);
+                                  }
+                                  return;
+                              }
+                              size_t count = args.size() > 1 ? std::stoul(args[1]) : 10000;
+                              int repeats = args.size() > 2 ? std::stoi(args[2]) : 9;
+
+                              self->Log("[BENCH] " + std::to_string(count) + " transforms, median of " +
+                                        std::to_string(repeats) + ", active path: " +
+                                        TransformKernels::PathName(TransformKernels::GetActivePath()));
+                              char line[160];
+                              for (const auto &result : TransformBench::Run(count, repeats)) {
+                                  std::snprintf(line, sizeof(line), "[BENCH] %-20s %8.2f ns/transform  %5.2fx  max err %.2e",
+                                                result.name.c_str(), result.nsPerTransform, result.speedup,
+                                                result.maxError);
+                                  self->Log(line);
+                              }
+                          }};
+
+    Commands["/parent"] = {"parent", "Attaches an entity to another (keeps its local transform): parent <child> <parent|root>",
+                           [](Console *self, const std::vector<std::string> &args) {
+                               if (args.size() < 2) {
+                                   self->Log("[USAGE] parent <child> <parent|root>");
+                                   return;
+                               }
+                               auto child = self->FindEntity(args[0]);
+                               auto parent = args[1] == "root" ? nullptr : self->FindEntity(args[1]);
+                               if (!child || (!parent && args[1] != "root")) {
+                                   self->Log("[ERROR] Entity not found");
+                                   return;
+                               }
+                               if (!self->WorldPointer->SetParent(child, parent))
+                                   self->Log("[ERROR] Cannot parent " + args[0] + " to " + args[1]);
+                           }};
+
+    Commands["/tree"] = {"tree", "Lists entities as a hierarchy", [](Console *self, const std::vector<std::string> &) {
+                             const EntityStore &store = self->WorldPointer->GetStore();
+                             store.Traverse([&](EntityHandle handle, int depth) {
+                                 self->Log(std::string(depth * 2, ' ').append(store.GetEntity(handle)->GetName()));
+                             });
+                         }};
+
+    Commands["/pick"] = {"pick", "Entity under a screen point (NDC, default the center): pick [x y]",
+                         [](Console *self, const std::vector<std::string> &args) {
+                             float x = args.size() >= 2 ? std::stof(args[0]) : 0.0f;
+                             float y = args.size() >= 2 ? std::stof(args[1]) : 0.0f;
+                             ImVec2 display = self->IOContext->DisplaySize;
+                             float aspect = display.y > 0.0f ? display.x / display.y : 1.0f;
+
+                             float distance = 0.0f;
+                             auto entity = self->WorldPointer->Pick(x, y, aspect, &distance);
+                             if (!entity) {
+                                 self->Log("Nothing there");
+                                 return;
+                             }
+                             std::ostringstream out;
+                             out << std::fixed << std::setprecision(2) << entity->GetName() << " at " << distance;
+                             self->Log(out.str());
+                         }};
+
+    Commands["/near"] = {"near", "Entities whose bounds touch a sphere: near <entity|x y z> <radius>",
+                         [](Console *self, const std::vector<std::string> &args) {
+                             glm::vec3 center;
+                             if (args.size() == 2) {
+                                 auto entity = self->FindEntity(args[0]);
+                                 if (!entity) {
+                                     self->Log("Entity not found: " + args[0]);
+                                     return;
+                                 }
+                                 center = glm::vec3(entity->GetModelMatrix()[3]);
+                             } else if (args.size() == 4) {
+                                 center = glm::vec3(std::stof(args[0]), std::stof(args[1]), std::stof(args[2]));
+                             } else {
+                                 self->Log("[USAGE] near <entity|x y z> <radius>");
+                                 return;
+                             }
+
+                             World *world = self->WorldPointer;
+                             world->SyncSpatialIndex();
+                             std::vector<EntityHandle> found;
+                             world->GetSpatialIndex().QuerySphere(center, std::stof(args.back()), found);
+                             self->Log(std::to_string(found.size()) + " entities:");
+                             for (size_t i = 0; i < found.size() && i < 32; ++i)
+                                 self->Log("  " + std::string(world->GetEntity(found[i])->GetName()));
+                             if (found.size() > 32)
+                                 self->Log("  ...");
+                         }};
+
+    Commands["/culling"] = {"culling", "Frustum culling through the spatial index: culling [on|off]",
+                            [](Console *self, const std::vector<std::string> &args) {
+                                World *world = self->WorldPointer;
+                                if (!args.empty())
+                                    world->SetCulling(args[0] == "on");
+                                const SpatialIndex &index = world->GetSpatialIndex();
+                                self->Log(std::string("Culling ") + (world->IsCullingEnabled() ? "on" : "off") +
+                                          ", last frame " + std::to_string(world->GetVisibleCount()) + " of " +
+                                          std::to_string(world->GetEntityCount()) + " visible, index " +
+                                          std::to_string(index.Size()) + " entities, height " +
+                                          std::to_string(index.GetHeight()) + ", " +
+                                          std::to_string(index.GetReinsertedCount()) + " reinserted");
+                            }};
+
+    Commands["/arena"] = {"arena", "Memory the world's entities, names and params take from its arena",
+                          [](Console *self, const std::vector<std::string> &) {
+                              const World *world = self->WorldPointer;
+                              const WorldArena &arena = world->GetArena();
+                              size_t entities = std::max<size_t>(world->GetEntityCount(), 1);
+                              self->Log("Arena: " + std::to_string(arena.GetLiveBytes() / 1024) + " KB live in " +
+                                        std::to_string(arena.GetLiveAllocations()) + " allocations (" +
+                                        std::to_string(arena.GetLiveBytes() / entities) + " B/entity), " +
+                                        std::to_string(arena.GetReservedBytes() / 1024) + " KB reserved in " +
+                                        std::to_string(arena.GetChunkCount()) + " chunks");
+                          }};
+
+    Commands["/find"] = {"find", "Entities matching param conditions: find <param> <op> <value> [and ...]",
+                         [](Console *self, const std::vector<std::string> &args) {
+                             auto query = EntityQuery::Parse(JoinArgs(args.begin(), args.end()));
+                             if (!query) {
+                                 self->Log("[USAGE] find <param> <op> <value> [and ...], op is < <= > >= == !=");
+                                 return;
+                             }
+
+                             World *world = self->WorldPointer;
+                             std::vector<EntityHandle> found;
+                             auto start = std::chrono::steady_clock::now();
+                             bool indexed = world->GetStore().Query(*query, found);
+                             double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                             std::ostringstream out;
+                             out << found.size() << " matches (" << (indexed ? "index" : "scan") << ", " << std::fixed
+                                 << std::setprecision(3) << ms << " ms)";
+                             self->Log(out.str());
+                             for (size_t i = 0; i < found.size() && i < 32; ++i)
+                                 self->Log("  " + std::string(world->GetEntity(found[i])->GetName()));
+                             if (found.size() > 32)
+                                 self->Log("  ...");
+                         }};
+
+    Commands["/index"] = {"index", "Secondary index on an entity param for find/update: index [param [off]]",
+                          [](Console *self, const std::vector<std::string> &args) {
+                              EntityStore &store = self->WorldPointer->GetStore();
+                              if (args.size() >= 2 && args[1] == "off")
+                                  store.UnindexParam(args[0]);
+                              else if (!args.empty())
+                                  store.IndexParam(args[0]);
+
+                              const ParamIndex &index = store.GetParamIndex();
+                              auto keys = index.GetKeys();
+                              if (keys.empty())
+                                  self->Log("No params indexed");
+                              for (const auto &key : keys)
+                                  self->Log("  " + key + ": " + std::to_string(index.GetEntryCount(key)) + " entries");
+                          }};
+
+    Commands["/set"] = {"set", "Sets an entity param: set <entity> <param> <value...>",
+                        [](Console *self, const std::vector<std::string> &args) {
+                            if (args.size() < 3) {
+                                self->Log("[USAGE] set <entity> <param> <value...>");
+                                return;
+                            }
+                            auto entity = self->FindEntity(args[0]);
+                            if (!entity) {
+                                self->Log("Entity not found: " + args[0]);
+                                return;
+                            }
+                            ApplyParam(*entity, args[1], ParseParamValue(args.begin() + 2, args.end()));
+                        }};
+
+    Commands["/update"] = {"update", "Sets a param on every match: update <param> <value...> where <conditions>",
+                           [](Console *self, const std::vector<std::string> &args) {
+                               auto where = std::find(args.begin(), args.end(), "where");
+                               auto query = where == args.end() ? std::nullopt
+                                                                : EntityQuery::Parse(JoinArgs(where + 1, args.end()));
+                               if (args.size() < 2 || where < args.begin() + 2 || !query) {
+                                   self->Log("[USAGE] update <param> <value...> where <param> <op> <value> [and ...]");
+                                   return;
+                               }
+
+                               World *world = self->WorldPointer;
+                               std::vector<EntityHandle> found;
+                               world->GetStore().Query(*query, found);
+                               CParams::Value value = ParseParamValue(args.begin() + 1, where);
+                               // matches are collected first, changing them can't disturb the query
+                               for (EntityHandle handle : found)
+                                   ApplyParam(*world->GetEntity(handle), args[0], value);
+                               self->Log("Updated " + std::to_string(found.size()) + " entities");
+                           }};
+
+    Commands["/jobs"] = {"jobs", "Job system workers and how many jobs ran / were stolen so far",
+                         [](Console *self, const std::vector<std::string> &) {
+                             JobSystem &jobs = JobSystem::Instance();
+                             JobSystem::Stats stats = jobs.GetStats();
+                             self->Log("Jobs: " + std::to_string(jobs.GetWorkerCount()) + " workers, " +
+                                       std::to_string(stats.executed) + " executed, " +
+                                       std::to_string(stats.stolen) + " stolen");
+                         }};
+
+    Commands["/behave"] = {
+        "behave",
+        "Per step behaviors: behave <entity|*> spin <x y z> | bob <x y z> <hz> | wave <param> <base> <amp> <hz> | "
+        "script <seconds> <command...> | clear",
+        [](Console *self, const std::vector<std::string> &args) {
+            if (args.size() < 2) {
+                self->Log("[USAGE] behave <entity|*> spin|bob|wave|script|clear ...");
+                return;
+            }
+
+            World *world = self->WorldPointer;
+            std::vector<std::shared_ptr<BaseEntity>> targets;
+            if (args[0] == "*") {
+                auto entities = world->GetEntities();
+                targets.assign(entities.begin(), entities.end());
+            } else if (auto entity = self->FindEntity(args[0])) {
+                targets.push_back(std::move(entity));
+            } else {
+                self->Log("Entity not found: " + args[0]);
+                return;
+            }
+
+            const std::string &kind = args[1];
+            if (kind == "clear") {
+                size_t removed = 0;
+                for (const auto &entity : targets)
+                    removed += world->RemoveBehaviors(entity);
+                self->Log("Removed " + std::to_string(removed) + " behaviors");
+                return;
+            }
+
+            Behavior behavior;
+            if (kind == "spin" && args.size() == 5) {
+                behavior = Behavior::Spin({std::stof(args[2]), std::stof(args[3]), std::stof(args[4])});
+            } else if (kind == "bob" && args.size() == 6) {
+                behavior = Behavior::Bob({std::stof(args[2]), std::stof(args[3]), std::stof(args[4])}, std::stof(args[5]));
+            } else if (kind == "wave" && args.size() == 6) {
+                behavior = Behavior::ParamWave(args[2], std::stof(args[3]), std::stof(args[4]), std::stof(args[5]));
+            } else if (kind == "script" && args.size() >= 4) {
+                // runs the command every <seconds> of simulated time
+                float interval = std::max(std::stof(args[2]), 0.0f);
+                std::string command = JoinArgs(args.begin() + 3, args.end());
+                behavior = Behavior::Custom([self, interval, command, elapsed = 0.0f](EntityHandle, float step) mutable {
+                    elapsed += step;
+                    if (elapsed < interval)
+                        return;
+                    elapsed = interval > 0.0f ? std::fmod(elapsed, interval) : 0.0f;
+                    self->Execute(command);
+                });
+            } else {
+                self->Log("[USAGE] behave <entity|*> spin <x y z> | bob <x y z> <hz> | wave <param> <base> <amp> <hz> | "
+                          "script <seconds> <command...> | clear");
+                return;
+            }
+
+            size_t added = 0;
+            for (const auto &entity : targets)
+                added += world->AddBehavior(entity, behavior) ? 1 : 0;
+            self->Log("Added " + kind + " to " + std::to_string(added) + " entities");
+        }};
+
+    Commands["/timestep"] = {"timestep", "Simulation rate and stats: timestep [hz]",
+                             [](Console *self, const std::vector<std::string> &args) {
+                                 World *world = self->WorldPointer;
+                                 if (!args.empty())
+                                     world->SetFixedStep(1.0f / std::max(std::stof(args[0]), 1.0f));
+
+                                 const BehaviorSystem &behaviors = world->GetBehaviors();
+                                 std::ostringstream out;
+                                 out << std::fixed << std::setprecision(2) << "Step " << world->GetFixedStep() * 1000.0f
+                                     << " ms (" << 1.0f / world->GetFixedStep() << " Hz), " << world->GetLastStepCount()
+                                     << " steps last frame, alpha " << world->GetInterpolationAlpha() << ", "
+                                     << behaviors.GetBehaviorCount() << " behaviors on " << behaviors.GetEntityCount()
+                                     << " entities, " << behaviors.GetConflictCount() << " param conflicts, "
+                                     << behaviors.GetTime() << " s simulated";
+                                 self->Log(out.str());
+                             }};
+
+    Commands["/pipeline"] = {"pipeline", "Overlap simulation with drawing, one frame behind: pipeline [on|off]",
+                             [](Console *self, const std::vector<std::string> &args) {
+                                 World *world = self->WorldPointer;
+                                 if (!args.empty())
+                                     world->SetPipelined(args[0] == "on");
+                                 const RenderSnapshot &snapshot = world->GetFrontSnapshot();
+                                 self->Log(std::string("Pipeline ") + (world->IsPipelined() ? "on" : "off") +
+                                           ", snapshot " + std::to_string(snapshot.items.size()) + " items, " +
+                                           std::to_string(snapshot.batchCount) + " batches, " +
+                                           std::to_string(snapshot.materialCount) + " materials, " +
+                                           std::to_string(snapshot.lights.size()) + " lights");
+                             }};
+
+    Commands["/parammem"] = {"parammem", "Param memory per entity, pooled storage against one variant per param",
+                             [](Console *self, const std::vector<std::string> &) {
+                                 const EntityStore &store = self->WorldPointer->GetStore();
+                                 size_t params = 0, pooled = 0, variant = 0;
+                                 for (const auto &entity : store.Entities()) {
+                                     for (const CParams *set : {&entity->Params(), &entity->GetRenderable().Params()}) {
+                                         params += set->Size();
+                                         pooled += sizeof(CParams) + set->GetMemoryUsage();
+                                         variant += VariantLayoutBytes(*set);
+                                     }
+                                 }
+                                 size_t count = std::max<size_t>(store.Size(), 1);
+                                 std::ostringstream out;
+                                 out << std::fixed << std::setprecision(1) << store.Size() << " entities, "
+                                     << static_cast<double>(params) / count << " params each; bytes per entity: pooled "
+                                     << static_cast<double>(pooled) / count << ", variant "
+                                     << static_cast<double>(variant) / count << " (" << ParamKey::GetSymbolCount()
+                                     << " interned keys)";
+                                 self->Log(out.str());
+                             }};
+
+    Commands["/paramsync"] = {"paramsync", "Param changes handed out at the last sync and what they touched",
+                              [](Console *self, const std::vector<std::string> &) {
+                                  const ParamSync &sync = self->WorldPointer->GetStore().GetParamSync();
+                                  const ParamBinder::Stats &stats = self->WorldPointer->GetParamBinder().GetStats();
+                                  self->Log("Last sync " + std::to_string(sync.GetLastFlushCount()) + " changes, " +
+                                            std::to_string(sync.GetPendingCount()) + " pending, " +
+                                            std::to_string(sync.GetTotalFlushCount()) + " total; applied " +
+                                            std::to_string(stats.transforms) + " transforms, " +
+                                            std::to_string(stats.renderables) + " renderables, " +
+                                            std::to_string(stats.lights) + " lights, " +
+                                            std::to_string(stats.uniforms) + " uniforms");
+                              }};
+
+    Commands["/tween"] = {
+        "tween",
+        "Animates a param: tween <entity|*> <param> <value...> over <seconds> [linear | bezier <c1> <c2> | "
+        "spring <hz> <damping>] | tween <entity|*> clear | tween",
+        [](Console *self, const std::vector<std::string> &args) {
+            World *world = self->WorldPointer;
+            if (args.empty()) {
+                const TweenSystem &tweens = world->GetTweens();
+                self->Log(std::to_string(tweens.GetTrackCount()) + " tweens, " +
+                          std::to_string(tweens.GetLastWriteCount()) + " values written last update, " +
+                          std::to_string(tweens.GetFinishedCount()) + " finished");
+                return;
+            }
+
+            std::vector<std::shared_ptr<BaseEntity>> targets;
+            if (args[0] == "*") {
+                auto entities = world->GetEntities();
+                targets.assign(entities.begin(), entities.end());
+            } else if (auto entity = self->FindEntity(args[0])) {
+                targets.push_back(std::move(entity));
+            } else {
+                self->Log("Entity not found: " + args[0]);
+                return;
+            }
+
+            if (args.size() == 2 && args[1] == "clear") {
+                size_t removed = 0;
+                for (const auto &entity : targets)
+                    removed += world->RemoveTweens(entity);
+                self->Log("Removed " + std::to_string(removed) + " tweens");
+                return;
+            }
+
+            auto over = std::find(args.begin(), args.end(), "over");
+            if (args.size() < 5 || over - args.begin() < 3 || over + 1 == args.end()) {
+                self->Log("[USAGE] tween <entity|*> <param> <value...> over <seconds> [linear | bezier <c1> <c2> | "
+                          "spring <hz> <damping>]");
+                return;
+            }
+            CParams::Value target = ParseParamValue(args.begin() + 2, over);
+            float seconds = std::stof(*(over + 1));
+            std::vector<std::string> curve(over + 2, args.end());
+
+            Tween tween = Tween::Linear(seconds);
+            if (curve.size() == 3 && curve[0] == "bezier") {
+                tween = Tween::Bezier(seconds, std::stof(curve[1]), std::stof(curve[2]));
+            } else if (curve.size() == 3 && curve[0] == "spring") {
+                tween = Tween::Spring(seconds, std::stof(curve[1]), std::stof(curve[2]));
+            } else if (!curve.empty() && !(curve.size() == 1 && curve[0] == "linear")) {
+                self->Log("[USAGE] curves: linear | bezier <c1> <c2> | spring <hz> <damping>");
+                return;
+            }
+
+            size_t added = 0;
+            for (const auto &entity : targets)
+                added += world->AddTween(entity, args[1], target, tween) ? 1 : 0;
+            self->Log("Tweening " + args[1] + " on " + std::to_string(added) + " of " +
+                      std::to_string(targets.size()) + " entities");
+        }};
+
+    Commands["/save"] = {"save", "Saves the scene (binary, memory mapped on load): save [path]",
+                         [](Console *self, const std::vector<std::string> &args) {
+                             std::string path = args.empty() ? SceneFile::kDefaultPath : args[0];
+                             if (SceneFile::Save(*self->WorldPointer, path))
+                                 self->Log("Saved " + std::to_string(self->WorldPointer->GetEntityCount() - 1) +
+                                           " entities to " + path);
+                             else
+                                 self->Log("[ERROR] Could not save " + path);
+                         }};
+
+    Commands["/load"] = {"load", "Replaces the world with a saved scene: load [path]",
+                         [](Console *self, const std::vector<std::string> &args) {
+                             std::string path = args.empty() ? SceneFile::kDefaultPath : args[0];
+                             if (SceneFile::Load(*self->WorldPointer, path))
+                                 self->Log("Loaded " + std::to_string(self->WorldPointer->GetEntityCount() - 1) +
+                                           " entities from " + path);
+                             else
+                                 self->Log("[ERROR] Could not load " + path + ", world unchanged");
+                         }};
+
+    Commands["/export"] = {"export", "Writes a saved scene as text for diffing: export [scene] [text]",
+                           [](Console *self, const std::vector<std::string> &args) {
+                               std::string scene = args.empty() ? SceneFile::kDefaultPath : args[0];
+                               std::string text = args.size() > 1 ? args[1] : scene + ".txt";
+                               if (SceneFile::Export(scene, text))
+                                   self->Log("Exported " + scene + " to " + text);
+                               else
+                                   self->Log("[ERROR] Could not export " + scene);
+                           }};
+
+    Commands["/autosave"] = {
+        "autosave", "Background saves: autosave [on [seconds] [path] | off | now | full | incremental]",
+        [](Console *self, const std::vector<std::string> &args) {
+            Autosave &autosave = self->WorldPointer->GetAutosave();
+            if (!args.empty()) {
+                if (args[0] == "on") {
+                    if (args.size() > 1)
+                        autosave.SetInterval(std::stof(args[1]));
+                    if (args.size() > 2)
+                        autosave.SetPath(args[2]);
+                    autosave.SetEnabled(true);
+                } else if (args[0] == "off") {
+                    autosave.SetEnabled(false);
+                } else if (args[0] == "now") {
+                    autosave.Request();
+                } else if (args[0] == "full") {
+                    autosave.SetMode(Autosave::Mode::Full);
+                } else if (args[0] == "incremental") {
+                    autosave.SetMode(Autosave::Mode::Incremental);
+                }
+            }
+            Autosave::Stats stats = autosave.GetStats();
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(2) << "Autosave " << (autosave.IsEnabled() ? "on" : "off")
+                << " every " << autosave.GetInterval() << " s to " << autosave.GetPath() << ", "
+                << (autosave.GetMode() == Autosave::Mode::Full ? "full" : "incremental")
+                << (autosave.IsWriting() ? ", writing" : "");
+            self->Log(out.str());
+            out.str("");
+            out << "  " << stats.saves << " saves, " << stats.failures << " failed; last snapshot "
+                << stats.capturedBlocks << " of " << stats.blocks << " blocks (" << stats.capturedTransforms << " transforms) in " << stats.captureMs
+                << " ms on the main thread over " << stats.captureFrames << " frames (longest " << stats.captureStepMs
+                << " ms), last write " << stats.bytes / 1024 << " KB in " << stats.writeMs << " ms";
+            self->Log(out.str());
+        }};
 }
\ No newline at end of file
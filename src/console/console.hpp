@@ -1,6 +1,7 @@
 #ifndef CONSOLE_HPP
 #define CONSOLE_HPP
 
+#include "../rendering/resolution/dynamic_resolution.hpp"
 #include "../world/world.hpp"
 #include <algorithm>
 #include <cctype>
@@ -64,6 +65,8 @@ public:
 
     void ExecuteCommands();
 
+    void SetResolution(DynamicResolution* resolution) { ResolutionPointer = resolution; }
+
     void Log(const std::string& message);
     std::shared_ptr<BaseEntity> FindEntity(const std::string& name);
 
@@ -72,6 +75,7 @@ public:
 
 private:
     World* WorldPointer;
+    DynamicResolution* ResolutionPointer = nullptr;
     std::string InputBuffer;
     std::vector<LogEntry> LogEntries;
     bool IsActive = false;
@@ -1,46 +1,204 @@
 #include "base_entity.hpp"
+#include "transform_kernels.hpp"
 #include "../rendering/loaders/obj_loader.hpp"
 #include "../rendering/loaders/shader_loader.hpp"
+#include "../rendering/loaders/texture_loader.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 
+//
+// === Renderable ===
+//
+uint64_t Renderable::GetMaterialHash() const {
+    if (hashed_ && hashedVersion_ == params_.GetVersion())
+        return materialHash_;
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<const unsigned char*>(data)[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (size_t unit = 0; unit < textures_.size(); ++unit) {
+        const auto& [sampler, texture] = textures_[unit];
+        mix(sampler.data(), sampler.size() + 1);
+        const Texture* identity = unit == 0 && texture && texture->IsPacked() ? nullptr : texture.get();
+        mix(&identity, sizeof(identity));
+    }
+
+    // the same uniforms Apply sets, in the same order
+    for (const CParams::Entry& entry : params_.All()) {
+        uint32_t id = entry.key.GetId();
+        auto type = entry.GetType();
+        mix(&id, sizeof(id));
+        mix(&type, sizeof(type));
+        switch (type) {
+        case ParamType::Int: { int v = params_.Read<int>(entry); mix(&v, sizeof(v)); break; }
+        case ParamType::Float: { float v = params_.Read<float>(entry); mix(&v, sizeof(v)); break; }
+        case ParamType::Bool: { bool v = params_.Read<bool>(entry); mix(&v, sizeof(v)); break; }
+        case ParamType::Vec2: { glm::vec2 v = params_.Read<glm::vec2>(entry); mix(&v, sizeof(v)); break; }
+        case ParamType::Vec3: { glm::vec3 v = params_.Read<glm::vec3>(entry); mix(&v, sizeof(v)); break; }
+        case ParamType::Vec4: { glm::vec4 v = params_.Read<glm::vec4>(entry); mix(&v, sizeof(v)); break; }
+        case ParamType::Mat4: { glm::mat4 v = params_.Read<glm::mat4>(entry); mix(&v, sizeof(v)); break; }
+        case ParamType::String: {
+            // texture paths are covered by the textures above
+            std::string_view text = params_.ReadString(entry);
+            if (!HasTexture(entry.key.GetName()))
+                mix(text.data(), text.size());
+            break;
+        }
+        }
+    }
+
+    materialHash_ = hash;
+    hashedVersion_ = params_.GetVersion();
+    hashed_ = true;
+    return hash;
+}
+
 //
 // === Param Synchronization ===
 //
 void BaseEntity::UpdateTransformFromParams() {
-    transform_.position = params_.GetOr("position", transform_.position);
-    transform_.rotation = params_.GetOr("rotation", transform_.rotation);
-    transform_.scale    = params_.GetOr("scale", transform_.scale);
-    UpdateModel();
+    Transform transform = GetTransform();
+    transform.position = params_.GetOr(ParamKeys::Position, transform.position);
+    transform.rotation = params_.GetOr(ParamKeys::Rotation, transform.rotation);
+    transform.scale    = params_.GetOr(ParamKeys::Scale, transform.scale);
+    SetTransform(transform);
+}
+
+std::shared_ptr<Mesh> BaseEntity::LoadMesh(const std::string& name) {
+    return Mesh::LoadMesh("assets/models/" + name + ".obj");
+}
+
+std::shared_ptr<Shader> BaseEntity::LoadShader(const std::string& name) {
+    return ShaderLoader::LoadShader("assets/shaders/" + name + ".vert", "assets/shaders/" + name + ".frag");
 }
 
 void BaseEntity::UpdateRenderableFromParams() {
-    std::string meshName   = params_.GetOr<std::string>("mesh", "");
-    std::string shaderName = params_.GetOr<std::string>("shader", "");
+    std::string meshName   = params_.GetOr<std::string>(ParamKeys::Mesh, "");
+    std::string shaderName = params_.GetOr<std::string>(ParamKeys::Shader, "");
 
     if (meshName.empty() && shaderName.empty()) return;
 
     std::shared_ptr<Mesh> meshPtr = nullptr;
     std::shared_ptr<Shader> shaderPtr = nullptr;
 
-    // --- Load Mesh ---
-    if (!meshName.empty()) {
-        std::string meshPath = "assets/models/" + meshName + ".obj";
-        meshPtr = std::make_shared<Mesh>(MeshLoader::LoadOBJ(meshPath));
-    }
-
-    // --- Load Shader ---
-    if (!shaderName.empty()) {
-        std::string vertPath = "assets/shaders/" + shaderName + ".vert";
-        std::string fragPath = "assets/shaders/" + shaderName + ".frag";
-        shaderPtr = ShaderLoader::LoadShader(vertPath, fragPath);
-    }
+    if (!meshName.empty())
+        meshPtr = LoadMesh(meshName);
+    if (!shaderName.empty())
+        shaderPtr = LoadShader(shaderName);
 
     renderable_.SetMesh(meshPtr);
     renderable_.SetShader(shaderPtr);
 
+    // --- Textures: any string param named after a sampler uniform ---
+    renderable_.ClearTextures();
+    if (shaderPtr) {
+        for (const auto& sampler : shaderPtr->GetSamplerUniforms()) {
+            std::string textureName = params_.GetOr<std::string>(sampler, "");
+            if (!textureName.empty())
+                renderable_.SetTexture(sampler, TextureLoader::LoadTexture(textureName));
+        }
+    }
+
+    SyncRenderHandle();
+
     if (!meshPtr)
         std::cout << "[ENTITY][WARN] Mesh '" << meshName << "' not found." << std::endl;
     if (!shaderPtr)
         std::cout << "[ENTITY][WARN] Shader '" << shaderName << "' not found." << std::endl;
 }
+
+void BaseEntity::CopyFrom(const BaseEntity& prototype) {
+    name_ = prototype.name_;
+    params_ = prototype.params_;
+    renderable_ = prototype.renderable_;
+    SetTransform(prototype.GetTransform());
+    SyncRenderHandle();
+}
+
+//
+// === Transform ===
+//
+void BaseEntity::SetTransform(const Transform& transform) {
+    if (store_) {
+        store_->SetTransform(handle_, transform);
+        return;
+    }
+    transform_ = transform;
+    modelDirty_ = true;
+}
+
+void BaseEntity::SetPosition(const glm::vec3& position) {
+    Transform transform = GetTransform();
+    transform.position = position;
+    SetTransform(transform);
+}
+
+void BaseEntity::SetRotation(const glm::vec3& rotation) {
+    Transform transform = GetTransform();
+    transform.rotation = rotation;
+    SetTransform(transform);
+}
+
+void BaseEntity::SetScale(const glm::vec3& scale) {
+    Transform transform = GetTransform();
+    transform.scale = scale;
+    SetTransform(transform);
+}
+
+glm::mat4 BaseEntity::GetModelMatrix() const {
+    if (store_)
+        return store_->GetWorldMatrix(handle_);
+    if (modelDirty_) {
+        modelMatrix_ = TransformKernels::ComposeModelMatrix(transform_);
+        modelDirty_ = false;
+    }
+    return modelMatrix_;
+}
+
+//
+// === Store Attachment ===
+//
+void BaseEntity::Attach(EntityStore* store, EntityHandle handle) {
+    store_ = store;
+    handle_ = handle;
+    store_->SetTransform(handle_, transform_);
+    SyncRenderHandle();
+    store_->GetParamIndex().Add(handle_, params_);
+    // transform and renderable were just taken from the entity as it is
+    params_.MarkSynced();
+    params_.SetObserver(&store_->GetParamSync(), handle_);
+}
+
+void BaseEntity::Detach() {
+    if (!store_)
+        return;
+    store_->GetParamIndex().Remove(handle_, params_);
+    params_.SetObserver(nullptr, {});
+    transform_ = store_->GetTransform(handle_);
+    modelDirty_ = true;
+    store_ = nullptr;
+    handle_ = {};
+}
+
+void BaseEntity::SyncRenderHandle() {
+    if (!store_)
+        return;
+
+    RenderHandle& handle = store_->GetRenderHandle(handle_);
+    if (!renderable_.IsValid()) {
+        handle = {};
+    } else {
+        handle.renderable = &renderable_;
+        handle.shader = renderable_.GetShader().get();
+        handle.mesh = renderable_.GetMesh().get();
+        handle.instanced = renderable_.IsInstanced();
+    }
+    // world bounds depend on the mesh
+    store_->MarkDirty(handle_);
+}
@@ -2,44 +2,30 @@
 #define BASE_ENTITY_HPP
 
 #include "../rendering/camera/camera.hpp"
+#include "../rendering/lighting/clustered_lighting.hpp"
 #include "../rendering/mesh/mesh.hpp"
 #include "../rendering/shader.hpp"
+#include "../rendering/texture/texture.hpp"
+#include "entity_store.hpp"
 #include "params.hpp"
+#include "transform.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 
-//
-// === Transform ===
-//
-struct Transform {
-    glm::vec3 position{0.0f};
-    glm::vec3 rotation{0.0f};
-    glm::vec3 scale{1.0f};
-
-    [[nodiscard]] glm::mat4 GetModelMatrix() const {
-        glm::mat4 model(1.0f);
-        model = glm::translate(model, position);
-        model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1, 0, 0));
-        model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0, 1, 0));
-        model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0, 0, 1));
-        model = glm::scale(model, scale);
-        return model;
-    }
-
-
-};
-
 //
 // === Renderable ===
 //
 class Renderable {
   public:
     Renderable() = default;
+    explicit Renderable(std::pmr::memory_resource* memory) : params_(memory) {}
     Renderable(std::shared_ptr<Mesh> mesh, std::shared_ptr<Shader> shader)
         : mesh_(std::move(mesh)), shader_(std::move(shader)) 
     {
@@ -53,85 +39,162 @@ class Renderable {
     void SetMesh(std::shared_ptr<Mesh> mesh) { mesh_ = std::move(mesh); }
     void SetShader(std::shared_ptr<Shader> shader) { shader_ = std::move(shader); }
 
+    // Binds a texture to a sampler uniform; units are assigned in slot order.
+    void SetTexture(const std::string& sampler, std::shared_ptr<Texture> texture) {
+        for (auto& [name, tex] : textures_) {
+            if (name == sampler) {
+                tex = std::move(texture);
+                hashed_ = false;
+                return;
+            }
+        }
+        textures_.emplace_back(sampler, std::move(texture));
+        hashed_ = false;
+    }
+    void ClearTextures() {
+        textures_.clear();
+        hashed_ = false;
+    }
+    [[nodiscard]] const auto& GetTextures() const { return textures_; }
+
     [[nodiscard]] bool IsValid() const { return mesh_ && shader_; }
+    [[nodiscard]] bool IsInstanced() const { return IsValid() && shader_->IsInstanced(); }
 
-    void Draw(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) const {
-        if (!IsValid()) return;
+    [[nodiscard]] const std::shared_ptr<Mesh>& GetMesh() const { return mesh_; }
+    [[nodiscard]] const std::shared_ptr<Shader>& GetShader() const { return shader_; }
+    // The texture whose layer/rect goes into the per-instance attributes.
+    [[nodiscard]] const Texture* GetPrimaryTexture() const {
+        return textures_.empty() ? nullptr : textures_.front().second.get();
+    }
 
+    // Hash of what Apply pushes apart from the camera and lights: the bound
+    // textures and every uniform. A packed primary texture only counts by
+    // sampler, its layer and rect go per instance. Instanced entities with
+    // the same shader, mesh, primary array and hash share one batch, which is
+    // drawn with any one of their materials. Cached until params or textures
+    // change.
+    [[nodiscard]] uint64_t GetMaterialHash() const;
+
+    // Uses the shader and pushes everything but the model matrix; instanced
+    // batches call this once for the whole batch. The shader drops values a
+    // uniform already holds, and the param loop is skipped outright when this
+    // material was the last one pushed to it and nothing was written since.
+    void Apply(const glm::mat4& view, const glm::mat4& projection,
+               const ClusteredLighting* lighting = nullptr) const {
         shader_->Use();
-        shader_->SetMat4("model", model);
         shader_->SetMat4("view", view);
         shader_->SetMat4("projection", projection);
 
-        // Push all parameters to shader
-        for (const auto& [key, val] : params_.All()) {
-            std::visit([&](auto&& v) {
-                using T = std::decay_t<decltype(v)>;
-                if constexpr (std::is_same_v<T, int>)
-                    shader_->SetInt(key, v);
-                else if constexpr (std::is_same_v<T, float>)
-                    shader_->SetFloat(key, v);
-                else if constexpr (std::is_same_v<T, double>)
-                    shader_->SetFloat(key, static_cast<float>(v));
-                else if constexpr (std::is_same_v<T, bool>)
-                    shader_->SetBool(key, v);
-                else if constexpr (std::is_same_v<T, glm::vec2>)
-                    shader_->SetVec2(key, v);
-                else if constexpr (std::is_same_v<T, glm::vec3>)
-                    shader_->SetVec3(key, v);
-                else if constexpr (std::is_same_v<T, glm::vec4>)
-                    shader_->SetVec4(key, v);
-                else if constexpr (std::is_same_v<T, glm::mat4>)
-                    shader_->SetMat4(key, v);
-                else if constexpr (std::is_same_v<T, std::string>)
-                    shader_->SetInt(key, std::stoi(v));
-
-            }, val);
+        if (lighting)
+            lighting->Apply(*shader_);
+
+        for (size_t unit = 0; unit < textures_.size(); ++unit) {
+            const auto& [sampler, texture] = textures_[unit];
+            texture->Bind(static_cast<int>(unit));
+            shader_->SetSampler2D(sampler, static_cast<int>(unit));
+            if (texture->IsPacked()) {
+                shader_->SetInt(sampler + "Layer", texture->GetLayer());
+                shader_->SetVec4(sampler + "Rect", texture->GetRect());
+            }
         }
 
+        uint64_t material = GetMaterialHash();
+        if (shader_->IsMaterialCurrent(material))
+            return;
+
+        // Push all parameters to shader. Keys are symbol ids, the shader wants
+        // a std::string name; reusing one keeps this allocation free.
+        thread_local std::string key;
+        for (const CParams::Entry& entry : params_.All()) {
+            key.assign(entry.key.GetName());
+            switch (entry.GetType()) {
+            case ParamType::Int: shader_->SetInt(key, params_.Read<int>(entry)); break;
+            case ParamType::Float: shader_->SetFloat(key, params_.Read<float>(entry)); break;
+            case ParamType::Bool: shader_->SetBool(key, params_.Read<bool>(entry)); break;
+            case ParamType::Vec2: shader_->SetVec2(key, params_.Read<glm::vec2>(entry)); break;
+            case ParamType::Vec3: shader_->SetVec3(key, params_.Read<glm::vec3>(entry)); break;
+            case ParamType::Vec4: shader_->SetVec4(key, params_.Read<glm::vec4>(entry)); break;
+            case ParamType::Mat4: shader_->SetMat4(key, params_.Read<glm::mat4>(entry)); break;
+            case ParamType::String:
+                // texture names are bound through textures_ above
+                if (!HasTexture(key))
+                    shader_->SetInt(key, std::stoi(std::string(params_.ReadString(entry))));
+                break;
+            }
+        }
+        shader_->MarkMaterialApplied(material);
+    }
+
+    void Draw(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+              const ClusteredLighting* lighting = nullptr) const {
+        if (!IsValid()) return;
+
+        Apply(view, projection, lighting);
+        shader_->SetMat4("model", model);
         mesh_->Draw(*shader_);
     }
 
-    void Draw(const glm::mat4& model, const Camera& cam, float aspectRatio) const {
+    void Draw(const glm::mat4& model, const Camera& cam, float aspectRatio,
+              const ClusteredLighting* lighting = nullptr) const {
         if (!IsValid()) return;
 
         glm::mat4 view = cam.GetViewMatrix();
         glm::mat4 projection = glm::perspective(glm::radians(cam.GetZoom()), aspectRatio, 0.1f, 100.0f);
 
-        Draw(model, view, projection);
-
+        Apply(view, projection, lighting);
         shader_->SetVec3("viewPos", cam.GetPosition());
+        shader_->SetMat4("model", model);
+        mesh_->Draw(*shader_);
     }
 
     CParams& Params() { return params_; }
     const CParams& Params() const { return params_; }
 
   private:
+    [[nodiscard]] bool HasTexture(std::string_view sampler) const {
+        for (const auto& slot : textures_) {
+            if (slot.first == sampler)
+                return true;
+        }
+        return false;
+    }
+
     std::shared_ptr<Mesh> mesh_;
     std::shared_ptr<Shader> shader_;
+    std::vector<std::pair<std::string, std::shared_ptr<Texture>>> textures_;
     CParams params_;
+    // GetMaterialHash() as of params_ version hashedVersion_
+    mutable uint64_t materialHash_ = 0;
+    mutable uint32_t hashedVersion_ = 0;
+    mutable bool hashed_ = false;
 };
 
 //
 // === BaseEntity ===
+// While attached to a World, transform and model matrix live in the world's
+// EntityStore and the accessors below forward there; the entity keeps its own
+// copy only when detached.
 //
 class BaseEntity {
   public:
     BaseEntity() = default;
 
+    // memory backs the name and params (a World passes its arena).
+    explicit BaseEntity(std::pmr::memory_resource* memory)
+        : renderable_(memory), params_(memory), name_("Entity", memory) {}
+
     BaseEntity(glm::vec3 position, glm::vec3 rotation = glm::vec3(0.0f),
-               glm::vec3 scale = glm::vec3(1.0f), const std::string& name = "Entity")
-        : name_(std::move(name)) 
+               glm::vec3 scale = glm::vec3(1.0f), const std::string& name = "Entity",
+               std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : renderable_(memory), params_(memory), name_(name, memory)
     {
         transform_.position = position;
         transform_.rotation = rotation;
         transform_.scale = scale;
 
-        params_.Set("position", position);
-        params_.Set("rotation", rotation);
-        params_.Set("scale", scale);
-
-        UpdateModel();
+        params_.Set(ParamKeys::Position, position);
+        params_.Set(ParamKeys::Rotation, rotation);
+        params_.Set(ParamKeys::Scale, scale);
 
         std::cout << "[ENTITY] Created entity: " << name_
                 << " at (" << position.x << ", " << position.y << ", " << position.z << ")"
@@ -141,40 +204,73 @@ class BaseEntity {
 
     virtual ~BaseEntity() = default;
 
+    BaseEntity(const BaseEntity&) = delete;
+    BaseEntity& operator=(const BaseEntity&) = delete;
+
     // --- Accessors ---
-    [[nodiscard]] const std::string& GetName() const { return name_; }
-    void SetName(std::string newName) { name_ = std::move(newName); }
+    [[nodiscard]] std::string_view GetName() const { return name_; }
+    void SetName(std::string_view newName) {
+        if (store_)
+            store_->Rename(handle_, name_, newName);
+        name_.assign(newName);
+    }
+
+    // References into the store are invalidated by creating/destroying entities.
+    [[nodiscard]] const Transform& GetTransform() const { return store_ ? store_->GetTransform(handle_) : transform_; }
 
-    [[nodiscard]] const Transform& GetTransform() const { return transform_; }
-    Transform& GetTransform() { return transform_; }
+    // Local to the parent while attached. Setters mark the transform dirty;
+    // the model (world) matrix is rebuilt lazily.
+    void SetTransform(const Transform& transform);
+    void SetPosition(const glm::vec3& position);
+    void SetRotation(const glm::vec3& rotation);
+    void SetScale(const glm::vec3& scale);
 
     [[nodiscard]] const Renderable& GetRenderable() const { return renderable_; }
     Renderable& GetRenderable() { return renderable_; }
 
-    [[nodiscard]] glm::mat4 GetModelMatrix() const { return modelMatrix_; }
+    [[nodiscard]] glm::mat4 GetModelMatrix() const;
+
+    [[nodiscard]] EntityHandle GetHandle() const { return handle_; }
+    [[nodiscard]] bool IsAttached() const { return store_ != nullptr; }
 
     CParams& Params() { return params_; }
     const CParams& Params() const { return params_; }
 
     // --- Behavior ---
-    virtual void Draw(const Camera& camera, float aspectRatio) {
+    virtual void Draw(const Camera& camera, float aspectRatio, const ClusteredLighting* lighting = nullptr) {
         if (!renderable_.IsValid()) return;
-        UpdateModel();
-        renderable_.Draw(modelMatrix_, camera, aspectRatio);
+        renderable_.Draw(GetModelMatrix(), camera, aspectRatio, lighting);
     }
 
     void UpdateTransformFromParams();
     void UpdateRenderableFromParams();
+    // What the mesh and shader params name: assets/models/<name>.obj and
+    // assets/shaders/<name>.vert/.frag. Null if the shader doesn't load.
+    // Both are cached by path, so entities naming the same asset share it.
+    static std::shared_ptr<Mesh> LoadMesh(const std::string& name);
+    static std::shared_ptr<Shader> LoadShader(const std::string& name);
+
+    // Copies name, transform, params and renderable (used for batch spawning).
+    void CopyFrom(const BaseEntity& prototype);
+
+    // EntityStore only
+    void Attach(EntityStore* store, EntityHandle handle);
+    void Detach();
 
   protected:
-    void UpdateModel() { modelMatrix_ = transform_.GetModelMatrix(); }
+    void SyncRenderHandle();
 
   protected:
+    EntityStore* store_ = nullptr;
+    EntityHandle handle_;
+
     Transform transform_;
     Renderable renderable_;
     CParams params_;
-    glm::mat4 modelMatrix_{1.0f};
-    std::string name_{"Entity"};
+    // detached only, the store caches it while attached
+    mutable glm::mat4 modelMatrix_{1.0f};
+    mutable bool modelDirty_ = true;
+    std::pmr::string name_{"Entity"};
 };
 
 #endif // BASE_ENTITY_HPP
@@ -0,0 +1,23 @@
+#ifndef ENTITY_HANDLE_HPP
+#define ENTITY_HANDLE_HPP
+
+#include <cstdint>
+#include <limits>
+
+//
+// === EntityHandle ===
+// Slot index plus the generation the slot had when the entity was created.
+// Destroying an entity bumps the slot's generation, so stale handles are
+// detected in O(1) instead of silently pointing at a newer entity.
+//
+struct EntityHandle {
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index = kInvalidIndex;
+    uint32_t generation = 0;
+
+    [[nodiscard]] bool IsValid() const { return index != kInvalidIndex; }
+    bool operator==(const EntityHandle&) const = default;
+};
+
+#endif // ENTITY_HANDLE_HPP
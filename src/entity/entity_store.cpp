@@ -0,0 +1,559 @@
+#include "entity_store.hpp"
+#include "base_entity.hpp"
+#include "../jobs/job_system.hpp"
+#include "transform_kernels.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+// transforms per job; below this the kernel isn't worth handing out
+constexpr size_t kTransformGrain = 2048;
+
+void ComposeParallel(std::span<const Transform> transforms, std::span<glm::mat4> out) {
+    JobSystem::Instance().ParallelFor(transforms.size(), kTransformGrain, [&](size_t begin, size_t end) {
+        TransformKernels::ComposeModelMatrices(transforms.subspan(begin, end - begin), out.subspan(begin, end - begin));
+    });
+}
+
+} // namespace
+
+EntityHandle EntityStore::Allocate() {
+    uint32_t dense = static_cast<uint32_t>(handles_.size());
+    EntityHandle handle;
+    if (!freeSlots_.empty()) {
+        // generation was already bumped when the slot was freed
+        handle.index = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        handle.index = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+        if ((handle.index >> kStampShift) == layoutStamps_.size()) {
+            layoutStamps_.push_back(stampPeriod_);
+            transformStamps_.push_back(stampPeriod_);
+        }
+    }
+    Slot& slot = slots_[handle.index];
+    slot.dense = dense;
+    slot.parent = kFree;
+    slot.created = nextCreated_++;
+    // new entities start as roots at the end of the hierarchy
+    slot.order = static_cast<uint32_t>(order_.size());
+    order_.push_back(handle.index);
+    subtreeSizes_.push_back(1);
+    handle.generation = slot.generation;
+    StampLayout(handle.index);
+
+    // filled in by Attach from the entity's own copy
+    transforms_.emplace_back();
+    models_.emplace_back(1.0f);
+    renderHandles_.emplace_back();
+    bounds_.emplace_back();
+    dirty_.push_back(0);
+    handles_.push_back(handle);
+    // new entities need their model and bounds built
+    MarkDirty(handle);
+    return handle;
+}
+
+EntityHandle EntityStore::Create(std::shared_ptr<BaseEntity> entity) {
+    EntityHandle handle = Allocate();
+    entity->Attach(this, handle);
+    IndexName(entity->GetName(), handle);
+    entities_.push_back(std::move(entity));
+    return handle;
+}
+
+void EntityStore::Create(std::span<const std::shared_ptr<BaseEntity>> entities) {
+    Reserve(handles_.size() + entities.size());
+
+    // clones share a name, so consecutive runs go into the bucket in one go
+    std::vector<EntityHandle>* bucket = nullptr;
+    std::string_view bucketName;
+    for (const auto& entity : entities) {
+        EntityHandle handle = Allocate();
+        entity->Attach(this, handle);
+        entities_.push_back(entity);
+
+        if (!bucket || entity->GetName() != bucketName) {
+            bucketName = entity->GetName();
+            auto it = names_.find(bucketName);
+            if (it == names_.end())
+                it = names_.emplace(std::string(bucketName), std::vector<EntityHandle>{}).first;
+            bucket = &it->second;
+        }
+        // the newest entity is already in heap order at the back
+        slots_[handle.index].named = static_cast<uint32_t>(bucket->size());
+        bucket->push_back(handle);
+    }
+}
+
+void EntityStore::Reserve(size_t count) {
+    transforms_.reserve(count);
+    models_.reserve(count);
+    renderHandles_.reserve(count);
+    bounds_.reserve(count);
+    dirty_.reserve(count);
+    handles_.reserve(count);
+    entities_.reserve(count);
+}
+
+void EntityStore::Destroy(EntityHandle handle) {
+    if (!Contains(handle))
+        return;
+    UnindexName(entities_[IndexOf(handle)]->GetName(), handle);
+    Remove(handle);
+}
+
+void EntityStore::Destroy(std::span<const EntityHandle> handles) {
+    // buckets are pruned once each at the end, erasing per handle is quadratic
+    // for clones; runs of one name (clones) skip the set lookup
+    std::unordered_set<std::string, NameHash, std::equal_to<>> touched;
+    std::string_view last;
+    for (EntityHandle handle : handles) {
+        if (!Contains(handle))
+            continue;
+        std::string_view name = entities_[IndexOf(handle)]->GetName();
+        if (touched.empty() || name != last)
+            last = *touched.emplace(name).first;
+        Remove(handle);
+    }
+    for (const auto& name : touched)
+        PruneName(name);
+}
+
+void EntityStore::Remove(EntityHandle handle) {
+    uint32_t index = IndexOf(handle);
+    uint32_t last = static_cast<uint32_t>(handles_.size()) - 1;
+
+    entities_[index]->Detach();
+    Unlink(handle.index);
+    StampLayout(handle.index);
+
+    // swap the last entity into the hole
+    if (index != last) {
+        transforms_[index] = transforms_[last];
+        models_[index] = models_[last];
+        renderHandles_[index] = renderHandles_[last];
+        bounds_[index] = bounds_[last];
+        dirty_[index] = dirty_[last];
+        handles_[index] = handles_[last];
+        entities_[index] = std::move(entities_[last]);
+        slots_[handles_[index].index].dense = index;
+    }
+
+    transforms_.pop_back();
+    models_.pop_back();
+    renderHandles_.pop_back();
+    bounds_.pop_back();
+    dirty_.pop_back();
+    handles_.pop_back();
+    entities_.pop_back();
+
+    slots_[handle.index].dense = kFree;
+    ++slots_[handle.index].generation;
+    freeSlots_.push_back(handle.index);
+}
+
+void EntityStore::Clear() {
+    paramIndex_.ClearEntries();
+    paramSync_.Clear();
+    for (auto& entity : entities_)
+        entity->Detach();
+
+    transforms_.clear();
+    models_.clear();
+    renderHandles_.clear();
+    bounds_.clear();
+    dirty_.clear();
+    dirtyList_.clear();
+    changed_.clear();
+    handles_.clear();
+    order_.clear();
+    subtreeSizes_.clear();
+    tombstones_ = 0;
+    entities_.clear();
+    names_.clear();
+
+    // keep the slots so handles from before the clear stay stale
+    for (uint32_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].dense != kFree) {
+            slots_[i] = {kFree, slots_[i].generation + 1, kFree, kFree};
+            freeSlots_.push_back(i);
+        }
+    }
+    std::fill(layoutStamps_.begin(), layoutStamps_.end(), stampPeriod_);
+    std::fill(transformStamps_.begin(), transformStamps_.end(), stampPeriod_);
+}
+
+//
+// === Names ===
+//
+EntityHandle EntityStore::Find(std::string_view name) const {
+    auto it = names_.find(name);
+    if (it == names_.end() || it->second.empty())
+        return {};
+    return it->second.front();
+}
+
+std::span<const EntityHandle> EntityStore::FindAll(std::string_view name) const {
+    auto it = names_.find(name);
+    if (it == names_.end())
+        return {};
+    return it->second;
+}
+
+void EntityStore::Rename(EntityHandle handle, std::string_view oldName, std::string_view newName) {
+    if (!Contains(handle))
+        return;
+    UnindexName(oldName, handle);
+    IndexName(newName, handle);
+    StampLayout(handle.index);
+}
+
+void EntityStore::IndexName(std::string_view name, EntityHandle handle) {
+    auto it = names_.find(name);
+    if (it == names_.end())
+        it = names_.emplace(std::string(name), std::vector<EntityHandle>{}).first;
+    slots_[handle.index].named = static_cast<uint32_t>(it->second.size());
+    it->second.push_back(handle);
+    SiftName(it->second, slots_[handle.index].named);
+}
+
+void EntityStore::UnindexName(std::string_view name, EntityHandle handle) {
+    auto it = names_.find(name);
+    if (it == names_.end())
+        return;
+
+    // heap removal: the last handle fills the hole and is sifted into place
+    auto& handles = it->second;
+    uint32_t at = slots_[handle.index].named;
+    if (at >= handles.size() || handles[at] != handle)
+        return;
+    handles[at] = handles.back();
+    handles.pop_back();
+    slots_[handle.index].named = kFree;
+    if (at < handles.size()) {
+        slots_[handles[at].index].named = at;
+        SiftName(handles, at);
+    }
+    if (handles.empty())
+        names_.erase(it);
+}
+
+void EntityStore::PruneName(std::string_view name) {
+    auto it = names_.find(name);
+    if (it == names_.end())
+        return;
+
+    auto& handles = it->second;
+    handles.erase(std::remove_if(handles.begin(), handles.end(),
+                                 [this](EntityHandle handle) { return !Contains(handle); }),
+                  handles.end());
+    std::make_heap(handles.begin(), handles.end(), [this](EntityHandle a, EntityHandle b) { return Older(b, a); });
+    for (uint32_t i = 0; i < handles.size(); ++i)
+        slots_[handles[i].index].named = i;
+    if (handles.empty())
+        names_.erase(it);
+}
+
+// Moves the handle at `at` up or down the bucket's heap until its parent is
+// older and its children are newer, keeping every slot's position current.
+void EntityStore::SiftName(std::vector<EntityHandle>& bucket, uint32_t at) {
+    EntityHandle handle = bucket[at];
+    while (at > 0) {
+        uint32_t parent = (at - 1) / 2;
+        if (!Older(handle, bucket[parent]))
+            break;
+        bucket[at] = bucket[parent];
+        slots_[bucket[at].index].named = at;
+        at = parent;
+    }
+    auto size = static_cast<uint32_t>(bucket.size());
+    for (;;) {
+        uint32_t child = 2 * at + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && Older(bucket[child + 1], bucket[child]))
+            ++child;
+        if (!Older(bucket[child], handle))
+            break;
+        bucket[at] = bucket[child];
+        slots_[bucket[at].index].named = at;
+        at = child;
+    }
+    bucket[at] = handle;
+    slots_[handle.index].named = at;
+}
+
+//
+// === Transforms ===
+//
+void EntityStore::MarkDirty(EntityHandle handle) {
+    // stamped every time, a save may have come between two writes of a frame
+    transformStamps_[handle.index >> kStampShift] = stampPeriod_;
+    uint8_t& dirty = dirty_[IndexOf(handle)];
+    if (dirty)
+        return;
+    dirty = 1;
+    dirtyList_.push_back(handle);
+}
+
+void EntityStore::UpdateTransforms() {
+    changed_.clear();
+    if (tombstones_ > 64 && tombstones_ * 4 > order_.size())
+        Compact();
+
+    // a dirty entity takes its whole subtree range with it
+    dirtyRoots_.clear();
+    for (EntityHandle handle : dirtyList_) {
+        if (!Contains(handle))
+            continue;
+        dirty_[IndexOf(handle)] = 0;
+        dirtyRoots_.push_back(slots_[handle.index].order);
+    }
+    dirtyList_.clear();
+    std::sort(dirtyRoots_.begin(), dirtyRoots_.end());
+
+    // sorted, so a range nested in the previous one is already covered
+    updateOrder_.clear();
+    uint32_t coveredUntil = 0;
+    for (uint32_t start : dirtyRoots_) {
+        if (start < coveredUntil)
+            continue;
+        coveredUntil = start + subtreeSizes_[start];
+        for (uint32_t pos = start; pos < coveredUntil; ++pos) {
+            if (order_[pos] != kFree)
+                updateOrder_.push_back(order_[pos]);
+        }
+    }
+    if (updateOrder_.empty())
+        return;
+
+    // local matrices in one kernel call: mostly dirty runs the contiguous
+    // column, otherwise gather the dirty transforms first
+    bool full = updateOrder_.size() * 2 >= transforms_.size();
+    if (full) {
+        stagingModels_.resize(transforms_.size());
+        ComposeParallel(transforms_, stagingModels_);
+    } else {
+        stagingTransforms_.resize(updateOrder_.size());
+        stagingModels_.resize(updateOrder_.size());
+        for (size_t k = 0; k < updateOrder_.size(); ++k)
+            stagingTransforms_[k] = transforms_[slots_[updateOrder_[k]].dense];
+        ComposeParallel(stagingTransforms_, stagingModels_);
+    }
+
+    // parents come first, so their world matrix is current by the time a child reads it
+    for (size_t k = 0; k < updateOrder_.size(); ++k) {
+        const Slot& slot = slots_[updateOrder_[k]];
+        uint32_t i = slot.dense;
+        const glm::mat4& local = stagingModels_[full ? i : k];
+        models_[i] = slot.parent == kFree ? local : models_[slots_[slot.parent].dense] * local;
+        changed_.push_back(HandleOfSlot(updateOrder_[k]));
+    }
+
+    // bounds only depend on the entity's own matrix, so they can go wide
+    JobSystem::Instance().ParallelFor(updateOrder_.size(), kTransformGrain, [this](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t i = slots_[updateOrder_[k]].dense;
+            if (const Mesh* mesh = renderHandles_[i].mesh)
+                bounds_[i] = Bounds{mesh->GetBoundsMin(), mesh->GetBoundsMax()}.Transformed(models_[i]);
+            else
+                bounds_[i] = {glm::vec3(models_[i][3]), glm::vec3(models_[i][3])};
+        }
+    });
+}
+
+glm::mat4 EntityStore::GetWorldMatrix(EntityHandle handle) const {
+    // topmost dirty entity on the way up; everything below it is stale
+    uint32_t topDirty = kFree;
+    for (uint32_t slot = handle.index; slot != kFree; slot = slots_[slot].parent) {
+        if (dirty_[slots_[slot].dense])
+            topDirty = slot;
+    }
+    if (topDirty == kFree)
+        return models_[IndexOf(handle)];
+
+    // composed from the entity upwards, so the walk needs no stack
+    glm::mat4 local = TransformKernels::ComposeModelMatrix(transforms_[IndexOf(handle)]);
+    for (uint32_t slot = handle.index; slot != topDirty;) {
+        slot = slots_[slot].parent;
+        local = TransformKernels::ComposeModelMatrix(transforms_[slots_[slot].dense]) * local;
+    }
+
+    uint32_t parent = slots_[topDirty].parent;
+    return parent == kFree ? local : models_[slots_[parent].dense] * local;
+}
+
+//
+// === Hierarchy ===
+//
+bool EntityStore::SetParent(EntityHandle child, EntityHandle parent) {
+    if (!Contains(child) || (parent.IsValid() && !Contains(parent)))
+        return false;
+
+    Slot& slot = slots_[child.index];
+    uint32_t from = slot.order, count = subtreeSizes_[from];
+    uint32_t to = static_cast<uint32_t>(order_.size());
+    if (parent.IsValid()) {
+        uint32_t parentOrder = slots_[parent.index].order;
+        // no parenting into its own subtree
+        if (parentOrder >= from && parentOrder < from + count)
+            return false;
+        // last child of the new parent
+        to = parentOrder + subtreeSizes_[parentOrder];
+    }
+
+    for (uint32_t ancestor = slot.parent; ancestor != kFree; ancestor = slots_[ancestor].parent)
+        subtreeSizes_[slots_[ancestor].order] -= count;
+    MoveRange(from, count, to);
+    slot.parent = parent.IsValid() ? parent.index : kFree;
+    for (uint32_t ancestor = slot.parent; ancestor != kFree; ancestor = slots_[ancestor].parent)
+        subtreeSizes_[slots_[ancestor].order] += count;
+
+    StampLayout(child.index);
+    MarkDirty(child);
+    return true;
+}
+
+EntityHandle EntityStore::GetParent(EntityHandle handle) const {
+    if (!Contains(handle) || slots_[handle.index].parent == kFree)
+        return {};
+    return HandleOfSlot(slots_[handle.index].parent);
+}
+
+std::vector<EntityHandle> EntityStore::GetChildren(EntityHandle handle) const {
+    std::vector<EntityHandle> children;
+    if (!Contains(handle))
+        return children;
+
+    uint32_t start = slots_[handle.index].order;
+    for (uint32_t pos = start + 1; pos < start + subtreeSizes_[start]; ++pos) {
+        if (order_[pos] != kFree && slots_[order_[pos]].parent == handle.index)
+            children.push_back(HandleOfSlot(order_[pos]));
+    }
+    return children;
+}
+
+// Moves order_[from, from + count) so it starts right before position `to`
+// (measured before the move). Only the positions in between get touched.
+void EntityStore::MoveRange(uint32_t from, uint32_t count, uint32_t to) {
+    uint32_t first, last;
+    if (to >= from + count) {
+        std::rotate(order_.begin() + from, order_.begin() + from + count, order_.begin() + to);
+        std::rotate(subtreeSizes_.begin() + from, subtreeSizes_.begin() + from + count, subtreeSizes_.begin() + to);
+        first = from;
+        last = to;
+    } else if (to < from) {
+        std::rotate(order_.begin() + to, order_.begin() + from, order_.begin() + from + count);
+        std::rotate(subtreeSizes_.begin() + to, subtreeSizes_.begin() + from, subtreeSizes_.begin() + from + count);
+        first = to;
+        last = from + count;
+    } else {
+        return; // already there
+    }
+
+    for (uint32_t pos = first; pos < last; ++pos) {
+        if (order_[pos] != kFree)
+            slots_[order_[pos]].order = pos;
+    }
+}
+
+// Leaves a tombstone in the hierarchy; children move up to the parent, which
+// keeps them inside the same ancestor ranges.
+void EntityStore::Unlink(uint32_t slot) {
+    uint32_t pos = slots_[slot].order;
+    uint32_t end = pos + subtreeSizes_[pos];
+    for (uint32_t i = pos + 1; i < end; ++i) {
+        if (order_[i] != kFree && slots_[order_[i]].parent == slot) {
+            slots_[order_[i]].parent = slots_[slot].parent;
+            StampLayout(order_[i]);
+            MarkDirty(HandleOfSlot(order_[i]));
+        }
+    }
+
+    order_[pos] = kFree;
+    subtreeSizes_[pos] = 1;
+    slots_[slot].parent = kFree;
+    slots_[slot].order = kFree;
+    ++tombstones_;
+}
+
+void EntityStore::Compact() {
+    // tombstones before each position, to shrink the subtree sizes
+    std::vector<uint32_t> before(order_.size() + 1, 0);
+    for (size_t pos = 0; pos < order_.size(); ++pos)
+        before[pos + 1] = before[pos] + (order_[pos] == kFree ? 1 : 0);
+
+    uint32_t write = 0;
+    for (uint32_t pos = 0; pos < order_.size(); ++pos) {
+        if (order_[pos] == kFree)
+            continue;
+        uint32_t end = pos + subtreeSizes_[pos];
+        order_[write] = order_[pos];
+        subtreeSizes_[write] = subtreeSizes_[pos] - (before[end] - before[pos]);
+        slots_[order_[write]].order = write;
+        ++write;
+    }
+    order_.resize(write);
+    subtreeSizes_.resize(write);
+    tombstones_ = 0;
+}
+
+//
+// === Params ===
+//
+void EntityStore::IndexParam(std::string_view key) {
+    if (!paramIndex_.Enable(key))
+        return;
+    // as if every entity had just set it
+    ParamKey param = ParamKey::Find(key);
+    for (uint32_t i = 0; i < handles_.size(); ++i) {
+        if (auto value = entities_[i]->Params().Get(param))
+            paramIndex_.OnParamChanged(handles_[i], param, nullptr, &*value);
+    }
+}
+
+bool EntityStore::Query(const EntityQuery& query, std::vector<EntityHandle>& out) const {
+    const auto& conditions = query.GetConditions();
+
+    // --- Pick the condition with the smallest indexed candidate set ---
+    // (a scan costs Size(), so only cheaper candidate sets are worth it)
+    const ParamCondition* seed = nullptr;
+    size_t best = entities_.size();
+    for (const ParamCondition& condition : conditions) {
+        auto estimate = paramIndex_.Estimate(condition, best);
+        if (estimate && *estimate < best) {
+            best = *estimate;
+            seed = &condition;
+        }
+    }
+
+    auto matchesRest = [&](const std::shared_ptr<BaseEntity>& entity) {
+        for (const ParamCondition& condition : conditions) {
+            if (&condition != seed && !condition.Matches(entity->Params()))
+                return false;
+        }
+        return true;
+    };
+
+    if (!seed) {
+        for (uint32_t i = 0; i < entities_.size(); ++i) {
+            if (matchesRest(entities_[i]))
+                out.push_back(handles_[i]);
+        }
+        return false;
+    }
+
+    size_t first = out.size();
+    paramIndex_.Collect(*seed, out);
+    // filter in place
+    size_t kept = first;
+    for (size_t i = first; i < out.size(); ++i) {
+        if (Contains(out[i]) && matchesRest(entities_[IndexOf(out[i])]))
+            out[kept++] = out[i];
+    }
+    out.resize(kept);
+    return true;
+}
@@ -0,0 +1,249 @@
+#ifndef ENTITY_STORE_HPP
+#define ENTITY_STORE_HPP
+
+#include "entity_handle.hpp"
+#include "param_index.hpp"
+#include "param_sync.hpp"
+#include "transform.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class BaseEntity;
+class Renderable;
+class Shader;
+class Mesh;
+
+//
+// === RenderHandle ===
+// What the draw loop needs to know about an entity's renderable without
+// touching the entity. Refreshed by BaseEntity::UpdateRenderableFromParams.
+//
+struct RenderHandle {
+    const Renderable* renderable = nullptr; // null: nothing to draw
+    const Shader* shader = nullptr;
+    const Mesh* mesh = nullptr;
+    bool instanced = false;
+};
+
+//
+// === EntityStore ===
+// Structure of arrays storage for the entities of a World. Transforms, model
+// matrices, render handles and world bounds live in parallel dense arrays so
+// per-frame passes are linear scans; the BaseEntity objects themselves are
+// only the cold part (name, params, renderable) and forward their transform
+// accessors here while attached.
+//
+// Entities are referred to by EntityHandle, which maps to a dense index
+// through the slot table. Removal swaps the last entity into the hole, so
+// dense order is not creation order, and freed slots are reused through a
+// free list with their generation bumped. Names are indexed too, so lookups by
+// name don't scan. Each bucket is a min-heap on the slots' creation sequence
+// and each slot knows its place in it, so unindexing is O(log n) and
+// duplicates always resolve to the oldest entity with that name.
+//
+// Transforms are dirty tracked: SetTransform/MarkDirty queue the entity and
+// UpdateTransforms only rebuilds model matrices and bounds for those. The
+// columns are read only so every write goes through SetTransform.
+//
+// Transforms are local to the entity's parent and Models() are world
+// matrices. The hierarchy is kept as a separate depth first array of slots
+// (parents before children, every subtree contiguous, with its size stored),
+// because the dense columns get reordered by swap-and-pop. A dirty entity
+// rebuilds exactly its subtree range; reparenting rotates the subtree's range
+// into place. Destroyed entities leave a tombstone in that array until enough
+// pile up to compact it, and their children move up to their parent.
+//
+class EntityStore {
+  public:
+    EntityHandle Create(std::shared_ptr<BaseEntity> entity);
+    void Destroy(EntityHandle handle);
+    void Clear();
+
+    // Batch versions: columns grow once and each touched name bucket is
+    // updated once per call instead of once per entity.
+    void Create(std::span<const std::shared_ptr<BaseEntity>> entities);
+    void Destroy(std::span<const EntityHandle> handles);
+    void Reserve(size_t count);
+
+    [[nodiscard]] bool Contains(EntityHandle handle) const {
+        return handle.index < slots_.size() && slots_[handle.index].generation == handle.generation &&
+               slots_[handle.index].dense != kFree;
+    }
+    [[nodiscard]] size_t Size() const { return handles_.size(); }
+    // Dense index of a live entity.
+    [[nodiscard]] uint32_t IndexOf(EntityHandle handle) const { return slots_[handle.index].dense; }
+
+    // ===== Names =====
+    [[nodiscard]] EntityHandle Find(std::string_view name) const;
+    // Every live entity with that name, in no particular order; invalidated by
+    // any create/destroy.
+    [[nodiscard]] std::span<const EntityHandle> FindAll(std::string_view name) const;
+    void Rename(EntityHandle handle, std::string_view oldName, std::string_view newName);
+
+    // Rebuilds model matrices (TransformKernels) and world bounds of the
+    // entities marked dirty since the last call; they become GetChanged()
+    // until the next call.
+    void UpdateTransforms();
+    void MarkDirty(EntityHandle handle);
+    [[nodiscard]] bool IsDirty(EntityHandle handle) const { return dirty_[IndexOf(handle)]; }
+    // Entities whose model matrix changed in the last UpdateTransforms. May
+    // hold handles destroyed since, check with Contains.
+    std::span<const EntityHandle> GetChanged() const { return changed_; }
+
+    // ===== Per entity =====
+    [[nodiscard]] const Transform& GetTransform(EntityHandle handle) const { return transforms_[IndexOf(handle)]; }
+    void SetTransform(EntityHandle handle, const Transform& transform) {
+        transforms_[IndexOf(handle)] = transform;
+        MarkDirty(handle);
+    }
+    [[nodiscard]] const glm::mat4& GetModel(EntityHandle handle) const { return models_[IndexOf(handle)]; }
+    // Current world matrix even before UpdateTransforms ran, O(depth).
+    [[nodiscard]] glm::mat4 GetWorldMatrix(EntityHandle handle) const;
+    RenderHandle& GetRenderHandle(EntityHandle handle) { return renderHandles_[IndexOf(handle)]; }
+    [[nodiscard]] const Bounds& GetBounds(EntityHandle handle) const { return bounds_[IndexOf(handle)]; }
+    [[nodiscard]] const std::shared_ptr<BaseEntity>& GetEntity(EntityHandle handle) const {
+        return entities_[IndexOf(handle)];
+    }
+
+    // ===== Params =====
+    // Secondary index on an entity param (ParamIndex); turning one on walks
+    // the entities once, after that it follows CParams::Set.
+    void IndexParam(std::string_view key);
+    void UnindexParam(std::string_view key) { paramIndex_.Disable(key); }
+    ParamIndex& GetParamIndex() { return paramIndex_; }
+    const ParamIndex& GetParamIndex() const { return paramIndex_; }
+    // Observer of every entity's params; subscribers hear at SyncParams().
+    ParamSync& GetParamSync() { return paramSync_; }
+    const ParamSync& GetParamSync() const { return paramSync_; }
+    // The sync point: hands the param changes since the last call to the
+    // subscribers and returns how many there were.
+    size_t SyncParams() { return paramSync_.Flush(*this); }
+    // Appends the entities matching every condition. Starts from the cheapest
+    // indexed condition and checks the others per candidate, scans when none
+    // is indexed. Returns whether an index was used.
+    bool Query(const EntityQuery& query, std::vector<EntityHandle>& out) const;
+
+    // ===== Hierarchy =====
+    // Invalid parent makes the entity a root. Fails (returns false) for dead
+    // handles and for a parent inside the child's own subtree.
+    bool SetParent(EntityHandle child, EntityHandle parent);
+    [[nodiscard]] EntityHandle GetParent(EntityHandle handle) const;
+    [[nodiscard]] std::vector<EntityHandle> GetChildren(EntityHandle handle) const;
+    // Visits live entities parent first, with their depth below their root.
+    template <typename Fn> void Traverse(Fn&& visit) const;
+
+    // ===== Edit stamps =====
+    // Slots are grouped in blocks of kStampBlock. Creating, destroying,
+    // reparenting or renaming an entity stamps its block's layout with the
+    // current period, writing its transform stamps the block's transforms.
+    // A saver keeps, per block, the period NextStampPeriod() returned when
+    // it copied the block, and redoes only blocks stamped at or after it.
+    // Params aren't stamped, ParamSync reports those.
+    static constexpr uint32_t kStampShift = 6;
+    static constexpr uint32_t kStampBlock = 1u << kStampShift;
+    uint32_t NextStampPeriod() { return ++stampPeriod_; }
+    [[nodiscard]] size_t GetStampBlockCount() const { return layoutStamps_.size(); }
+    [[nodiscard]] uint32_t GetLayoutStamp(size_t block) const { return layoutStamps_[block]; }
+    [[nodiscard]] uint32_t GetTransformStamp(size_t block) const { return transformStamps_[block]; }
+    // The live entity in a slot, invalid if the slot is free.
+    [[nodiscard]] EntityHandle GetSlotHandle(uint32_t slot) const {
+        return slot < slots_.size() && slots_[slot].dense != kFree ? HandleOfSlot(slot) : EntityHandle{};
+    }
+
+    // ===== Columns (dense order) =====
+    std::span<const Transform> Transforms() const { return transforms_; }
+    std::span<const glm::mat4> Models() const { return models_; }
+    std::span<const RenderHandle> RenderHandles() const { return renderHandles_; }
+    std::span<const Bounds> WorldBounds() const { return bounds_; }
+    std::span<const EntityHandle> Handles() const { return handles_; }
+    std::span<const std::shared_ptr<BaseEntity>> Entities() const { return entities_; }
+
+  private:
+    static constexpr uint32_t kFree = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+        uint32_t dense = kFree;
+        uint32_t generation = 0;
+        uint32_t parent = kFree; // slot index
+        uint32_t order = kFree;  // position in order_
+        uint32_t named = kFree;  // position in its name's bucket
+        uint64_t created = 0;    // creation sequence, orders the name buckets
+    };
+
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    EntityHandle Allocate();
+    void Remove(EntityHandle handle);
+    void IndexName(std::string_view name, EntityHandle handle);
+    void UnindexName(std::string_view name, EntityHandle handle);
+    void PruneName(std::string_view name);
+    void SiftName(std::vector<EntityHandle>& bucket, uint32_t at);
+    [[nodiscard]] bool Older(EntityHandle a, EntityHandle b) const {
+        return slots_[a.index].created < slots_[b.index].created;
+    }
+
+    [[nodiscard]] EntityHandle HandleOfSlot(uint32_t slot) const { return {slot, slots_[slot].generation}; }
+    void StampLayout(uint32_t slot) { layoutStamps_[slot >> kStampShift] = stampPeriod_; }
+    void Unlink(uint32_t slot);
+    void MoveRange(uint32_t from, uint32_t count, uint32_t to);
+    void Compact();
+
+    // hot
+    std::vector<Transform> transforms_;
+    std::vector<glm::mat4> models_;
+    std::vector<RenderHandle> renderHandles_;
+    std::vector<Bounds> bounds_;
+    std::vector<uint8_t> dirty_;
+    // cold
+    std::vector<EntityHandle> handles_;
+    std::vector<std::shared_ptr<BaseEntity>> entities_;
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+    uint64_t nextCreated_ = 0;
+
+    // depth first order of slot indices (kFree: tombstone) and subtree sizes
+    std::vector<uint32_t> order_;
+    std::vector<uint32_t> subtreeSizes_;
+    size_t tombstones_ = 0;
+
+    // per block of slots, see NextStampPeriod
+    std::vector<uint32_t> layoutStamps_;
+    std::vector<uint32_t> transformStamps_;
+    uint32_t stampPeriod_ = 0;
+
+    std::vector<EntityHandle> dirtyList_;
+    std::vector<EntityHandle> changed_;
+    // scratch for UpdateTransforms, kept to avoid reallocating every frame
+    std::vector<uint32_t> dirtyRoots_;
+    std::vector<uint32_t> updateOrder_;
+    std::vector<Transform> stagingTransforms_;
+    std::vector<glm::mat4> stagingModels_;
+    ParamIndex paramIndex_;
+    ParamSync paramSync_{paramIndex_};
+    // heterogeneous lookup, so Find(string_view) doesn't allocate
+    std::unordered_map<std::string, std::vector<EntityHandle>, NameHash, std::equal_to<>> names_;
+};
+
+template <typename Fn> void EntityStore::Traverse(Fn&& visit) const {
+    for (uint32_t slot : order_) {
+        if (slot == kFree)
+            continue;
+        int depth = 0;
+        for (uint32_t parent = slots_[slot].parent; parent != kFree; parent = slots_[parent].parent)
+            ++depth;
+        visit(HandleOfSlot(slot), depth);
+    }
+}
+
+#endif // ENTITY_STORE_HPP
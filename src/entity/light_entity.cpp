@@ -0,0 +1,26 @@
+#include "light_entity.hpp"
+#include <algorithm>
+
+LightEntity::LightEntity(glm::vec3 position, const PointLight& light, const std::string& name,
+                         std::pmr::memory_resource* memory)
+    : BaseEntity(position, glm::vec3(0.0f), glm::vec3(1.0f), name, memory) {
+    SetLight(light);
+}
+
+void LightEntity::SetLight(const PointLight& light) {
+    light_ = light;
+    light_.radius = std::max(light_.radius, 0.0f);
+
+    params_.Set(ParamKeys::Color, light_.color);
+    params_.Set(ParamKeys::Intensity, light_.intensity);
+    params_.Set(ParamKeys::Radius, light_.radius);
+}
+
+//
+// === Param Synchronization ===
+//
+void LightEntity::UpdateLightFromParams() {
+    light_.color     = params_.GetOr(ParamKeys::Color, light_.color);
+    light_.intensity = params_.GetOr(ParamKeys::Intensity, light_.intensity);
+    light_.radius    = std::max(params_.GetOr(ParamKeys::Radius, light_.radius), 0.0f);
+}
@@ -0,0 +1,39 @@
+#ifndef LIGHT_ENTITY_HPP
+#define LIGHT_ENTITY_HPP
+
+#include "base_entity.hpp"
+#include <glm/glm.hpp>
+#include <string>
+
+//
+// === PointLight ===
+//
+struct PointLight {
+    glm::vec3 color{1.0f};
+    float intensity = 1.0f;
+    float radius = 10.0f; // world-space range, light falls off to zero here
+};
+
+//
+// === LightEntity ===
+// A point light living in the world. Lights have no renderable, they are only
+// collected by World and fed into the clustered lighting pass.
+//
+class LightEntity : public BaseEntity {
+  public:
+    LightEntity(glm::vec3 position, const PointLight& light = PointLight{},
+                const std::string& name = "Light",
+                std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    // Blank, the light follows once its params are set (loaders).
+    explicit LightEntity(std::pmr::memory_resource* memory) : BaseEntity(memory) {}
+
+    [[nodiscard]] const PointLight& GetLight() const { return light_; }
+    void SetLight(const PointLight& light);
+
+    void UpdateLightFromParams();
+
+  private:
+    PointLight light_;
+};
+
+#endif // LIGHT_ENTITY_HPP
@@ -0,0 +1,254 @@
+#include "param_index.hpp"
+#include <charconv>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+std::optional<double> AsNumber(const CParams::Value& value) {
+    if (auto i = std::get_if<int>(&value))
+        return static_cast<double>(*i);
+    if (auto f = std::get_if<float>(&value))
+        return static_cast<double>(*f);
+    if (auto b = std::get_if<bool>(&value))
+        return *b ? 1.0 : 0.0;
+    return std::nullopt;
+}
+
+// Straight from the number pool, no variant in between.
+std::optional<double> AsNumber(const CParams& params, ParamKey key) {
+    switch (params.TypeOf(key).value_or(ParamType::String)) {
+    case ParamType::Int: return static_cast<double>(params.GetOr(key, 0));
+    case ParamType::Float: return static_cast<double>(params.GetOr(key, 0.0f));
+    case ParamType::Bool: return params.GetOr(key, false) ? 1.0 : 0.0;
+    default: return std::nullopt;
+    }
+}
+
+template <typename T> bool Compare(const T& left, ParamCondition::Op op, const T& right) {
+    switch (op) {
+    case ParamCondition::Op::Less: return left < right;
+    case ParamCondition::Op::LessEqual: return left <= right;
+    case ParamCondition::Op::Greater: return left > right;
+    case ParamCondition::Op::GreaterEqual: return left >= right;
+    case ParamCondition::Op::Equal: return left == right;
+    case ParamCondition::Op::NotEqual: return left != right;
+    }
+    return false;
+}
+
+uint64_t Pack(EntityHandle handle) { return static_cast<uint64_t>(handle.generation) << 32 | handle.index; }
+EntityHandle Unpack(uint64_t packed) {
+    return {static_cast<uint32_t>(packed), static_cast<uint32_t>(packed >> 32)};
+}
+
+std::optional<ParamCondition::Op> ParseOp(std::string_view token) {
+    if (token == "<") return ParamCondition::Op::Less;
+    if (token == "<=") return ParamCondition::Op::LessEqual;
+    if (token == ">") return ParamCondition::Op::Greater;
+    if (token == ">=") return ParamCondition::Op::GreaterEqual;
+    if (token == "==" || token == "=") return ParamCondition::Op::Equal;
+    if (token == "!=") return ParamCondition::Op::NotEqual;
+    return std::nullopt;
+}
+
+} // namespace
+
+//
+// === EntityQuery ===
+//
+bool ParamCondition::Matches(const CParams& params) const {
+    if (auto text = std::get_if<std::string>(&operand)) {
+        auto own = params.GetString(key);
+        return own && Compare(*own, op, std::string_view(*text));
+    }
+    auto left = AsNumber(params, key);
+    auto right = AsNumber(operand);
+    return left && right && Compare(*left, op, *right);
+}
+
+EntityQuery& EntityQuery::Where(std::string_view key, ParamCondition::Op op, CParams::Value operand) {
+    conditions_.push_back({ParamKey::Intern(key), op, std::move(operand)});
+    return *this;
+}
+
+std::optional<EntityQuery> EntityQuery::Parse(std::string_view text) {
+    std::istringstream stream{std::string(text)};
+    std::vector<std::string> tokens;
+    for (std::string token; stream >> token;)
+        tokens.push_back(std::move(token));
+
+    EntityQuery query;
+    for (size_t i = 0; i < tokens.size(); i += 4) {
+        if (i + 2 >= tokens.size())
+            return std::nullopt;
+        auto op = ParseOp(tokens[i + 1]);
+        if (!op)
+            return std::nullopt;
+
+        const std::string& literal = tokens[i + 2];
+        float number = 0.0f;
+        auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), number);
+        if (error == std::errc() && end == literal.data() + literal.size())
+            query.Where(tokens[i], *op, number);
+        else if (literal.size() >= 2 && literal.front() == '"' && literal.back() == '"')
+            query.Where(tokens[i], *op, literal.substr(1, literal.size() - 2));
+        else
+            query.Where(tokens[i], *op, literal);
+
+        if (i + 3 < tokens.size() && tokens[i + 3] != "and")
+            return std::nullopt;
+    }
+    if (query.conditions_.empty())
+        return std::nullopt;
+    return query;
+}
+
+//
+// === ParamIndex ===
+//
+bool ParamIndex::Enable(std::string_view key) {
+    return keys_.try_emplace(ParamKey::Intern(key)).second;
+}
+
+bool ParamIndex::Disable(std::string_view key) {
+    return keys_.erase(ParamKey::Find(key)) > 0;
+}
+
+std::vector<std::string> ParamIndex::GetKeys() const {
+    std::vector<std::string> keys;
+    for (const auto& [key, index] : keys_)
+        keys.emplace_back(key.GetName());
+    return keys;
+}
+
+size_t ParamIndex::GetEntryCount(std::string_view key) const {
+    auto it = keys_.find(ParamKey::Find(key));
+    return it == keys_.end() ? 0 : it->second.entries;
+}
+
+void ParamIndex::Add(EntityHandle owner, const CParams& params) {
+    for (auto& [key, index] : keys_) {
+        if (auto value = params.Get(key))
+            Insert(index, Pack(owner), *value);
+    }
+}
+
+void ParamIndex::Remove(EntityHandle owner, const CParams& params) {
+    for (auto& [key, index] : keys_) {
+        if (auto value = params.Get(key))
+            Erase(index, Pack(owner), *value);
+    }
+}
+
+void ParamIndex::ClearEntries() {
+    for (auto& [key, index] : keys_)
+        index = KeyIndex{};
+}
+
+void ParamIndex::OnParamChanged(EntityHandle owner, ParamKey key, const CParams::Value* before,
+                                const CParams::Value* after) {
+    if (keys_.empty())
+        return;
+    auto it = keys_.find(key);
+    if (it == keys_.end())
+        return;
+    if (before)
+        Erase(it->second, Pack(owner), *before);
+    if (after)
+        Insert(it->second, Pack(owner), *after);
+}
+
+void ParamIndex::Insert(KeyIndex& index, uint64_t owner, const CParams::Value& value) {
+    if (auto number = AsNumber(value)) {
+        index.ordered.emplace(*number, owner);
+        ++index.entries;
+    } else if (auto text = std::get_if<std::string>(&value)) {
+        auto bucket = index.hashed.find(*text);
+        if (bucket == index.hashed.end())
+            bucket = index.hashed.emplace(*text, std::unordered_set<uint64_t>{}).first;
+        bucket->second.insert(owner);
+        ++index.entries;
+    }
+    // vectors and matrices aren't indexed, queries on them scan
+}
+
+void ParamIndex::Erase(KeyIndex& index, uint64_t owner, const CParams::Value& value) {
+    if (auto number = AsNumber(value)) {
+        index.entries -= index.ordered.erase({*number, owner});
+    } else if (auto text = std::get_if<std::string>(&value)) {
+        auto bucket = index.hashed.find(*text);
+        if (bucket == index.hashed.end())
+            return;
+        index.entries -= bucket->second.erase(owner);
+        if (bucket->second.empty())
+            index.hashed.erase(bucket);
+    }
+}
+
+//
+// Numeric conditions become an [begin, end) range of the ordered set.
+//
+std::pair<ParamIndex::OrderedIt, ParamIndex::OrderedIt> ParamIndex::Range(const KeyIndex& index, ParamCondition::Op op,
+                                                                         double number) {
+    constexpr uint64_t kMax = std::numeric_limits<uint64_t>::max();
+    auto begin = index.ordered.begin();
+    auto end = index.ordered.end();
+    switch (op) {
+    case ParamCondition::Op::Less: end = index.ordered.lower_bound({number, 0}); break;
+    case ParamCondition::Op::LessEqual: end = index.ordered.upper_bound({number, kMax}); break;
+    case ParamCondition::Op::Greater: begin = index.ordered.upper_bound({number, kMax}); break;
+    case ParamCondition::Op::GreaterEqual: begin = index.ordered.lower_bound({number, 0}); break;
+    case ParamCondition::Op::Equal:
+        begin = index.ordered.lower_bound({number, 0});
+        end = index.ordered.upper_bound({number, kMax});
+        break;
+    case ParamCondition::Op::NotEqual: end = begin; break;
+    }
+    return {begin, end};
+}
+
+//
+// String equality costs its bucket size. Numeric ranges are counted by
+// walking them, but never further than limit: past that the condition can't
+// beat the one the caller already has.
+//
+std::optional<size_t> ParamIndex::Estimate(const ParamCondition& condition, size_t limit) const {
+    auto it = keys_.find(condition.key);
+    if (it == keys_.end() || condition.op == ParamCondition::Op::NotEqual)
+        return std::nullopt;
+    const KeyIndex& index = it->second;
+
+    if (auto text = std::get_if<std::string>(&condition.operand)) {
+        if (condition.op != ParamCondition::Op::Equal)
+            return std::nullopt;
+        auto bucket = index.hashed.find(*text);
+        return bucket == index.hashed.end() ? 0 : bucket->second.size();
+    }
+
+    auto number = AsNumber(condition.operand);
+    if (!number)
+        return std::nullopt;
+    auto [begin, end] = Range(index, condition.op, *number);
+    size_t count = 0;
+    for (auto entry = begin; entry != end && count < limit; ++entry)
+        ++count;
+    return count;
+}
+
+void ParamIndex::Collect(const ParamCondition& condition, std::vector<EntityHandle>& out) const {
+    const KeyIndex& index = keys_.find(condition.key)->second;
+
+    if (auto text = std::get_if<std::string>(&condition.operand)) {
+        auto bucket = index.hashed.find(*text);
+        if (bucket != index.hashed.end()) {
+            for (uint64_t owner : bucket->second)
+                out.push_back(Unpack(owner));
+        }
+        return;
+    }
+
+    auto [begin, end] = Range(index, condition.op, *AsNumber(condition.operand));
+    for (auto entry = begin; entry != end; ++entry)
+        out.push_back(Unpack(entry->second));
+}
@@ -0,0 +1,101 @@
+#ifndef PARAM_INDEX_HPP
+#define PARAM_INDEX_HPP
+
+#include "entity_handle.hpp"
+#include "params.hpp"
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+//
+// === EntityQuery ===
+// Conjunction of param conditions, e.g. "health < 10 and mesh == crate".
+// Numbers compare numerically against int/float/bool params, strings
+// compare against string params; an entity without the param, or with a
+// param of the other kind, never matches.
+//
+struct ParamCondition {
+    enum class Op { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+    ParamKey key;
+    Op op = Op::Equal;
+    CParams::Value operand; // float or std::string
+
+    [[nodiscard]] bool Matches(const CParams& params) const;
+};
+
+class EntityQuery {
+  public:
+    EntityQuery& Where(std::string_view key, ParamCondition::Op op, CParams::Value operand);
+    // "<key> <op> <value> [and ...]", ops < <= > >= == !=; values that parse
+    // as numbers are numbers. Nullopt on a syntax error.
+    static std::optional<EntityQuery> Parse(std::string_view text);
+
+    [[nodiscard]] const std::vector<ParamCondition>& GetConditions() const { return conditions_; }
+
+  private:
+    std::vector<ParamCondition> conditions_;
+};
+
+//
+// === ParamIndex ===
+// Optional secondary indexes over entity params, one per enabled key: numeric
+// values in an ordered set (ranges), strings in a hash of buckets (equality).
+// Entities are added when they attach to the store and kept current through
+// the CParams observer, so a query can start from the smallest indexed
+// candidate set instead of scanning the world.
+//
+class ParamIndex : public CParams::Observer {
+  public:
+    // Turning a key on doesn't index existing entities, EntityStore::IndexParam does.
+    bool Enable(std::string_view key);
+    bool Disable(std::string_view key);
+    [[nodiscard]] bool IsEnabled(std::string_view key) const { return keys_.find(ParamKey::Find(key)) != keys_.end(); }
+    [[nodiscard]] std::vector<std::string> GetKeys() const;
+    // Indexed entries of a key (0 when not indexed).
+    [[nodiscard]] size_t GetEntryCount(std::string_view key) const;
+
+    void Add(EntityHandle owner, const CParams& params);
+    void Remove(EntityHandle owner, const CParams& params);
+    void ClearEntries();
+
+    [[nodiscard]] bool Watches(ParamKey key) const override { return keys_.contains(key); }
+    void OnParamChanged(EntityHandle owner, ParamKey key, const CParams::Value* before,
+                        const CParams::Value* after) override;
+
+    // Candidates the index would return for the condition, counted up to
+    // limit; nullopt when the key isn't indexed or the op can't use it.
+    [[nodiscard]] std::optional<size_t> Estimate(const ParamCondition& condition, size_t limit) const;
+    // Appends the entities the index says satisfy the condition. Only valid
+    // when Estimate() had a value.
+    void Collect(const ParamCondition& condition, std::vector<EntityHandle>& out) const;
+
+  private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    // handles packed as generation << 32 | index
+    struct KeyIndex {
+        std::set<std::pair<double, uint64_t>> ordered;
+        std::unordered_map<std::string, std::unordered_set<uint64_t>, Hash, std::equal_to<>> hashed;
+        size_t entries = 0;
+    };
+
+    using OrderedIt = std::set<std::pair<double, uint64_t>>::const_iterator;
+
+    static void Insert(KeyIndex& index, uint64_t owner, const CParams::Value& value);
+    static std::pair<OrderedIt, OrderedIt> Range(const KeyIndex& index, ParamCondition::Op op, double number);
+    static void Erase(KeyIndex& index, uint64_t owner, const CParams::Value& value);
+
+    std::unordered_map<ParamKey, KeyIndex, ParamKeyHash> keys_;
+};
+
+#endif // PARAM_INDEX_HPP
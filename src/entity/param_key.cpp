@@ -0,0 +1,115 @@
+#include "param_key.hpp"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+//
+// Open addressing over (hash, id) pairs, linear probing, kept under half
+// full. Names live in a deque so the views handed out never move. Reads
+// take the lock shared; entities on workers look keys up concurrently.
+//
+class SymbolTable {
+  public:
+    static SymbolTable& Instance() {
+        static SymbolTable instance;
+        return instance;
+    }
+
+    ParamKey Find(std::string_view name, uint32_t hash) const {
+        std::shared_lock lock(mutex_);
+        return FindLocked(name, hash);
+    }
+
+    ParamKey Intern(std::string_view name, uint32_t hash) {
+        {
+            std::shared_lock lock(mutex_);
+            if (ParamKey key = FindLocked(name, hash); key.IsValid())
+                return key;
+        }
+        std::unique_lock lock(mutex_);
+        if (ParamKey key = FindLocked(name, hash); key.IsValid())
+            return key;
+        return Add(name, hash);
+    }
+
+    std::string_view GetName(uint32_t id) const {
+        std::shared_lock lock(mutex_);
+        return id < names_.size() ? names_[id] : std::string_view();
+    }
+
+    uint32_t GetCount() const {
+        std::shared_lock lock(mutex_);
+        return static_cast<uint32_t>(names_.size());
+    }
+
+  private:
+    struct Slot {
+        uint32_t hash = 0;
+        uint32_t id = ParamKey::kInvalid;
+    };
+
+    SymbolTable() : slots_(64) {
+        for (std::string_view name : ParamKeys::kReservedNames)
+            Add(name, HashParamName(name));
+    }
+
+    ParamKey FindLocked(std::string_view name, uint32_t hash) const {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (slot.id == ParamKey::kInvalid)
+                return {};
+            if (slot.hash == hash && names_[slot.id] == name)
+                return ParamKey(slot.id);
+        }
+    }
+
+    ParamKey Add(std::string_view name, uint32_t hash) {
+        if ((names_.size() + 1) * 2 > slots_.size())
+            Grow();
+        auto id = static_cast<uint32_t>(names_.size());
+        names_.push_back(storage_.emplace_back(name));
+        Place({hash, id});
+        return ParamKey(id);
+    }
+
+    void Place(Slot entry) {
+        size_t mask = slots_.size() - 1;
+        size_t i = entry.hash & mask;
+        while (slots_[i].id != ParamKey::kInvalid)
+            i = (i + 1) & mask;
+        slots_[i] = entry;
+    }
+
+    void Grow() {
+        std::vector<Slot> old(slots_.size() * 2);
+        old.swap(slots_);
+        for (const Slot& slot : old) {
+            if (slot.id != ParamKey::kInvalid)
+                Place(slot);
+        }
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Slot> slots_;
+    std::deque<std::string> storage_;
+    std::vector<std::string_view> names_;
+};
+
+} // namespace
+
+ParamKey ParamKey::Intern(std::string_view name) { return Intern(name, HashParamName(name)); }
+
+ParamKey ParamKey::Intern(std::string_view name, uint32_t hash) { return SymbolTable::Instance().Intern(name, hash); }
+
+ParamKey ParamKey::Find(std::string_view name) { return Find(name, HashParamName(name)); }
+
+ParamKey ParamKey::Find(std::string_view name, uint32_t hash) { return SymbolTable::Instance().Find(name, hash); }
+
+uint32_t ParamKey::GetSymbolCount() { return SymbolTable::Instance().GetCount(); }
+
+std::string_view ParamKey::GetName() const { return SymbolTable::Instance().GetName(id_); }
@@ -0,0 +1,74 @@
+#ifndef PARAM_KEY_HPP
+#define PARAM_KEY_HPP
+
+#include <cstdint>
+#include <compare>
+#include <string_view>
+
+// FNV-1a; constexpr so names known at compile time hash there.
+constexpr uint32_t HashParamName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//
+// === ParamKey ===
+// A param name interned into the global symbol table: a 32-bit id, equal
+// for equal names for the life of the process. Comparing, hashing and
+// looking params up by key never touches the name. The names every entity
+// has are reserved at fixed ids (ParamKeys below), so code using them
+// does no lookup at all.
+//
+class ParamKey {
+  public:
+    static constexpr uint32_t kInvalid = ~0u;
+
+    constexpr ParamKey() = default;
+    constexpr explicit ParamKey(uint32_t id) : id_(id) {}
+
+    // Finds or adds the name. Only the first sighting of a name allocates.
+    static ParamKey Intern(std::string_view name);
+    static ParamKey Intern(std::string_view name, uint32_t hash);
+    // Never adds: invalid when no param of that name was ever set.
+    static ParamKey Find(std::string_view name);
+    static ParamKey Find(std::string_view name, uint32_t hash);
+    // Names interned so far, the reserved ones included.
+    static uint32_t GetSymbolCount();
+
+    [[nodiscard]] constexpr uint32_t GetId() const { return id_; }
+    [[nodiscard]] constexpr bool IsValid() const { return id_ != kInvalid; }
+    // Stays valid for the life of the process.
+    [[nodiscard]] std::string_view GetName() const;
+
+    constexpr auto operator<=>(const ParamKey&) const = default;
+
+  private:
+    uint32_t id_ = kInvalid;
+};
+
+struct ParamKeyHash {
+    size_t operator()(ParamKey key) const { return key.GetId(); }
+};
+
+//
+// Reserved keys; the symbol table seeds these names at exactly these ids.
+//
+namespace ParamKeys {
+inline constexpr ParamKey Position{0};
+inline constexpr ParamKey Rotation{1};
+inline constexpr ParamKey Scale{2};
+inline constexpr ParamKey Mesh{3};
+inline constexpr ParamKey Shader{4};
+inline constexpr ParamKey Color{5};
+inline constexpr ParamKey Intensity{6};
+inline constexpr ParamKey Radius{7};
+
+inline constexpr std::string_view kReservedNames[] = {"position", "rotation", "scale",     "mesh",
+                                                      "shader",   "color",    "intensity", "radius"};
+} // namespace ParamKeys
+
+#endif // PARAM_KEY_HPP
@@ -0,0 +1,43 @@
+#include "param_sync.hpp"
+#include "base_entity.hpp"
+#include "entity_store.hpp"
+#include <algorithm>
+
+void ParamSync::Subscribe(ParamSubscriber* subscriber) {
+    if (std::find(subscribers_.begin(), subscribers_.end(), subscriber) == subscribers_.end())
+        subscribers_.push_back(subscriber);
+}
+
+void ParamSync::Unsubscribe(ParamSubscriber* subscriber) {
+    std::erase(subscribers_, subscriber);
+}
+
+size_t ParamSync::Flush(const EntityStore& store) {
+    // subscribers may set params, those mark containers dirty for next time
+    flushing_.swap(dirty_);
+    dirty_.clear();
+    batch_.clear();
+    for (const ParamChange& change : removed_) {
+        if (store.Contains(change.owner))
+            batch_.push_back(change);
+    }
+    removed_.clear();
+    for (EntityHandle owner : flushing_) {
+        if (store.Contains(owner))
+            store.GetEntity(owner)->Params().TakeChanges(batch_);
+    }
+    flushing_.clear();
+
+    lastFlush_ = batch_.size();
+    totalFlushed_ += batch_.size();
+    if (!batch_.empty()) {
+        for (ParamSubscriber* subscriber : subscribers_)
+            subscriber->OnParamsChanged(batch_);
+    }
+    return lastFlush_;
+}
+
+void ParamSync::Clear() {
+    dirty_.clear();
+    removed_.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef PARAM_SYNC_HPP
+#define PARAM_SYNC_HPP
+
+#include "entity_handle.hpp"
+#include "param_index.hpp"
+#include "params.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+class EntityStore;
+
+// Told about param changes in one batch per sync: removals first, then the
+// changed keys entity by entity.
+class ParamSubscriber {
+  public:
+    virtual ~ParamSubscriber() = default;
+    virtual void OnParamsChanged(std::span<const ParamChange> changes) = 0;
+};
+
+//
+// === ParamSync ===
+// The store's observer for every entity's params. Index updates pass
+// straight through to the ParamIndex, so queries are exact right after a
+// Set. Everything else only collects which containers turned dirty; Flush()
+// at the frame's sync point takes their changed keys and hands the batch
+// to each subscriber, which can then redo just what those keys feed.
+//
+class ParamSync : public CParams::Observer {
+  public:
+    explicit ParamSync(ParamIndex& index) : index_(index) {}
+
+    void Subscribe(ParamSubscriber* subscriber);
+    void Unsubscribe(ParamSubscriber* subscriber);
+
+    // Returns the number of changes handed out. Changes made by subscribers
+    // during the flush go out with the next one.
+    size_t Flush(const EntityStore& store);
+    void Clear();
+
+    [[nodiscard]] size_t GetPendingCount() const { return dirty_.size() + removed_.size(); }
+    [[nodiscard]] size_t GetLastFlushCount() const { return lastFlush_; }
+    [[nodiscard]] size_t GetTotalFlushCount() const { return totalFlushed_; }
+
+    [[nodiscard]] bool Watches(ParamKey key) const override { return index_.Watches(key); }
+    void OnParamChanged(EntityHandle owner, ParamKey key, const CParams::Value* before,
+                        const CParams::Value* after) override {
+        index_.OnParamChanged(owner, key, before, after);
+    }
+    void OnParamsDirty(EntityHandle owner) override { dirty_.push_back(owner); }
+    void OnParamRemoved(EntityHandle owner, ParamKey key) override { removed_.push_back({owner, key, true}); }
+
+  private:
+    ParamIndex& index_;
+    std::vector<ParamSubscriber*> subscribers_;
+    std::vector<EntityHandle> dirty_;
+    std::vector<ParamChange> removed_;
+    // reused between flushes
+    std::vector<EntityHandle> flushing_;
+    std::vector<ParamChange> batch_;
+    size_t lastFlush_ = 0;
+    size_t totalFlushed_ = 0;
+};
+
+#endif // PARAM_SYNC_HPP
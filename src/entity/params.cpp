@@ -0,0 +1,190 @@
+#include "params.hpp"
+#include <bit>
+
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<size_t>(ParamType::Mat4), CParams::Value>, glm::mat4>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<size_t>(ParamType::String), CParams::Value>,
+                             std::string>);
+static_assert(sizeof(CParams::Entry) == 8);
+
+CParams& CParams::operator=(const CParams& other) {
+    if (this == &other)
+        return *this;
+    if (observer_) {
+        for (const Entry& entry : entries_) {
+            if (observer_->Watches(entry.key)) {
+                Value before = ReadValue(entry);
+                observer_->OnParamChanged(owner_, entry.key, &before, nullptr);
+            }
+        }
+        for (const Entry& entry : other.entries_) {
+            if (observer_->Watches(entry.key)) {
+                Value after = other.ReadValue(entry);
+                observer_->OnParamChanged(owner_, entry.key, nullptr, &after);
+            }
+        }
+    }
+    // keys only the old set had are gone, everything in the new one changed
+    if (observer_) {
+        for (const Entry& entry : entries_) {
+            if (!other.Has(entry.key))
+                observer_->OnParamRemoved(owner_, entry.key);
+        }
+    }
+    entries_ = other.entries_;
+    words_ = other.words_;
+    strings_ = other.strings_;
+    versions_.assign(entries_.size(), ++version_);
+    bool wasClean = dirty_ == 0;
+    dirty_ = entries_.empty() ? 0 : ~uint64_t(0) >> (kOverflowBit - std::min(entries_.size() - 1, kOverflowBit));
+    if (wasClean && dirty_ && observer_)
+        observer_->OnParamsDirty(owner_);
+    return *this;
+}
+
+// Switch on the variant index, the alternatives are in ParamType order.
+void CParams::Set(ParamKey key, const Value& value) {
+    switch (static_cast<ParamType>(value.index())) {
+    case ParamType::Int: Set(key, std::get<int>(value)); break;
+    case ParamType::Float: Set(key, std::get<float>(value)); break;
+    case ParamType::Bool: Set(key, std::get<bool>(value)); break;
+    case ParamType::Vec2: Set(key, std::get<glm::vec2>(value)); break;
+    case ParamType::Vec3: Set(key, std::get<glm::vec3>(value)); break;
+    case ParamType::Vec4: Set(key, std::get<glm::vec4>(value)); break;
+    case ParamType::Mat4: Set(key, std::get<glm::mat4>(value)); break;
+    case ParamType::String: Set(key, std::get<std::string>(value)); break;
+    }
+}
+
+CParams::Value CParams::ReadValue(const Entry& entry) const {
+    switch (entry.GetType()) {
+    case ParamType::Int: return Read<int>(entry);
+    case ParamType::Float: return Read<float>(entry);
+    case ParamType::Bool: return Read<bool>(entry);
+    case ParamType::Vec2: return Read<glm::vec2>(entry);
+    case ParamType::Vec3: return Read<glm::vec3>(entry);
+    case ParamType::Vec4: return Read<glm::vec4>(entry);
+    case ParamType::Mat4: return Read<glm::mat4>(entry);
+    case ParamType::String: return Read<std::string>(entry);
+    }
+    return {};
+}
+
+bool CParams::Remove(ParamKey key) {
+    auto it = LowerBound(key);
+    if (it == entries_.end() || it->key != key)
+        return false;
+    if (observer_ && observer_->Watches(key)) {
+        Value before = ReadValue(*it);
+        observer_->OnParamChanged(owner_, key, &before, nullptr);
+    }
+    Release(*it);
+    size_t index = static_cast<size_t>(it - entries_.begin());
+    entries_.erase(it);
+    versions_.erase(versions_.begin() + static_cast<std::ptrdiff_t>(index));
+    EraseDirtyBit(index);
+    ++version_;
+    if (observer_)
+        observer_->OnParamRemoved(owner_, key);
+    return true;
+}
+
+size_t CParams::GetMemoryUsage() const {
+    size_t bytes = entries_.capacity() * sizeof(Entry) + versions_.capacity() * sizeof(uint32_t) +
+                   words_.capacity() * sizeof(uint32_t) + strings_.capacity() * sizeof(std::pmr::string);
+    // past the small string buffer the characters live elsewhere
+    for (const std::pmr::string& text : strings_) {
+        if (text.capacity() > std::pmr::string().capacity())
+            bytes += text.capacity() + 1;
+    }
+    return bytes;
+}
+
+CParams::Entry& CParams::Prepare(ParamKey key, ParamType type) {
+    auto it = LowerBound(key);
+    if (it != entries_.end() && it->key == key) {
+        if (it->GetType() == type)
+            return *it;
+        Release(*it);
+    } else {
+        Entry added;
+        added.key = key;
+        size_t index = static_cast<size_t>(it - entries_.begin());
+        it = entries_.insert(it, added);
+        versions_.insert(versions_.begin() + static_cast<std::ptrdiff_t>(index), 0);
+        InsertDirtyBit(index);
+    }
+
+    uint32_t index = 0;
+    if (type == ParamType::String) {
+        index = static_cast<uint32_t>(strings_.size());
+        strings_.emplace_back();
+    } else {
+        index = static_cast<uint32_t>(words_.size());
+        words_.resize(words_.size() + ParamWordCount(type));
+    }
+    it->tagged_ = index << Entry::kTypeBits | static_cast<uint32_t>(type);
+    return *it;
+}
+
+// Pools stay dense, removals are rare next to reads and same-type writes.
+void CParams::Release(const Entry& entry) {
+    uint32_t index = entry.GetIndex();
+    bool text = entry.GetType() == ParamType::String;
+    uint32_t count = text ? 1 : ParamWordCount(entry.GetType());
+    if (text)
+        strings_.erase(strings_.begin() + index);
+    else
+        words_.erase(words_.begin() + index, words_.begin() + index + count);
+
+    for (Entry& other : entries_) {
+        if ((other.GetType() == ParamType::String) == text && other.GetIndex() > index)
+            other.tagged_ -= count << Entry::kTypeBits;
+    }
+}
+
+void CParams::Notify(ParamKey key, const Value& after) {
+    const Entry* entry = Find(key);
+    if (!entry) {
+        observer_->OnParamChanged(owner_, key, nullptr, &after);
+        return;
+    }
+    Value before = ReadValue(*entry);
+    observer_->OnParamChanged(owner_, key, &before, &after);
+}
+
+void CParams::Touch(size_t index) {
+    versions_[index] = ++version_;
+    bool wasClean = dirty_ == 0;
+    dirty_ |= DirtyBit(index);
+    if (wasClean && observer_)
+        observer_->OnParamsDirty(owner_);
+}
+
+// Bits from index on move up one; the overflow bit stays set if it was.
+void CParams::InsertDirtyBit(size_t index) {
+    if (index >= kOverflowBit)
+        return;
+    uint64_t below = DirtyBit(index) - 1;
+    dirty_ = (dirty_ & below) | ((dirty_ & ~below) << 1) | (dirty_ & DirtyBit(kOverflowBit));
+}
+
+// Bits past index move down one. The overflow bit stays set and may leave a
+// stale bit below it, TakeChanges() checks versions anyway.
+void CParams::EraseDirtyBit(size_t index) {
+    if (index >= kOverflowBit)
+        return;
+    uint64_t below = DirtyBit(index) - 1;
+    dirty_ = (dirty_ & below) | ((dirty_ >> 1) & ~below) | (dirty_ & DirtyBit(kOverflowBit));
+}
+
+void CParams::TakeChanges(std::vector<ParamChange>& out) {
+    for (uint64_t bits = dirty_; bits != 0; bits &= bits - 1) {
+        auto bit = static_cast<size_t>(std::countr_zero(bits));
+        size_t end = bit == kOverflowBit ? entries_.size() : std::min(bit + 1, entries_.size());
+        for (size_t index = bit; index < end; ++index) {
+            if (versions_[index] > syncedVersion_)
+                out.push_back({owner_, entries_[index].key});
+        }
+    }
+    MarkSynced();
+}
@@ -4,76 +4,319 @@
 #define PARAMS_HPP
 
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 #include <variant>
+#include <vector>
 #include "../rendering/Shader.hpp" // For Shader::UniformValue_t
+#include "entity_handle.hpp"
+#include "param_key.hpp"
 
+// Same order as the alternatives of Shader::UniformValue.
+enum class ParamType : uint8_t { Int, Float, Bool, Vec2, Vec3, Vec4, Mat4, String };
+
+template <typename T>
+inline constexpr bool kIsParamType =
+    std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, bool> || std::is_same_v<T, glm::vec2> ||
+    std::is_same_v<T, glm::vec3> || std::is_same_v<T, glm::vec4> || std::is_same_v<T, glm::mat4> ||
+    std::is_same_v<T, std::string>;
+
+template <typename T> constexpr ParamType ParamTypeOf() {
+    static_assert(kIsParamType<T>, "not a param type");
+    if constexpr (std::is_same_v<T, int>) return ParamType::Int;
+    else if constexpr (std::is_same_v<T, float>) return ParamType::Float;
+    else if constexpr (std::is_same_v<T, bool>) return ParamType::Bool;
+    else if constexpr (std::is_same_v<T, glm::vec2>) return ParamType::Vec2;
+    else if constexpr (std::is_same_v<T, glm::vec3>) return ParamType::Vec3;
+    else if constexpr (std::is_same_v<T, glm::vec4>) return ParamType::Vec4;
+    else if constexpr (std::is_same_v<T, glm::mat4>) return ParamType::Mat4;
+    else return ParamType::String;
+}
+
+// 4-byte words a value takes in the number pool; strings have their own.
+constexpr uint32_t ParamWordCount(ParamType type) {
+    switch (type) {
+    case ParamType::Vec2: return 2;
+    case ParamType::Vec3: return 3;
+    case ParamType::Vec4: return 4;
+    case ParamType::Mat4: return 16;
+    case ParamType::String: return 0;
+    default: return 1;
+    }
+}
+
+// A key changed since the last sync; removed keys are reported as such.
+struct ParamChange {
+    EntityHandle owner;
+    ParamKey key;
+    bool removed = false;
+};
+
+//
+// Params are a flat vector of 8-byte entries sorted by key id: the key and
+// a tagged index, the type in the low bits and the position of the value
+// in its pool above. Numbers (ints, floats, bools and the components of
+// vectors and matrices) share one pool of 4-byte words, strings have
+// their own, so a bool costs 16 bytes (entry, version, word) instead of a whole variant sized
+// for a mat4 and a std::string. Typed access goes straight to the pool;
+// Value is only built for callers that ask for one.
+//
+// Key overloads never allocate, and setting an existing param to a value
+// of the same type doesn't either. The string overloads are for the
+// console and files: lookups find the name in the symbol table, and only
+// Set() of a name never seen before adds it.
+//
+// Every change stamps the key with the container's next version and sets
+// the entry's bit in a dirty mask (the last bit covers entries 63 and up,
+// which are told apart by version). The observer hears once when a clean
+// container turns dirty; whoever syncs takes the changed keys with
+// TakeChanges(), which leaves it clean again.
+//
+// Entries and pools come from the memory resource given at construction
+// (the world arena for entities in a World); copies keep the target's
+// resource and never the observer.
+//
 class CParams {
 public:
     using Value = Shader::UniformValue;
 
+    class Entry {
+    public:
+        ParamKey key;
+
+        [[nodiscard]] ParamType GetType() const { return static_cast<ParamType>(tagged_ & kTypeMask); }
+        // Word or string index in the pool of the type.
+        [[nodiscard]] uint32_t GetIndex() const { return tagged_ >> kTypeBits; }
+
+    private:
+        friend class CParams;
+        static constexpr uint32_t kTypeBits = 3;
+        static constexpr uint32_t kTypeMask = (1u << kTypeBits) - 1;
+
+        uint32_t tagged_ = 0;
+    };
+
+    // Hears about every Set/Remove/assignment of a key it watches just
+    // before it is applied, with the value before and after (null: absent).
+    class Observer {
+    public:
+        virtual ~Observer() = default;
+        // Values are only built for watched keys.
+        [[nodiscard]] virtual bool Watches(ParamKey /*key*/) const { return true; }
+        virtual void OnParamChanged(EntityHandle owner, ParamKey key, const Value* before, const Value* after) = 0;
+        // The container went from clean to dirty.
+        virtual void OnParamsDirty(EntityHandle /*owner*/) {}
+        // Removals leave nothing to mark, so they are passed on right away.
+        virtual void OnParamRemoved(EntityHandle /*owner*/, ParamKey /*key*/) {}
+    };
+
+    CParams() = default;
+    explicit CParams(std::pmr::memory_resource* memory)
+        : entries_(memory), versions_(memory), words_(memory), strings_(memory) {}
+    // The copy starts clean.
+    CParams(const CParams& other)
+        : entries_(other.entries_), versions_(other.versions_), words_(other.words_), strings_(other.strings_),
+          version_(other.version_), syncedVersion_(other.version_) {}
+
+    CParams& operator=(const CParams& other);
+
+    void SetObserver(Observer* observer, EntityHandle owner) {
+        observer_ = observer;
+        owner_ = owner;
+    }
+
     // --- Generic Setters ---
-    void Set(const std::string& name, Value value) {
-        values_[name] = std::move(value);
+    void Set(ParamKey key, const Value& value);
+
+    template<typename T>
+    void Set(ParamKey key, const T& value) {
+        if constexpr (!kIsParamType<T>) {
+            Set(key, Value(value));
+        } else {
+            if (observer_ && observer_->Watches(key))
+                Notify(key, Value(value));
+            Entry& entry = Prepare(key, ParamTypeOf<T>());
+            Write(entry, value);
+            Touch(static_cast<size_t>(&entry - entries_.data()));
+        }
     }
 
     template<typename T>
-    void Set(const std::string& name, const T& value) {
-        values_[name] = value;
+    void Set(std::string_view name, const T& value) {
+        Set(ParamKey::Intern(name), value);
     }
 
     // --- Generic Getters ---
-    Value* Get(const std::string& name) {
-        auto it = values_.find(name);
-        if (it != values_.end())
-            return &it->second;
-        return nullptr;
+    // The value as a variant; copies strings.
+    [[nodiscard]] std::optional<Value> Get(ParamKey key) const {
+        const Entry* entry = Find(key);
+        return entry ? std::optional<Value>(ReadValue(*entry)) : std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Value> Get(std::string_view name) const { return Get(ParamKey::Find(name)); }
+
+    // Empty when absent or of another type.
+    template<typename T>
+    [[nodiscard]] std::optional<T> GetAs(ParamKey key) const {
+        const Entry* entry = Find(key);
+        if (!entry || entry->GetType() != ParamTypeOf<T>())
+            return std::nullopt;
+        return Read<T>(*entry);
+    }
+
+    [[nodiscard]] std::optional<std::string_view> GetString(ParamKey key) const {
+        const Entry* entry = Find(key);
+        if (!entry || entry->GetType() != ParamType::String)
+            return std::nullopt;
+        return std::string_view(strings_[entry->GetIndex()]);
     }
 
-    const Value* Get(const std::string& name) const {
-        auto it = values_.find(name);
-        if (it != values_.end())
-            return &it->second;
-        return nullptr;
+    template<typename T>
+    T Get(ParamKey key) const {
+        const Entry* entry = Find(key);
+        if (!entry)
+            throw std::runtime_error("[Params] Attempted to get nonexistent key: " + std::string(key.GetName()));
+        if (entry->GetType() != ParamTypeOf<T>())
+            throw std::runtime_error("[Params] Type mismatch for key: " + std::string(key.GetName()));
+        return Read<T>(*entry);
     }
 
     template<typename T>
-    T Get(const std::string& name) const {
-        auto it = values_.find(name);
-        if (it == values_.end())
-            throw std::runtime_error("[Params] Attempted to get nonexistent key: " + name);
+    T Get(std::string_view name) const {
+        ParamKey key = ParamKey::Find(name);
+        if (!key.IsValid())
+            throw std::runtime_error("[Params] Attempted to get nonexistent key: " + std::string(name));
+        return Get<T>(key);
+    }
 
-        if (auto val = std::get_if<T>(&it->second))
-            return *val;
+    template<typename T>
+    T GetOr(ParamKey key, const T& defaultValue) const {
+        const Entry* entry = Find(key);
+        if (entry && entry->GetType() == ParamTypeOf<T>())
+            return Read<T>(*entry);
+        return defaultValue;
+    }
 
-        throw std::runtime_error("[Params] Type mismatch for key: " + name);
+    template<typename T>
+    T GetOr(std::string_view name, const T& defaultValue) const {
+        return GetOr(ParamKey::Find(name), defaultValue);
     }
 
+    [[nodiscard]] std::optional<ParamType> TypeOf(ParamKey key) const {
+        const Entry* entry = Find(key);
+        return entry ? std::optional<ParamType>(entry->GetType()) : std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<ParamType> TypeOf(std::string_view name) const { return TypeOf(ParamKey::Find(name)); }
+
+    // --- Reading entries of All() ---
+    // T has to be the entry's type.
     template<typename T>
-    T GetOr(const std::string& name, const T& defaultValue) const {
-        auto it = values_.find(name);
-        if (it != values_.end()) {
-            if (auto val = std::get_if<T>(&it->second))
-                return *val;
+    [[nodiscard]] T Read(const Entry& entry) const {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(strings_[entry.GetIndex()]);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return words_[entry.GetIndex()] != 0;
+        } else {
+            static_assert(sizeof(T) == sizeof(uint32_t) * ParamWordCount(ParamTypeOf<T>()));
+            T value;
+            std::memcpy(static_cast<void*>(&value), words_.data() + entry.GetIndex(), sizeof(T));
+            return value;
         }
-        return defaultValue;
     }
 
+    [[nodiscard]] std::string_view ReadString(const Entry& entry) const { return strings_[entry.GetIndex()]; }
+    [[nodiscard]] Value ReadValue(const Entry& entry) const;
+
     // --- Management ---
-    bool Remove(const std::string& name) {
-        return values_.erase(name) > 0;
-    }
+    bool Remove(ParamKey key);
+    bool Remove(std::string_view name) { return Remove(ParamKey::Find(name)); }
+
+    bool Has(ParamKey key) const { return Find(key) != nullptr; }
+    bool Has(std::string_view name) const { return Has(ParamKey::Find(name)); }
 
-    bool Has(const std::string& name) const {
-        return values_.find(name) != values_.end();
+    // --- Changes ---
+    // Bumped by every change.
+    [[nodiscard]] uint32_t GetVersion() const { return version_; }
+    // Container version of the key's last change, 0 when absent.
+    [[nodiscard]] uint32_t GetVersion(ParamKey key) const {
+        const Entry* entry = Find(key);
+        return entry ? versions_[static_cast<size_t>(entry - entries_.data())] : 0;
+    }
+    [[nodiscard]] bool IsDirty() const { return dirty_ != 0; }
+    // Appends the keys changed since the last call (owner as given to
+    // SetObserver) and marks the container clean.
+    void TakeChanges(std::vector<ParamChange>& out);
+    // Clean without reporting anything, for a freshly attached entity.
+    void MarkSynced() {
+        dirty_ = 0;
+        syncedVersion_ = version_;
     }
 
-    const auto& All() const { return values_; }
+    // Sorted by key id, not by name.
+    std::span<const Entry> All() const { return entries_; }
+    size_t Size() const { return entries_.size(); }
+    // Bytes held by the entries and pools, long strings included.
+    [[nodiscard]] size_t GetMemoryUsage() const;
 
 private:
-    std::unordered_map<std::string, Value> values_;
+    [[nodiscard]] const Entry* Find(ParamKey key) const {
+        auto it = LowerBound(key);
+        return it != entries_.end() && it->key == key ? &*it : nullptr;
+    }
+
+    // an invalid key sorts last and never matches
+    std::pmr::vector<Entry>::iterator LowerBound(ParamKey key) {
+        return std::lower_bound(entries_.begin(), entries_.end(), key,
+                                [](const Entry& entry, ParamKey k) { return entry.key < k; });
+    }
+
+    std::pmr::vector<Entry>::const_iterator LowerBound(ParamKey key) const {
+        return std::lower_bound(entries_.begin(), entries_.end(), key,
+                                [](const Entry& entry, ParamKey k) { return entry.key < k; });
+    }
+
+    // The entry for key with room for a value of type, added or retyped as needed.
+    Entry& Prepare(ParamKey key, ParamType type);
+    // Gives the entry's slot back to its pool; later indices shift down.
+    void Release(const Entry& entry);
+    void Notify(ParamKey key, const Value& after);
+    void Touch(size_t index);
+    // Keep the dirty bits lined up with entries when one is added or removed.
+    void InsertDirtyBit(size_t index);
+    void EraseDirtyBit(size_t index);
+
+    static constexpr size_t kOverflowBit = 63;
+    static uint64_t DirtyBit(size_t index) { return uint64_t(1) << std::min(index, kOverflowBit); }
+
+    template<typename T>
+    void Write(const Entry& entry, const T& value) {
+        if constexpr (std::is_same_v<T, std::string>)
+            strings_[entry.GetIndex()].assign(value);
+        else if constexpr (std::is_same_v<T, bool>)
+            words_[entry.GetIndex()] = value ? 1u : 0u;
+        else
+            std::memcpy(words_.data() + entry.GetIndex(), static_cast<const void*>(&value), sizeof(T));
+    }
+
+    std::pmr::vector<Entry> entries_;
+    std::pmr::vector<uint32_t> versions_; // per entry, the version of its last change
+    std::pmr::vector<uint32_t> words_;
+    std::pmr::vector<std::pmr::string> strings_;
+    uint64_t dirty_ = 0;
+    uint32_t version_ = 0;
+    uint32_t syncedVersion_ = 0;
+    Observer* observer_ = nullptr;
+    EntityHandle owner_;
 };
 
 #endif // PARAMS_HPP
@@ -0,0 +1,45 @@
+#ifndef TRANSFORM_HPP
+#define TRANSFORM_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+//
+// === Transform ===
+//
+struct Transform {
+    glm::vec3 position{0.0f};
+    glm::vec3 rotation{0.0f};
+    glm::vec3 scale{1.0f};
+
+    [[nodiscard]] glm::mat4 GetModelMatrix() const {
+        glm::mat4 model(1.0f);
+        model = glm::translate(model, position);
+        model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1, 0, 0));
+        model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0, 1, 0));
+        model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0, 0, 1));
+        model = glm::scale(model, scale);
+        return model;
+    }
+};
+
+//
+// === Bounds ===
+// Axis aligned box, local (mesh) or world space.
+//
+struct Bounds {
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+
+    // Box around the transformed corners, via center/extent.
+    [[nodiscard]] Bounds Transformed(const glm::mat4& m) const {
+        glm::vec3 center = (min + max) * 0.5f;
+        glm::vec3 extent = (max - min) * 0.5f;
+        glm::vec3 worldCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+        glm::vec3 worldExtent = glm::abs(glm::vec3(m[0])) * extent.x + glm::abs(glm::vec3(m[1])) * extent.y +
+                                glm::abs(glm::vec3(m[2])) * extent.z;
+        return {worldCenter - worldExtent, worldCenter + worldExtent};
+    }
+};
+
+#endif // TRANSFORM_HPP
@@ -0,0 +1,309 @@
+#include "transform_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TRANSFORM_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TRANSFORM_KERNELS_AVX2
+#else
+#define TRANSFORM_KERNELS_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+// the SIMD loaders index into Transform as 9 packed floats
+static_assert(sizeof(Transform) == 9 * sizeof(float));
+static_assert(offsetof(Transform, rotation) == 3 * sizeof(float));
+static_assert(offsetof(Transform, scale) == 6 * sizeof(float));
+static_assert(sizeof(glm::mat4) == 16 * sizeof(float));
+
+namespace {
+
+// half angle in radians per degree
+constexpr float kHalfRadians = 3.14159265358979f / 360.0f;
+
+//
+// === Scalar ===
+//
+struct Quaternion {
+    float w, x, y, z;
+};
+
+// q = qx * qy * qz, i.e. the same X then Y then Z as GetModelMatrix.
+Quaternion EulerToQuaternion(const glm::vec3& degrees) {
+    float cx = std::cos(degrees.x * kHalfRadians), sx = std::sin(degrees.x * kHalfRadians);
+    float cy = std::cos(degrees.y * kHalfRadians), sy = std::sin(degrees.y * kHalfRadians);
+    float cz = std::cos(degrees.z * kHalfRadians), sz = std::sin(degrees.z * kHalfRadians);
+    return {cx * cy * cz - sx * sy * sz, sx * cy * cz + cx * sy * sz, cx * sy * cz - sx * cy * sz,
+            cx * cy * sz + sx * sy * cz};
+}
+
+glm::mat4 ComposeScalar(const Transform& t) {
+    Quaternion q = EulerToQuaternion(t.rotation);
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    glm::mat4 m;
+    m[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * t.scale.x;
+    m[1] = glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * t.scale.y;
+    m[2] = glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * t.scale.z;
+    m[3] = glm::vec4(t.position, 1.0f);
+    return m;
+}
+
+void ComposeRangeScalar(const Transform* in, glm::mat4* out, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = ComposeScalar(in[i]);
+}
+
+#ifdef TRANSFORM_KERNELS_X86
+
+// sin/cos minimax polynomials on [-pi/4, pi/4] (Cephes) and pi/2 split in
+// three for the range reduction
+constexpr float kSin1 = -1.6666654611e-1f, kSin2 = 8.3321608736e-3f, kSin3 = -1.9515295891e-4f;
+constexpr float kCos1 = 4.166664568298827e-2f, kCos2 = -1.388731625493765e-3f, kCos3 = 2.443315711809948e-5f;
+constexpr float kTwoOverPi = 0.636619772367581f;
+constexpr float kPiOver2a = 1.5703125f, kPiOver2b = 4.837512969970703125e-4f, kPiOver2c = 7.54978995489188216e-8f;
+
+//
+// === SSE2 ===
+//
+inline void SinCos(__m128 x, __m128& sinOut, __m128& cosOut) {
+    __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(kTwoOverPi)));
+    __m128 j = _mm_cvtepi32_ps(quadrant);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(kPiOver2a)));
+    r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(kPiOver2b)));
+    r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(kPiOver2c)));
+    __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kSin3), r2), _mm_set1_ps(kSin2));
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(kSin1));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+    __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kCos3), r2), _mm_set1_ps(kCos2));
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(kCos1));
+    c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+    c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    // odd quadrants swap sin and cos, the sign comes from bit 1
+    __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+    __m128 sinValue = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+    __m128 cosValue = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+    sinOut = _mm_xor_ps(sinValue, sinSign);
+    cosOut = _mm_xor_ps(cosValue, cosSign);
+}
+
+// Transposes four lanes' worth of one column (rows a..d) and stores it.
+inline void StoreColumn(glm::mat4* out, int column, __m128 a, __m128 b, __m128 c, __m128 d) {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_storeu_ps(&out[0][column][0], a);
+    _mm_storeu_ps(&out[1][column][0], b);
+    _mm_storeu_ps(&out[2][column][0], c);
+    _mm_storeu_ps(&out[3][column][0], d);
+}
+
+// Four transforms -> four matrices.
+void ComposeBlockSSE2(const Transform* in, glm::mat4* out) {
+    const float* f = &in[0].position.x;
+    __m128 field[9];
+    for (int k = 0; k < 9; ++k)
+        field[k] = _mm_setr_ps(f[k], f[9 + k], f[18 + k], f[27 + k]);
+
+    __m128 half = _mm_set1_ps(kHalfRadians);
+    __m128 sx, cx, sy, cy, sz, cz;
+    SinCos(_mm_mul_ps(field[3], half), sx, cx);
+    SinCos(_mm_mul_ps(field[4], half), sy, cy);
+    SinCos(_mm_mul_ps(field[5], half), sz, cz);
+
+    __m128 cxcy = _mm_mul_ps(cx, cy), sxsy = _mm_mul_ps(sx, sy);
+    __m128 sxcy = _mm_mul_ps(sx, cy), cxsy = _mm_mul_ps(cx, sy);
+    __m128 w = _mm_sub_ps(_mm_mul_ps(cxcy, cz), _mm_mul_ps(sxsy, sz));
+    __m128 x = _mm_add_ps(_mm_mul_ps(sxcy, cz), _mm_mul_ps(cxsy, sz));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(cxsy, cz), _mm_mul_ps(sxcy, sz));
+    __m128 z = _mm_add_ps(_mm_mul_ps(cxcy, sz), _mm_mul_ps(sxsy, cz));
+
+    __m128 two = _mm_set1_ps(2.0f), one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+    __m128 x2 = _mm_mul_ps(x, two), y2 = _mm_mul_ps(y, two), z2 = _mm_mul_ps(z, two);
+    __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+    __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+    __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+    __m128 scaleX = field[6], scaleY = field[7], scaleZ = field[8];
+    StoreColumn(out, 0, _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scaleX),
+                _mm_mul_ps(_mm_add_ps(xy, wz), scaleX), _mm_mul_ps(_mm_sub_ps(xz, wy), scaleX), zero);
+    StoreColumn(out, 1, _mm_mul_ps(_mm_sub_ps(xy, wz), scaleY),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scaleY), _mm_mul_ps(_mm_add_ps(yz, wx), scaleY), zero);
+    StoreColumn(out, 2, _mm_mul_ps(_mm_add_ps(xz, wy), scaleZ), _mm_mul_ps(_mm_sub_ps(yz, wx), scaleZ),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scaleZ), zero);
+    StoreColumn(out, 3, field[0], field[1], field[2], one);
+}
+
+//
+// === AVX2 ===
+//
+TRANSFORM_KERNELS_AVX2 inline void SinCos(__m256 x, __m256& sinOut, __m256& cosOut) {
+    __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(kTwoOverPi)));
+    __m256 j = _mm256_cvtepi32_ps(quadrant);
+    __m256 r = _mm256_fnmadd_ps(j, _mm256_set1_ps(kPiOver2a), x);
+    r = _mm256_fnmadd_ps(j, _mm256_set1_ps(kPiOver2b), r);
+    r = _mm256_fnmadd_ps(j, _mm256_set1_ps(kPiOver2c), r);
+    __m256 r2 = _mm256_mul_ps(r, r);
+
+    __m256 s = _mm256_fmadd_ps(_mm256_set1_ps(kSin3), r2, _mm256_set1_ps(kSin2));
+    s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps(kSin1));
+    s = _mm256_fmadd_ps(_mm256_mul_ps(s, r2), r, r);
+
+    __m256 c = _mm256_fmadd_ps(_mm256_set1_ps(kCos3), r2, _mm256_set1_ps(kCos2));
+    c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(kCos1));
+    c = _mm256_mul_ps(_mm256_mul_ps(c, r2), r2);
+    c = _mm256_add_ps(_mm256_fnmadd_ps(r2, _mm256_set1_ps(0.5f), c), _mm256_set1_ps(1.0f));
+
+    __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+    __m256 sinValue = _mm256_blendv_ps(s, c, swap);
+    __m256 cosValue = _mm256_blendv_ps(c, s, swap);
+    __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+    __m256 cosSign =
+        _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+    sinOut = _mm256_xor_ps(sinValue, sinSign);
+    cosOut = _mm256_xor_ps(cosValue, cosSign);
+}
+
+TRANSFORM_KERNELS_AVX2 inline void StoreColumn(glm::mat4* out, int column, __m256 a, __m256 b, __m256 c,
+                                               __m256 d) {
+    StoreColumn(out, column, _mm256_castps256_ps128(a), _mm256_castps256_ps128(b), _mm256_castps256_ps128(c),
+                _mm256_castps256_ps128(d));
+    StoreColumn(out + 4, column, _mm256_extractf128_ps(a, 1), _mm256_extractf128_ps(b, 1),
+                _mm256_extractf128_ps(c, 1), _mm256_extractf128_ps(d, 1));
+}
+
+// Eight transforms -> eight matrices.
+TRANSFORM_KERNELS_AVX2 void ComposeBlockAVX2(const Transform* in, glm::mat4* out) {
+    const float* f = &in[0].position.x;
+    const __m256i stride = _mm256_setr_epi32(0, 9, 18, 27, 36, 45, 54, 63);
+    __m256 field[9];
+    for (int k = 0; k < 9; ++k)
+        field[k] = _mm256_i32gather_ps(f + k, stride, 4);
+
+    __m256 half = _mm256_set1_ps(kHalfRadians);
+    __m256 sx, cx, sy, cy, sz, cz;
+    SinCos(_mm256_mul_ps(field[3], half), sx, cx);
+    SinCos(_mm256_mul_ps(field[4], half), sy, cy);
+    SinCos(_mm256_mul_ps(field[5], half), sz, cz);
+
+    __m256 cxcy = _mm256_mul_ps(cx, cy), sxsy = _mm256_mul_ps(sx, sy);
+    __m256 sxcy = _mm256_mul_ps(sx, cy), cxsy = _mm256_mul_ps(cx, sy);
+    __m256 w = _mm256_fmsub_ps(cxcy, cz, _mm256_mul_ps(sxsy, sz));
+    __m256 x = _mm256_fmadd_ps(sxcy, cz, _mm256_mul_ps(cxsy, sz));
+    __m256 y = _mm256_fmsub_ps(cxsy, cz, _mm256_mul_ps(sxcy, sz));
+    __m256 z = _mm256_fmadd_ps(cxcy, sz, _mm256_mul_ps(sxsy, cz));
+
+    __m256 two = _mm256_set1_ps(2.0f), one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+    __m256 x2 = _mm256_mul_ps(x, two), y2 = _mm256_mul_ps(y, two), z2 = _mm256_mul_ps(z, two);
+    __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+    __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+    __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+    __m256 scaleX = field[6], scaleY = field[7], scaleZ = field[8];
+    StoreColumn(out, 0, _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), scaleX),
+                _mm256_mul_ps(_mm256_add_ps(xy, wz), scaleX), _mm256_mul_ps(_mm256_sub_ps(xz, wy), scaleX), zero);
+    StoreColumn(out, 1, _mm256_mul_ps(_mm256_sub_ps(xy, wz), scaleY),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), scaleY),
+                _mm256_mul_ps(_mm256_add_ps(yz, wx), scaleY), zero);
+    StoreColumn(out, 2, _mm256_mul_ps(_mm256_add_ps(xz, wy), scaleZ), _mm256_mul_ps(_mm256_sub_ps(yz, wx), scaleZ),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), scaleZ), zero);
+    StoreColumn(out, 3, field[0], field[1], field[2], one);
+}
+
+// Runs full blocks in place; the tail goes through a padded copy so every
+// transform sees the same math regardless of where it sits in the span.
+template <size_t Width, void (*Block)(const Transform*, glm::mat4*)>
+void ComposeRange(const Transform* in, glm::mat4* out, size_t count) {
+    size_t full = count - count % Width;
+    for (size_t i = 0; i < full; i += Width)
+        Block(in + i, out + i);
+
+    if (size_t rest = count - full) {
+        Transform paddedIn[Width];
+        glm::mat4 paddedOut[Width];
+        std::copy(in + full, in + count, paddedIn);
+        Block(paddedIn, paddedOut);
+        std::copy(paddedOut, paddedOut + rest, out + full);
+    }
+}
+
+bool CpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = info[2] & (1 << 12), osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+    // the OS has to save the upper halves of the ymm registers too
+    if (!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif // TRANSFORM_KERNELS_X86
+
+TransformKernels::Path DetectPath() {
+#ifdef TRANSFORM_KERNELS_X86
+    return CpuHasAVX2() ? TransformKernels::Path::AVX2 : TransformKernels::Path::SSE2;
+#else
+    return TransformKernels::Path::Scalar;
+#endif
+}
+
+} // namespace
+
+namespace TransformKernels {
+
+Path GetActivePath() {
+    static const Path path = DetectPath();
+    return path;
+}
+
+bool IsSupported(Path path) {
+    return static_cast<int>(path) <= static_cast<int>(GetActivePath());
+}
+
+const char* PathName(Path path) {
+    switch (path) {
+    case Path::Scalar: return "scalar";
+    case Path::SSE2: return "sse2";
+    case Path::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+glm::mat4 ComposeModelMatrix(const Transform& transform) { return ComposeScalar(transform); }
+
+void ComposeModelMatrices(std::span<const Transform> transforms, std::span<glm::mat4> out) {
+    ComposeModelMatrices(transforms, out, GetActivePath());
+}
+
+void ComposeModelMatrices(std::span<const Transform> transforms, std::span<glm::mat4> out, Path path) {
+    size_t count = std::min(transforms.size(), out.size());
+    if (!IsSupported(path))
+        path = Path::Scalar;
+
+    switch (path) {
+#ifdef TRANSFORM_KERNELS_X86
+    case Path::AVX2: ComposeRange<8, ComposeBlockAVX2>(transforms.data(), out.data(), count); break;
+    case Path::SSE2: ComposeRange<4, ComposeBlockSSE2>(transforms.data(), out.data(), count); break;
+#endif
+    default: ComposeRangeScalar(transforms.data(), out.data(), count); break;
+    }
+}
+
+} // namespace TransformKernels
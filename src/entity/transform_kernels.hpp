@@ -0,0 +1,37 @@
+#ifndef TRANSFORM_KERNELS_HPP
+#define TRANSFORM_KERNELS_HPP
+
+#include "transform.hpp"
+#include <glm/glm.hpp>
+#include <span>
+
+//
+// === TransformKernels ===
+// Batch TRS -> model matrix. The Euler angles (degrees, applied X then Y then
+// Z like Transform::GetModelMatrix) are folded into one quaternion per
+// transform, and the matrix is built straight from it instead of going
+// through three glm::rotate calls.
+//
+// The SIMD paths run 4 (SSE2) or 8 (AVX2 + FMA) transforms per step with a
+// polynomial sin/cos; results match the scalar path to ~1e-6. The widest
+// path the CPU supports is picked once at startup.
+//
+namespace TransformKernels {
+
+enum class Path { Scalar, SSE2, AVX2 };
+
+// out must be at least as long as transforms.
+void ComposeModelMatrices(std::span<const Transform> transforms, std::span<glm::mat4> out);
+// Forces a path, falls back to scalar if the CPU can't run it (benchmarks).
+void ComposeModelMatrices(std::span<const Transform> transforms, std::span<glm::mat4> out, Path path);
+
+// Single transform through the scalar path.
+glm::mat4 ComposeModelMatrix(const Transform& transform);
+
+Path GetActivePath();
+bool IsSupported(Path path);
+const char* PathName(Path path);
+
+} // namespace TransformKernels
+
+#endif // TRANSFORM_KERNELS_HPP
@@ -0,0 +1,146 @@
+#include "atomic_file.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static void CreateParentDirectories(const std::string& path) {
+    fs::path target(path);
+    std::error_code ec;
+    if (target.has_parent_path())
+        fs::create_directories(target.parent_path(), ec);
+}
+
+#ifdef _WIN32
+
+std::unique_ptr<AtomicFile> AtomicFile::Create(const std::string& path) {
+    CreateParentDirectories(path);
+    std::string tempPath = path + ".tmp";
+    HANDLE file = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    std::unique_ptr<AtomicFile> result(new AtomicFile());
+    result->path_ = path;
+    result->tempPath_ = std::move(tempPath);
+    result->file_ = file;
+    return result;
+}
+
+bool AtomicFile::Write(const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0 && !failed_) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(file_, bytes, chunk, &written, nullptr) || written == 0) {
+            failed_ = true;
+            break;
+        }
+        bytes += written;
+        size -= written;
+        size_ += written;
+    }
+    return !failed_;
+}
+
+bool AtomicFile::Commit() {
+    if (committed_ || failed_ || !file_)
+        return false;
+    bool synced = FlushFileBuffers(file_) != 0;
+    Close();
+    // write through: the rename is on disk when this returns
+    if (!synced || !MoveFileExA(tempPath_.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        failed_ = true;
+        return false;
+    }
+    committed_ = true;
+    return true;
+}
+
+void AtomicFile::Close() {
+    if (file_)
+        CloseHandle(file_);
+    file_ = nullptr;
+}
+
+#else
+
+std::unique_ptr<AtomicFile> AtomicFile::Create(const std::string& path) {
+    CreateParentDirectories(path);
+    std::string tempPath = path + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return nullptr;
+
+    std::unique_ptr<AtomicFile> result(new AtomicFile());
+    result->path_ = path;
+    result->tempPath_ = std::move(tempPath);
+    result->fd_ = fd;
+    return result;
+}
+
+bool AtomicFile::Write(const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0 && !failed_) {
+        ssize_t written = write(fd_, bytes, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) {
+            failed_ = true;
+            break;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+        size_ += static_cast<size_t>(written);
+    }
+    return !failed_;
+}
+
+bool AtomicFile::Commit() {
+    if (committed_ || failed_ || fd_ < 0)
+        return false;
+    bool synced = fsync(fd_) == 0;
+    Close();
+    if (!synced || rename(tempPath_.c_str(), path_.c_str()) != 0) {
+        failed_ = true;
+        return false;
+    }
+    committed_ = true;
+
+    // the rename lives in the directory, which has to reach the disk too
+    fs::path directory = fs::path(path_).parent_path();
+    int dirFd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
+
+void AtomicFile::Close() {
+    if (fd_ >= 0)
+        close(fd_);
+    fd_ = -1;
+}
+
+#endif
+
+AtomicFile::~AtomicFile() {
+    Close();
+    if (!committed_) {
+        std::error_code ec;
+        fs::remove(tempPath_, ec);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef ATOMIC_FILE_HPP
+#define ATOMIC_FILE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+//
+// === AtomicFile ===
+// Replaces a file all at once. Writes go to path + ".tmp"; Commit() syncs
+// it to disk and renames it over the target, then syncs the directory, so
+// after a crash the target is either the old file or the whole new one.
+// Dropped without Commit() (or a failed write), the temporary is deleted.
+// Create() returns nullptr if the temporary cannot be created.
+//
+class AtomicFile {
+public:
+    static std::unique_ptr<AtomicFile> Create(const std::string& path);
+    ~AtomicFile();
+
+    AtomicFile(const AtomicFile&) = delete;
+    AtomicFile& operator=(const AtomicFile&) = delete;
+
+    bool Write(const void* data, size_t size);
+    bool Commit();
+
+    [[nodiscard]] size_t GetSize() const { return size_; }
+    [[nodiscard]] const std::string& GetPath() const { return path_; }
+
+private:
+    AtomicFile() = default;
+    void Close();
+
+    std::string path_;
+    std::string tempPath_;
+    size_t size_ = 0;
+    bool failed_ = false;
+    bool committed_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+#endif // ATOMIC_FILE_HPP
@@ -0,0 +1,89 @@
+#include "mapped_file.hpp"
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        std::cerr << "[MappedFile][WARN] Failed to map " << path << std::endl;
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedFile> result(new MappedFile());
+    result->path_ = path;
+    result->data_ = static_cast<const unsigned char*>(view);
+    result->size_ = static_cast<size_t>(size.QuadPart);
+    result->file_ = file;
+    result->mapping_ = mapping;
+    return result;
+}
+
+MappedFile::~MappedFile() {
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_)
+        CloseHandle(file_);
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference
+    if (view == MAP_FAILED) {
+        std::cerr << "[MappedFile][WARN] Failed to map " << path << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedFile> result(new MappedFile());
+    result->path_ = path;
+    result->data_ = static_cast<const unsigned char*>(view);
+    result->size_ = static_cast<size_t>(info.st_size);
+    return result;
+}
+
+MappedFile::~MappedFile() {
+    if (data_)
+        munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+//
+// === MappedFile ===
+// Read-only memory mapping of a whole file. Open() returns nullptr if the file
+// does not exist or cannot be mapped. The mapping lives as long as the object.
+//
+class MappedFile {
+public:
+    static std::shared_ptr<MappedFile> Open(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const unsigned char* Data() const { return data_; }
+    [[nodiscard]] size_t Size() const { return size_; }
+    [[nodiscard]] const std::string& GetPath() const { return path_; }
+
+private:
+    MappedFile() = default;
+
+    std::string path_;
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
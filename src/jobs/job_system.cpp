@@ -0,0 +1,261 @@
+#include "job_system.hpp"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace {
+
+// index of the worker running on this thread, -1 outside the pool
+thread_local int tWorker = -1;
+
+// a ParallelFor isn't split finer than this many chunks per thread
+constexpr size_t kChunksPerThread = 4;
+
+} // namespace
+
+JobSystem& JobSystem::Instance() {
+    static JobSystem instance;
+    return instance;
+}
+
+JobSystem::JobSystem() : mainThread_(std::this_thread::get_id()) {
+    // the main thread takes its share in Wait(), so leave it a core
+    unsigned workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers_.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers_[i]->thread = std::thread([this, i]() { WorkerLoop(static_cast<int>(i)); });
+
+    std::cout << "[JOBS] Started " << workerCount << " workers" << std::endl;
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker->thread.join();
+}
+
+void JobSystem::Schedule(std::function<void()> task, JobCounter* counter, JobCounter* after) {
+    Job job;
+    job.task = std::move(task);
+    job.counter = counter;
+    Submit(std::move(job), after);
+}
+
+void JobSystem::ScheduleOnMainThread(std::function<void()> task, JobCounter* counter, JobCounter* after) {
+    Job job;
+    job.task = std::move(task);
+    job.counter = counter;
+    job.mainThread = true;
+    Submit(std::move(job), after);
+}
+
+//
+// Counts the job right away so Wait() covers it even while it is parked on
+// its dependency. The dependency is rechecked under its lock: whoever
+// finishes it takes the continuations under the same lock.
+//
+void JobSystem::Submit(Job job, JobCounter* after) {
+    if (job.counter)
+        job.counter->pending_.fetch_add(1, std::memory_order_acq_rel);
+
+    if (after && !after->IsDone()) {
+        std::lock_guard<std::mutex> lock(after->mutex_);
+        if (!after->IsDone()) {
+            after->continuations_.push_back(std::move(job));
+            return;
+        }
+    }
+    Enqueue(std::move(job));
+}
+
+void JobSystem::Enqueue(Job job) {
+    if (job.mainThread) {
+        std::lock_guard<std::mutex> lock(mainMutex_);
+        mainJobs_.push_back(std::move(job));
+        return;
+    }
+
+    // a worker keeps what it spawns, outside jobs are dealt round robin
+    size_t target = tWorker >= 0 ? static_cast<size_t>(tWorker)
+                                 : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->jobs.push_back(std::move(job));
+    }
+    queued_.fetch_add(1);
+
+    // pairs with the sleepers_/queued_ check in WorkerLoop, no wakeup gets lost
+    if (sleepers_.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        wake_.notify_one();
+    }
+}
+
+//
+// Own deque from the back (newest, still in cache), then the front (oldest,
+// likely the biggest piece of work left) of everybody else's.
+//
+bool JobSystem::TryPop(int self, Job& job) {
+    if (self >= 0) {
+        Worker& own = *workers_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    if (queued_.load() == 0)
+        return false;
+
+    size_t count = workers_.size();
+    size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : nextWorker_.load(std::memory_order_relaxed);
+    for (size_t k = 0; k < count; ++k) {
+        size_t victim = (start + k) % count;
+        if (static_cast<int>(victim) == self)
+            continue;
+        Worker& other = *workers_[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (other.jobs.empty())
+            continue;
+        job = std::move(other.jobs.front());
+        other.jobs.pop_front();
+        queued_.fetch_sub(1);
+        if (self >= 0)
+            workers_[self]->stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::TryRunOne(int self) {
+    Job job;
+    if (!TryPop(self, job))
+        return false;
+
+    Run(job);
+    if (self >= 0)
+        workers_[self]->executed.fetch_add(1, std::memory_order_relaxed);
+    else
+        mainExecuted_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void JobSystem::Run(Job& job) {
+    try {
+        if (job.range)
+            job.range(job.body, job.begin, job.end);
+        else if (job.task)
+            job.task();
+    } catch (const std::exception& e) {
+        std::cerr << "[JOBS][WARN] Job threw: " << e.what() << std::endl;
+    }
+
+    JobCounter* counter = job.counter;
+    if (!counter)
+        return;
+
+    // under the lock, so Wait() can't return and free the counter while we're in it
+    std::vector<Job> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex_);
+        if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ready.swap(counter->continuations_);
+    }
+    for (Job& next : ready)
+        Enqueue(std::move(next));
+}
+
+void JobSystem::WorkerLoop(int self) {
+    tWorker = self;
+    while (true) {
+        if (TryRunOne(self))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this]() { return stopping_ || queued_.load() > 0; });
+        sleepers_.fetch_sub(1);
+        if (stopping_)
+            return;
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    int self = tWorker;
+    while (!counter.IsDone()) {
+        if (!TryRunOne(self))
+            std::this_thread::yield();
+    }
+    // the job that finished it may still hold the lock
+    std::lock_guard<std::mutex> sync(counter.mutex_);
+}
+
+size_t JobSystem::RunMainThreadJobs() {
+    // only what's queued now, jobs scheduled by these wait for the next frame
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(mainMutex_);
+        count = mainJobs_.size();
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(mainMutex_);
+            job = std::move(mainJobs_.front());
+            mainJobs_.pop_front();
+        }
+        Run(job);
+        mainExecuted_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+void JobSystem::ParallelForImpl(size_t count, size_t grain, Job::RangeFunction range, void* body) {
+    if (count == 0)
+        return;
+    size_t chunks = std::min((count + std::max<size_t>(grain, 1) - 1) / std::max<size_t>(grain, 1),
+                             (workers_.size() + 1) * kChunksPerThread);
+    if (chunks <= 1) {
+        range(body, 0, count);
+        return;
+    }
+
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    JobCounter counter;
+    for (size_t begin = chunkSize; begin < count; begin += chunkSize) {
+        Job job;
+        job.range = range;
+        job.body = body;
+        job.begin = begin;
+        job.end = std::min(begin + chunkSize, count);
+        job.counter = &counter;
+        Submit(std::move(job), nullptr);
+    }
+
+    // the other chunks point at body, so they have to finish even if ours throws
+    try {
+        range(body, 0, chunkSize);
+    } catch (...) {
+        Wait(counter);
+        throw;
+    }
+    Wait(counter);
+}
+
+JobSystem::Stats JobSystem::GetStats() const {
+    Stats stats;
+    stats.executed = mainExecuted_.load(std::memory_order_relaxed);
+    for (const auto& worker : workers_) {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
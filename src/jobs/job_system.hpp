@@ -0,0 +1,141 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class JobCounter;
+
+// A unit of work: either a task, or one chunk of a ParallelFor (function
+// pointer plus range, so splitting a loop never allocates).
+struct Job {
+    using RangeFunction = void (*)(void* body, size_t begin, size_t end);
+
+    std::function<void()> task;
+    RangeFunction range = nullptr;
+    void* body = nullptr;
+    size_t begin = 0;
+    size_t end = 0;
+    JobCounter* counter = nullptr;
+    bool mainThread = false;
+};
+
+//
+// === JobCounter ===
+// Counts unfinished jobs scheduled against it; jobs scheduled to run after it
+// wait here until it reaches zero. Must outlive everything that uses it.
+//
+class JobCounter {
+  public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    [[nodiscard]] bool IsDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+    [[nodiscard]] uint32_t GetPending() const { return pending_.load(std::memory_order_acquire); }
+
+  private:
+    friend class JobSystem;
+    std::atomic<uint32_t> pending_{0};
+    std::mutex mutex_;
+    std::vector<Job> continuations_;
+};
+
+//
+// === JobSystem ===
+// Fixed pool of worker threads, started once, each with its own deque: a
+// worker pushes and pops its own jobs at the back and, when it runs dry,
+// steals the oldest job from another worker's front. Jobs scheduled from
+// outside the pool are dealt round robin. Threads that Wait() run jobs
+// themselves instead of blocking, so waiting inside a job can't deadlock.
+//
+// Main thread jobs (anything touching GL or the World) go to a separate
+// queue drained only by RunMainThreadJobs() once per frame, at a point where
+// nothing else uses the world. Waiting on one from the main thread
+// anywhere else never finishes.
+//
+// The first Instance() call has to come from the main thread.
+//
+class JobSystem {
+  public:
+    struct Stats {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;
+    };
+
+    static JobSystem& Instance();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Runs task on a worker. With after, not before that counter is done.
+    void Schedule(std::function<void()> task, JobCounter* counter = nullptr, JobCounter* after = nullptr);
+    // Runs task on the main thread, at the next RunMainThreadJobs().
+    void ScheduleOnMainThread(std::function<void()> task, JobCounter* counter = nullptr,
+                              JobCounter* after = nullptr);
+
+    // Calls body(begin, end) over [0, count) in chunks of at least grain and
+    // returns once all of them ran. The calling thread takes a share.
+    template <typename Body> void ParallelFor(size_t count, size_t grain, Body&& body);
+
+    // Runs other jobs until counter is done.
+    void Wait(JobCounter& counter);
+    // Main thread, once per frame. Returns the number of jobs run.
+    size_t RunMainThreadJobs();
+
+    [[nodiscard]] size_t GetWorkerCount() const { return workers_.size(); }
+    [[nodiscard]] bool IsMainThread() const { return std::this_thread::get_id() == mainThread_; }
+    [[nodiscard]] Stats GetStats() const;
+
+  private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+    };
+
+    JobSystem();
+    ~JobSystem();
+
+    void Submit(Job job, JobCounter* after);
+    void Enqueue(Job job);
+    bool TryRunOne(int self);
+    bool TryPop(int self, Job& job);
+    void Run(Job& job);
+    void WorkerLoop(int self);
+    void ParallelForImpl(size_t count, size_t grain, Job::RangeFunction range, void* body);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::thread::id mainThread_;
+
+    std::mutex mainMutex_;
+    std::deque<Job> mainJobs_;
+
+    // sleeping workers: queued_ counts jobs sitting in worker deques
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<uint32_t> nextWorker_{0};
+    std::atomic<uint64_t> mainExecuted_{0};
+    bool stopping_ = false;
+};
+
+template <typename Body> void JobSystem::ParallelFor(size_t count, size_t grain, Body&& body) {
+    using Callable = std::remove_reference_t<Body>;
+    auto range = [](void* callable, size_t begin, size_t end) { (*static_cast<Callable*>(callable))(begin, end); };
+    ParallelForImpl(count, grain, range, const_cast<void*>(static_cast<const void*>(&body)));
+}
+
+#endif // JOB_SYSTEM_HPP
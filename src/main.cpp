@@ -1,42 +1,256 @@
+#include "bench/frame_stats.hpp"
+#include "bench/gpu_profiler.hpp"
 #include "console/console.hpp"
+#include "jobs/job_system.hpp"
 #include "logging/logger.hpp"
+#include "rendering/resolution/dynamic_resolution.hpp"
+#include "rendering/texture/texture_baker.hpp"
+#include "rendering/texture/texture_cache.hpp"
+#include "window/headless_window.hpp"
 #include "window/window.hpp"
 #include "world/world.hpp"
 
-#include <Windows.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
 #include <thread>
 
-int main() {
+// GL time per frame spent uploading decoded textures
+static constexpr double kTextureUploadBudgetMs = 2.0;
+
+struct LaunchOptions {
+    bool headless = false;
+    int width = 800;
+    int height = 600;
+    int frames = 300;
+    int warmup = 10;
+    std::string script;
+    std::string screenshot;
+    std::string bakeTextures;
+    bool packTextures = false;
+};
+
+static LaunchOptions ParseArgs(int argc, char** argv) {
+    LaunchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string("missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        if (!std::strcmp(argv[i], "--headless"))
+            options.headless = true;
+        else if (!std::strcmp(argv[i], "--width"))
+            options.width = std::stoi(next());
+        else if (!std::strcmp(argv[i], "--height"))
+            options.height = std::stoi(next());
+        else if (!std::strcmp(argv[i], "--frames"))
+            options.frames = std::stoi(next());
+        else if (!std::strcmp(argv[i], "--warmup"))
+            options.warmup = std::stoi(next());
+        else if (!std::strcmp(argv[i], "--script"))
+            options.script = next();
+        else if (!std::strcmp(argv[i], "--screenshot"))
+            options.screenshot = next();
+        else if (!std::strcmp(argv[i], "--bake-textures"))
+            options.bakeTextures = next();
+        else if (!std::strcmp(argv[i], "--pack-textures"))
+            options.packTextures = true;
+        else
+            throw std::runtime_error(std::string("unknown argument: ") + argv[i]);
+    }
+    return options;
+}
+
+// Declared right after the window: clears the TextureCache while the context
+// is still current, after everything holding textures is gone.
+struct TextureCacheRelease {
+    ~TextureCacheRelease() { TextureCache::Instance().Clear(); }
+};
+
+static void RunWindowed(const LaunchOptions& options) {
+    Window window{options.width, options.height, "etherion"};
+    // textures cached past this scope would be deleted after the context is gone
+    TextureCacheRelease releaseTextures;
+    Camera camera{};
+    World world{"main_world"};
+    world.SetCamera(camera);
+    // the editor autosaves, headless perf runs don't
+    world.GetAutosave().SetEnabled(true);
+    ImGuiIO *io = &ImGui::GetIO();
+    Console console{&world, io};
+    DynamicResolution resolution;
+    console.SetResolution(&resolution);
+    TextureCache::Instance().QueryFormatSupport();
+
+    if (!options.script.empty())
+        console.ExecuteFile(options.script);
+
+    bool wasLeftDown = false;
+    while (!glfwWindowShouldClose(window.GetGLFWwindow())) {
+        float deltaTime = window.GetDeltaTime();
+
+        window.ProcessInput();
+        window.BeginFrame();
+        GpuProfiler::Instance().BeginFrame();
+        camera.Update(window.GetGLFWwindow(), deltaTime);
+
+        // left click picks whatever is under the cursor, unless ImGui has the mouse
+        bool leftDown = glfwGetMouseButton(window.GetGLFWwindow(), GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        if (leftDown && !wasLeftDown && !io->WantCaptureMouse) {
+            double cursorX = 0.0, cursorY = 0.0;
+            glfwGetCursorPos(window.GetGLFWwindow(), &cursorX, &cursorY);
+            float width = static_cast<float>(window.GetScreenWidth());
+            float height = static_cast<float>(window.GetScreenHeight());
+            float ndcX = 2.0f * static_cast<float>(cursorX) / width - 1.0f;
+            float ndcY = 1.0f - 2.0f * static_cast<float>(cursorY) / height;
+            if (auto picked = world.Pick(ndcX, ndcY, width / height))
+                console.Log("Picked " + std::string(picked->GetName()));
+        }
+        wasLeftDown = leftDown;
+
+        //if (console.WantsInput()) {
+            console.Update(deltaTime);
+        //}
+        console.ExecuteCommands();
+        JobSystem::Instance().RunMainThreadJobs();
+
+        console.Draw();
+        GpuProfiler::Instance().DrawOverlay();
+
+        {
+            GpuProfiler::Zone zone("uploads");
+            TextureCache::Instance().ProcessUploads(kTextureUploadBudgetMs);
+        }
+
+        // pipelined: the next frame is simulated and extracted on a worker
+        // while this one draws what was extracted last frame
+        float aspectRatio = static_cast<float>(window.GetScreenWidth()) / static_cast<float>(window.GetScreenHeight());
+        bool pipelined = world.IsPipelined();
+        if (pipelined)
+            world.BeginFrame(deltaTime, aspectRatio);
+        else
+            world.Update(deltaTime);
+
+        int width = 0, height = 0;
+        window.GetFramebufferSize(width, height);
+        {
+            GpuProfiler::Zone zone("scene");
+            resolution.BeginScene(0, width, height);
+            if (pipelined)
+                world.Render(world.GetFrontSnapshot());
+            else
+                world.DrawAll(aspectRatio);
+            resolution.EndScene();
+        }
+
+        window.EndFrame();
+        GpuProfiler::Instance().EndFrame();
+        if (pipelined)
+            world.EndFrame();
+    }
+}
+
+//
+// Renders a fixed number of frames offscreen and prints timing stats, meant for
+// perf tracking on machines without a display (Mesa llvmpipe works).
+//
+static void RunHeadless(const LaunchOptions& options) {
+    HeadlessWindow window{options.width, options.height};
+    // textures cached past this scope would be deleted after the context is gone
+    TextureCacheRelease releaseTextures;
+    Camera camera{};
+    World world{"main_world"};
+    world.SetCamera(camera);
+    Console console{&world, &ImGui::GetIO()};
+    DynamicResolution resolution;
+    console.SetResolution(&resolution);
+    TextureCache::Instance().QueryFormatSupport();
+
+    if (!options.script.empty())
+        console.ExecuteFile(options.script);
+
+    FrameStats stats;
+    float aspectRatio = static_cast<float>(options.width) / static_cast<float>(options.height);
+    window.GetDeltaTime();
+
+    for (int frame = 0; frame < options.warmup + options.frames; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        float deltaTime = window.GetDeltaTime();
+
+        window.BeginFrame(deltaTime);
+        GpuProfiler::Instance().BeginFrame();
+        console.Update(deltaTime);
+        console.ExecuteCommands();
+        JobSystem::Instance().RunMainThreadJobs();
+        console.Draw();
+        GpuProfiler::Instance().DrawOverlay();
+        {
+            GpuProfiler::Zone zone("uploads");
+            TextureCache::Instance().ProcessUploads(kTextureUploadBudgetMs);
+        }
+        bool pipelined = world.IsPipelined();
+        if (pipelined)
+            world.BeginFrame(deltaTime, aspectRatio);
+        else
+            world.Update(deltaTime);
+        {
+            GpuProfiler::Zone zone("scene");
+            resolution.BeginScene(window.GetFramebuffer(), options.width, options.height);
+            if (pipelined)
+                world.Render(world.GetFrontSnapshot());
+            else
+                world.DrawAll(aspectRatio);
+            resolution.EndScene();
+        }
+        window.EndFrame();
+        GpuProfiler::Instance().EndFrame();
+        if (pipelined)
+            world.EndFrame();
+
+        if (frame >= options.warmup)
+            stats.Add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::cout << "[HEADLESS] renderer: " << window.GetRendererName() << ", " << options.width << "x"
+              << options.height << ", entities: " << world.GetEntityCount() << ", scene scale: "
+              << resolution.GetScale() << (resolution.IsPinned() ? " (pinned)" : "") << std::endl;
+    stats.Report(std::cout, "frame");
+    GpuProfiler::Instance().Report(std::cout);
+
+    if (!options.screenshot.empty())
+        window.SaveFramebuffer(options.screenshot);
+}
+
+int main(int argc, char** argv) {
     CLogger logger;
     logger.Info("program start");
 
+    LaunchOptions options;
     try {
-        Window window{800, 600, "etherion"};
-        Camera camera{};
-        World world{"main_world"};
-        world.SetCamera(camera);
-        ImGuiIO *io = &ImGui::GetIO();
-        Console console{&world, io};
-        while (!glfwWindowShouldClose(window.GetGLFWwindow())) {
-            window.ProcessInput();
-            window.BeginFrame();
-            camera.Update(window.GetGLFWwindow(), window.GetDeltaTime());
-
-            //if (console.WantsInput()) {
-                console.Update(window.GetDeltaTime());
-            //}
-
-            console.Draw();
-
-            world.DrawAll(static_cast<float>(window.GetScreenWidth() / window.GetScreenHeight()));
-            window.EndFrame();
-        }
+        options = ParseArgs(argc, argv);
+        // workers start here, on the main thread, before anything schedules on them
+        JobSystem::Instance();
+        TextureCache::Instance().SetPackingEnabled(options.packTextures);
+        if (!options.bakeTextures.empty())
+            // offline, no context to ask, so bake for a typical desktop GPU
+            TextureBaker::BakeDirectory(options.bakeTextures, BlockCompression::SupportRGTC |
+                                                                  BlockCompression::SupportS3TC |
+                                                                  BlockCompression::SupportBPTC);
+        else if (options.headless)
+            RunHeadless(options);
+        else
+            RunWindowed(options);
     } catch (const std::exception &e) {
         logger.Error(e.what());
-        Sleep(10000);
+        // keep the console open on desktop, automated runs should fail fast
+        if (!options.headless)
+            std::this_thread::sleep_for(std::chrono::seconds(10));
         return -1;
     }
 
     logger.Info("program end");
     return 0;
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 #include "Camera.hpp"
+#include <cmath>
 #include <iostream>
 
 Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
@@ -84,6 +85,11 @@ glm::mat4 Camera::GetProjectionMatrix(float aspectRatio, float fovDeg, float nea
     return glm::perspective(glm::radians(fovDeg), aspectRatio, nearPlane, farPlane);
 }
 
+glm::vec3 Camera::GetRayDirection(float ndcX, float ndcY, float aspectRatio) const {
+    float tanHalfFov = std::tan(glm::radians(zoom_) * 0.5f);
+    return glm::normalize(front_ + right_ * (ndcX * tanHalfFov * aspectRatio) + up_ * (ndcY * tanHalfFov));
+}
+
 void Camera::ProcessKeyboard(CameraMovement direction, float deltaTime) {
     float velocity = speed_ * deltaTime;
 
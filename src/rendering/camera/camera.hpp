@@ -19,6 +19,9 @@ public:
                                   float fovDeg = 45.0f,
                                   float nearPlane = 0.1f,
                                   float farPlane = 100.0f) const;
+    // World space direction (normalized) through a point in NDC, [-1, 1] with
+    // +y up, for a perspective with the current zoom as the vertical fov.
+    glm::vec3 GetRayDirection(float ndcX, float ndcY, float aspectRatio) const;
 
     void ProcessKeyboard(CameraMovement direction, float deltaTime);
     void ProcessMouse(float xOffset, float yOffset, bool constrainPitch = true);
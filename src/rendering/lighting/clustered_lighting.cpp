@@ -0,0 +1,275 @@
+#include "clustered_lighting.hpp"
+#include "../../jobs/job_system.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Tiles along one screen axis touched by the view-space interval [lo, hi]
+// seen between depths dMin and dMax. x / d is monotonic in both, so the
+// extremes are at the corners of that box.
+void TileRange(float lo, float hi, float dMin, float dMax, float tanHalf, int tiles, int& outMin, int& outMax) {
+    float ndc[4] = {lo / dMin, lo / dMax, hi / dMin, hi / dMax};
+    float ndcMin = std::clamp(*std::min_element(ndc, ndc + 4) / tanHalf, -1.0f, 1.0f);
+    float ndcMax = std::clamp(*std::max_element(ndc, ndc + 4) / tanHalf, -1.0f, 1.0f);
+    outMin = std::clamp(static_cast<int>(std::floor((ndcMin + 1.0f) * 0.5f * tiles)), 0, tiles - 1);
+    outMax = std::clamp(static_cast<int>(std::floor((ndcMax + 1.0f) * 0.5f * tiles)), 0, tiles - 1);
+}
+
+} // namespace
+
+const char* const ClusteredLighting::kShaderChunk = R"(
+uniform samplerBuffer uClusterLights;
+uniform usamplerBuffer uClusterGrid;
+uniform usamplerBuffer uClusterIndices;
+uniform ivec3 uClusterDims;
+uniform vec2 uClusterZParams;
+uniform vec2 uClusterTileSize;
+
+int ClusterIndex(vec3 viewPos) {
+    int slice = int(floor(log(-viewPos.z) * uClusterZParams.x - uClusterZParams.y));
+    slice = clamp(slice, 0, uClusterDims.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / uClusterTileSize), ivec2(0), uClusterDims.xy - 1);
+    return tile.x + uClusterDims.x * (tile.y + uClusterDims.y * slice);
+}
+
+vec3 ClusteredPointLights(vec3 viewPos, vec3 viewNormal, vec3 albedo) {
+    uvec2 cell = texelFetch(uClusterGrid, ClusterIndex(viewPos)).xy;
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < cell.y; ++i) {
+        int light = int(texelFetch(uClusterIndices, int(cell.x + i)).x);
+        vec4 posRadius = texelFetch(uClusterLights, light * 2);
+        vec3 color = texelFetch(uClusterLights, light * 2 + 1).rgb;
+        vec3 toLight = posRadius.xyz - viewPos;
+        float dist = length(toLight);
+        float atten = clamp(1.0 - dist / posRadius.w, 0.0, 1.0);
+        float ndotl = max(dot(viewNormal, toLight / max(dist, 1e-4)), 0.0);
+        result += albedo * color * ndotl * atten * atten;
+    }
+    return result;
+}
+)";
+
+ClusteredLighting::~ClusteredLighting() {
+    if (textures_[0]) {
+        glDeleteTextures(3, textures_);
+        glDeleteBuffers(3, buffers_);
+    }
+}
+
+void ClusteredLighting::EnsureBuffers() {
+    if (textures_[0])
+        return;
+
+    glGenBuffers(3, buffers_);
+    glGenTextures(3, textures_);
+
+    const GLenum formats[3] = {GL_RGBA32F, GL_RG32UI, GL_R32UI};
+    for (int i = 0; i < 3; ++i) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers_[i]);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, textures_[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers_[i]);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+//
+// === Cluster Bounds ===
+// View-space AABB of every cluster. Only depends on the projection, so it is
+// rebuilt when fov/aspect/near/far change and reused otherwise.
+//
+void ClusteredLighting::BuildClusterBounds(float fovDeg, float aspectRatio, float nearPlane, float farPlane) {
+    fov_ = fovDeg;
+    aspect_ = aspectRatio;
+    near_ = nearPlane;
+    far_ = farPlane;
+
+    float logRatio = std::log(farPlane / nearPlane);
+    sliceScale_ = static_cast<float>(kClustersZ) / logRatio;
+    sliceBias_ = static_cast<float>(kClustersZ) * std::log(nearPlane) / logRatio;
+
+    float tanY = std::tan(glm::radians(fovDeg) * 0.5f);
+    float tanX = tanY * aspectRatio;
+    tanX_ = tanX;
+    tanY_ = tanY;
+
+    for (int z = 0; z < kClustersZ; ++z) {
+        float dNear = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / kClustersZ);
+        float dFar = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z + 1) / kClustersZ);
+
+        for (int y = 0; y < kClustersY; ++y) {
+            float ndcMinY = -1.0f + 2.0f * static_cast<float>(y) / kClustersY;
+            float ndcMaxY = -1.0f + 2.0f * static_cast<float>(y + 1) / kClustersY;
+
+            for (int x = 0; x < kClustersX; ++x) {
+                float ndcMinX = -1.0f + 2.0f * static_cast<float>(x) / kClustersX;
+                float ndcMaxX = -1.0f + 2.0f * static_cast<float>(x + 1) / kClustersX;
+
+                // the cluster is a frustum slice, its extremes lie on the near or far face
+                float xs[4] = {ndcMinX * tanX * dNear, ndcMinX * tanX * dFar,
+                               ndcMaxX * tanX * dNear, ndcMaxX * tanX * dFar};
+                float ys[4] = {ndcMinY * tanY * dNear, ndcMinY * tanY * dFar,
+                               ndcMaxY * tanY * dNear, ndcMaxY * tanY * dFar};
+
+                ClusterBounds& b = bounds_[x + kClustersX * (y + kClustersY * z)];
+                b.min = glm::vec3(*std::min_element(xs, xs + 4), *std::min_element(ys, ys + 4), -dFar);
+                b.max = glm::vec3(*std::max_element(xs, xs + 4), *std::max_element(ys, ys + 4), -dNear);
+            }
+        }
+    }
+}
+
+int ClusteredLighting::SliceForDepth(float depth) const {
+    int slice = static_cast<int>(std::floor(std::log(std::max(depth, near_)) * sliceScale_ - sliceBias_));
+    return std::clamp(slice, 0, kClustersZ - 1);
+}
+
+//
+// === Assignment ===
+// Each light only visits the clusters inside its tile/slice box. A counting
+// pass sizes every cluster, a second pass writes the indices in place, so the
+// list comes out in cluster order with lights ascending inside each cluster.
+// Each worker owns a contiguous range of depth slices and only touches that
+// part of counts_/cursors_.
+//
+void ClusteredLighting::AssignSlices(int sliceBegin, int sliceEnd, std::vector<uint32_t>& outIndices) {
+    const int first = sliceBegin * kClustersX * kClustersY;
+    const int last = sliceEnd * kClustersX * kClustersY;
+    std::fill(counts_.begin() + first, counts_.begin() + last, 0u);
+
+    auto forEachHit = [&](auto&& visit) {
+        for (const ViewLight& light : viewLights_) {
+            int zBegin = std::max(light.sliceMin, sliceBegin);
+            int zEnd = std::min(light.sliceMax + 1, sliceEnd);
+            for (int z = zBegin; z < zEnd; ++z) {
+                for (int y = light.tileMinY; y <= light.tileMaxY; ++y) {
+                    for (int x = light.tileMinX; x <= light.tileMaxX; ++x) {
+                        int c = x + kClustersX * (y + kClustersY * z);
+                        const ClusterBounds& b = bounds_[c];
+                        glm::vec3 closest = glm::clamp(light.position, b.min, b.max);
+                        glm::vec3 d = closest - light.position;
+                        if (glm::dot(d, d) <= light.radius * light.radius)
+                            visit(c, light.index);
+                    }
+                }
+            }
+        }
+    };
+
+    forEachHit([this](int c, uint32_t) { ++counts_[c]; });
+
+    auto offset = static_cast<uint32_t>(outIndices.size());
+    for (int c = first; c < last; ++c) {
+        cursors_[c] = offset;
+        offset += counts_[c];
+    }
+    outIndices.resize(offset);
+
+    forEachHit([this, &outIndices](int c, uint32_t index) { outIndices[cursors_[c]++] = index; });
+}
+
+void ClusteredLighting::Update(std::span<const Source> lights,
+                               const glm::mat4& view, float fovDeg, float aspectRatio,
+                               float nearPlane, float farPlane) {
+    if (fovDeg != fov_ || aspectRatio != aspect_ || nearPlane != near_ || farPlane != far_)
+        BuildClusterBounds(fovDeg, aspectRatio, nearPlane, farPlane);
+
+    // --- Gather lights in view space, dropping the ones outside the depth range ---
+    viewLights_.clear();
+    gpuLights_.clear();
+    for (const Source& light : lights) {
+        if (light.radius <= 0.0f || light.intensity <= 0.0f)
+            continue;
+
+        glm::vec3 viewPos = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        float depth = -viewPos.z;
+        if (depth + light.radius < nearPlane || depth - light.radius > farPlane)
+            continue;
+
+        auto index = static_cast<uint32_t>(gpuLights_.size() / 2);
+        ViewLight& vl = viewLights_.emplace_back(ViewLight{viewPos, light.radius, index,
+                                                           SliceForDepth(depth - light.radius),
+                                                           SliceForDepth(depth + light.radius)});
+        float dMin = std::max(depth - light.radius, nearPlane);
+        float dMax = std::max(depth + light.radius, nearPlane);
+        TileRange(viewPos.x - light.radius, viewPos.x + light.radius, dMin, dMax, tanX_, kClustersX,
+                  vl.tileMinX, vl.tileMaxX);
+        TileRange(viewPos.y - light.radius, viewPos.y + light.radius, dMin, dMax, tanY_, kClustersY,
+                  vl.tileMinY, vl.tileMaxY);
+        gpuLights_.emplace_back(viewPos, light.radius);
+        gpuLights_.emplace_back(light.color * light.intensity, 1.0f);
+    }
+
+    // --- Assign lights to clusters ---
+    lightIndices_.clear();
+
+    if (viewLights_.size() < kParallelThreshold) {
+        AssignSlices(0, kClustersZ, lightIndices_);
+    } else {
+        // one list per slice keeps the output in slice order however the chunks run
+        for (auto& part : sliceIndices_)
+            part.clear();
+        JobSystem::Instance().ParallelFor(kClustersZ, 1, [this](size_t begin, size_t end) {
+            for (size_t z = begin; z < end; ++z)
+                AssignSlices(static_cast<int>(z), static_cast<int>(z) + 1, sliceIndices_[z]);
+        });
+
+        for (auto& part : sliceIndices_)
+            lightIndices_.insert(lightIndices_.end(), part.begin(), part.end());
+    }
+
+    // --- Grid offsets from the per-cluster counts ---
+    uint32_t offset = 0;
+    maxPerCluster_ = 0;
+    for (int c = 0; c < kClusterCount; ++c) {
+        grid_[c] = glm::uvec2(offset, counts_[c]);
+        offset += counts_[c];
+        maxPerCluster_ = std::max(maxPerCluster_, counts_[c]);
+    }
+    lightCount_ = viewLights_.size();
+    indexCount_ = offset;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    tileSize_ = glm::vec2(static_cast<float>(viewport[2]) / kClustersX,
+                          static_cast<float>(viewport[3]) / kClustersY);
+
+    Upload();
+}
+
+void ClusteredLighting::Upload() {
+    EnsureBuffers();
+
+    // keep the buffers non-empty, zero sized texture buffers are not portable
+    if (gpuLights_.empty())
+        gpuLights_.resize(2, glm::vec4(0.0f));
+    if (lightIndices_.empty())
+        lightIndices_.push_back(0);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers_[0]);
+    glBufferData(GL_TEXTURE_BUFFER, gpuLights_.size() * sizeof(glm::vec4), gpuLights_.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers_[1]);
+    glBufferData(GL_TEXTURE_BUFFER, grid_.size() * sizeof(glm::uvec2), grid_.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers_[2]);
+    glBufferData(GL_TEXTURE_BUFFER, lightIndices_.size() * sizeof(uint32_t), lightIndices_.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // the units are reserved, so the textures stay bound for the whole frame
+    const int units[3] = {kLightsUnit, kGridUnit, kIndicesUnit};
+    for (int i = 0; i < 3; ++i) {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_BUFFER, textures_[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ClusteredLighting::Apply(const Shader& shader) const {
+    shader.SetInt("uClusterLights", kLightsUnit);
+    shader.SetInt("uClusterGrid", kGridUnit);
+    shader.SetInt("uClusterIndices", kIndicesUnit);
+    shader.SetIVec3("uClusterDims", glm::ivec3(kClustersX, kClustersY, kClustersZ));
+    shader.SetVec2("uClusterZParams", glm::vec2(sliceScale_, sliceBias_));
+    shader.SetVec2("uClusterTileSize", tileSize_);
+}
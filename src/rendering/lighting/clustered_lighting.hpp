@@ -0,0 +1,115 @@
+#ifndef CLUSTERED_LIGHTING_HPP
+#define CLUSTERED_LIGHTING_HPP
+
+#include "../shader.hpp"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+//
+// === ClusteredLighting ===
+// Splits the view frustum into a kClustersX * kClustersY * kClustersZ grid
+// (screen tiles * exponential depth slices), assigns point lights to the
+// clusters they touch on the CPU and uploads three buffer textures per frame:
+//
+//   uClusterLights  : RGBA32F, 2 texels per light (view pos + radius, color * intensity)
+//   uClusterGrid    : RG32UI, 1 texel per cluster (offset into index list, count)
+//   uClusterIndices : R32UI, flat light index list
+//
+// Shaders that declare these samplers get them bound automatically by
+// Renderable::Draw; kShaderChunk contains the matching GLSL lookup code.
+//
+class ClusteredLighting {
+  public:
+    static constexpr int kClustersX = 16;
+    static constexpr int kClustersY = 9;
+    static constexpr int kClustersZ = 24;
+    static constexpr int kClusterCount = kClustersX * kClustersY * kClustersZ;
+
+    // Texture units reserved for the light buffers, kept at the top of the
+    // guaranteed range so material samplers can use the low units.
+    static constexpr int kLightsUnit = 13;
+    static constexpr int kGridUnit = 14;
+    static constexpr int kIndicesUnit = 15;
+
+    // Lights below this count are assigned on the calling thread.
+    static constexpr size_t kParallelThreshold = 64;
+
+    // A point light as the world hands it over, already in world space.
+    struct Source {
+        glm::vec3 position;
+        glm::vec3 color;
+        float intensity;
+        float radius;
+    };
+
+    ClusteredLighting() = default;
+    ~ClusteredLighting();
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    // Rebuilds cluster bounds if the projection changed, assigns lights and
+    // uploads the buffers. Must be called on the GL thread once per frame.
+    void Update(std::span<const Source> lights,
+                const glm::mat4& view, float fovDeg, float aspectRatio,
+                float nearPlane, float farPlane);
+
+    // Sets the cluster uniforms on a shader that is already in use. The buffer
+    // textures stay bound to their reserved units from Update() on.
+    void Apply(const Shader& shader) const;
+
+    [[nodiscard]] size_t GetLightCount() const { return lightCount_; }
+    [[nodiscard]] size_t GetIndexCount() const { return indexCount_; }
+    [[nodiscard]] uint32_t GetMaxLightsPerCluster() const { return maxPerCluster_; }
+
+    static const char* const kShaderChunk;
+
+  private:
+    struct ClusterBounds {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    struct ViewLight {
+        glm::vec3 position; // view space
+        float radius;
+        uint32_t index;
+        int sliceMin;
+        int sliceMax;
+        int tileMinX, tileMaxX; // screen tiles covered by the light's bounding box
+        int tileMinY, tileMaxY;
+    };
+
+    void BuildClusterBounds(float fovDeg, float aspectRatio, float nearPlane, float farPlane);
+    void AssignSlices(int sliceBegin, int sliceEnd, std::vector<uint32_t>& outIndices);
+    void Upload();
+    void EnsureBuffers();
+
+    int SliceForDepth(float depth) const;
+
+    std::vector<ClusterBounds> bounds_ = std::vector<ClusterBounds>(kClusterCount);
+    std::vector<ViewLight> viewLights_;
+    std::vector<glm::vec4> gpuLights_;
+    std::vector<glm::uvec2> grid_ = std::vector<glm::uvec2>(kClusterCount);
+    std::vector<uint32_t> lightIndices_;
+    std::vector<uint32_t> counts_ = std::vector<uint32_t>(kClusterCount);  // lights per cluster
+    std::vector<uint32_t> cursors_ = std::vector<uint32_t>(kClusterCount); // write position per cluster
+    std::vector<std::vector<uint32_t>> sliceIndices_ = std::vector<std::vector<uint32_t>>(kClustersZ); // parallel path scratch
+    size_t lightCount_ = 0;
+    size_t indexCount_ = 0;
+    uint32_t maxPerCluster_ = 0;
+    glm::vec2 tileSize_{1.0f};
+
+    // cached projection parameters the bounds were built for
+    float fov_ = 0.0f, aspect_ = 0.0f, near_ = 0.0f, far_ = 0.0f;
+    float sliceScale_ = 0.0f, sliceBias_ = 0.0f;
+    float tanX_ = 0.0f, tanY_ = 0.0f;
+
+    GLuint buffers_[3]{0, 0, 0};
+    GLuint textures_[3]{0, 0, 0};
+};
+
+#endif // CLUSTERED_LIGHTING_HPP
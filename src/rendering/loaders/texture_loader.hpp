@@ -0,0 +1,26 @@
+#ifndef TEXTURE_LOADER_HPP
+#define TEXTURE_LOADER_HPP
+
+#include "../texture/texture_cache.hpp"
+#include <memory>
+#include <string>
+
+namespace TextureLoader {
+
+// Resolves a texture name the way params refer to them ("brick" or
+// "brick.jpg") to a file under assets/textures. Defaults to .png.
+inline std::string ResolvePath(const std::string& name) {
+    std::string path = "assets/textures/" + name;
+    if (name.find('.') == std::string::npos)
+        path += ".png";
+    return path;
+}
+
+// Non-blocking: the texture is Pending until the cache uploads it.
+inline std::shared_ptr<Texture> LoadTexture(const std::string& name) {
+    return TextureCache::Instance().Load(ResolvePath(name));
+}
+
+} // namespace TextureLoader
+
+#endif // TEXTURE_LOADER_HPP
@@ -1,4 +1,5 @@
 #include "Mesh.hpp"
+#include "../loaders/obj_loader.hpp"
 #include <iostream>
 #include <unordered_map>
 
@@ -6,6 +7,14 @@ Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>&
     : vertices_(vertices), indices_(indices), vao_(0), vbo_(0), ebo_(0), initialized_(false) {
     std::cout << "[Mesh] Creating mesh with " << vertices.size()
               << " vertices and " << indices.size() << " indices" << std::endl;
+
+    if (!vertices_.empty()) {
+        boundsMin_ = boundsMax_ = vertices_.front().Position;
+        for (const Vertex& vertex : vertices_) {
+            boundsMin_ = glm::min(boundsMin_, vertex.Position);
+            boundsMax_ = glm::max(boundsMax_, vertex.Position);
+        }
+    }
     SetupMesh();
 }
 
@@ -94,6 +103,38 @@ void Mesh::Draw(const Shader& program) const {
     glBindVertexArray(0);
 }
 
+void Mesh::DrawInstanced(const Shader& program, GLuint instanceBuffer, GLsizei count) const {
+    if (!initialized_ || indices_.empty() || count <= 0)
+        return;
+
+    program.Use();
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+    // mat4 takes four consecutive locations
+    for (GLuint column = 0; column < 4; ++column) {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(offsetof(InstanceData, Model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, TexRect));
+    glVertexAttribDivisor(7, 1);
+
+    glEnableVertexAttribArray(8);
+    glVertexAttribPointer(8, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, TexLayer));
+    glVertexAttribDivisor(8, 1);
+
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, nullptr, count);
+
+    // leave the VAO as SetupMesh built it for non-instanced programs
+    for (GLuint location = 3; location <= 8; ++location)
+        glDisableVertexAttribArray(location);
+    glBindVertexArray(0);
+}
+
 void Mesh::Cleanup() noexcept {
     if (initialized_) {
         std::cout << "[Mesh] Cleaning up OpenGL resources (VAO: " << vao_
@@ -113,6 +154,8 @@ void Mesh::Cleanup() noexcept {
 Mesh::Mesh(Mesh&& other) noexcept
     : vertices_(std::move(other.vertices_)),
       indices_(std::move(other.indices_)),
+      boundsMin_(other.boundsMin_),
+      boundsMax_(other.boundsMax_),
       vao_(other.vao_),
       vbo_(other.vbo_),
       ebo_(other.ebo_),
@@ -133,6 +176,8 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept {
 
         vertices_ = std::move(other.vertices_);
         indices_ = std::move(other.indices_);
+        boundsMin_ = other.boundsMin_;
+        boundsMax_ = other.boundsMax_;
         vao_ = other.vao_;
         vbo_ = other.vbo_;
         ebo_ = other.ebo_;
@@ -15,6 +15,14 @@ struct Vertex {
     glm::vec2 TexCoords;
 };
 
+// Per-instance attributes for Mesh::DrawInstanced, see Shader::IsInstanced.
+struct InstanceData {
+    glm::mat4 Model;
+    glm::vec4 TexRect;
+    float TexLayer;
+    float Padding[3];
+};
+
 class Mesh {
 public:
     Mesh() noexcept;
@@ -28,9 +36,15 @@ public:
     Mesh& operator=(Mesh&& other) noexcept;
 
     void Draw(const Shader& program) const;
+    // Draws `count` instances reading InstanceData from instanceBuffer.
+    void DrawInstanced(const Shader& program, GLuint instanceBuffer, GLsizei count) const;
 
     static std::shared_ptr<Mesh> LoadMesh(const std::string& name);
 
+    // Local space bounding box of the vertices.
+    const glm::vec3& GetBoundsMin() const { return boundsMin_; }
+    const glm::vec3& GetBoundsMax() const { return boundsMax_; }
+
 private:
     void SetupMesh();
     void Cleanup() noexcept;
@@ -38,6 +52,8 @@ private:
 private:
     std::vector<Vertex> vertices_;
     std::vector<unsigned int> indices_;
+    glm::vec3 boundsMin_{0.0f};
+    glm::vec3 boundsMax_{0.0f};
 
     GLuint vao_{0};
     GLuint vbo_{0};
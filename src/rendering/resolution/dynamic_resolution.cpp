@@ -0,0 +1,230 @@
+#include "dynamic_resolution.hpp"
+#include "../../bench/gpu_profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const char* const kUpscaleVertex = R"(#version 330 core
+out vec2 vUv;
+void main() {
+    // one triangle covering the screen
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vUv = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Bilinear fetch of the rendered sub-rectangle plus a 4 tap unsharp mask.
+const char* const kUpscaleFragment = R"(#version 330 core
+in vec2 vUv;
+out vec4 FragColor;
+uniform sampler2D uScene;
+uniform vec2 uUvScale;
+uniform vec2 uTexel;
+uniform float uSharpness;
+void main() {
+    vec2 uvMax = uUvScale - 0.5 * uTexel;
+    vec2 uv = min(vUv * uUvScale, uvMax);
+    vec3 color = texture(uScene, uv).rgb;
+    if (uSharpness > 0.0) {
+        vec3 around = texture(uScene, min(uv + vec2(uTexel.x, 0.0), uvMax)).rgb +
+                      texture(uScene, max(uv - vec2(uTexel.x, 0.0), vec2(0.0))).rgb +
+                      texture(uScene, min(uv + vec2(0.0, uTexel.y), uvMax)).rgb +
+                      texture(uScene, max(uv - vec2(0.0, uTexel.y), vec2(0.0))).rgb;
+        color = clamp(color + uSharpness * (color - around * 0.25), 0.0, 1.0);
+    }
+    FragColor = vec4(color, 1.0);
+}
+)";
+
+GLuint CompileProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vertexSource, nullptr);
+    glCompileShader(vertex);
+    Shader::CheckCompileErrors(vertex, "VERTEX");
+
+    GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fragmentSource, nullptr);
+    glCompileShader(fragment);
+    Shader::CheckCompileErrors(fragment, "FRAGMENT");
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    Shader::CheckCompileErrors(program, "PROGRAM");
+
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return program;
+}
+
+} // namespace
+
+DynamicResolution::DynamicResolution() {
+    glGenVertexArrays(1, &vao_);
+    glGenQueries(kQueryCount, queries_.data());
+    upscale_ = std::make_unique<Shader>(CompileProgram(kUpscaleVertex, kUpscaleFragment));
+}
+
+DynamicResolution::~DynamicResolution() {
+    glDeleteQueries(kQueryCount, queries_.data());
+    glDeleteVertexArrays(1, &vao_);
+    if (fbo_) {
+        glDeleteFramebuffers(1, &fbo_);
+        glDeleteTextures(1, &color_);
+        glDeleteRenderbuffers(1, &depth_);
+    }
+}
+
+void DynamicResolution::PinScale(float scale) {
+    scale_ = std::clamp(scale, kMinScale, kMaxScale);
+    pinned_ = true;
+}
+
+void DynamicResolution::EnsureTarget(int width, int height) {
+    if (fbo_ && width == targetWidth_ && height == targetHeight_)
+        return;
+
+    if (!fbo_) {
+        glGenFramebuffers(1, &fbo_);
+        glGenTextures(1, &color_);
+        glGenRenderbuffers(1, &depth_);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, color_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "[DynamicResolution][WARN] Scene target is incomplete" << std::endl;
+
+    targetWidth_ = width;
+    targetHeight_ = height;
+    std::cout << "[DynamicResolution] Scene target " << width << "x" << height << std::endl;
+}
+
+void DynamicResolution::BeginScene(GLuint output, int width, int height) {
+    output_ = output;
+    outputWidth_ = std::max(1, width);
+    outputHeight_ = std::max(1, height);
+
+    if (!enabled_) {
+        renderWidth_ = outputWidth_;
+        renderHeight_ = outputHeight_;
+        glBindFramebuffer(GL_FRAMEBUFFER, output_);
+        glViewport(0, 0, outputWidth_, outputHeight_);
+        return;
+    }
+
+    EnsureTarget(outputWidth_, outputHeight_);
+    renderWidth_ = std::max(1, static_cast<int>(std::lround(outputWidth_ * scale_)));
+    renderHeight_ = std::max(1, static_cast<int>(std::lround(outputHeight_ * scale_)));
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glViewport(0, 0, renderWidth_, renderHeight_);
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // a slot whose result hasn't come back yet is skipped rather than waited on
+    if (!queryPending_[queryIndex_]) {
+        glBeginQuery(GL_TIME_ELAPSED, queries_[queryIndex_]);
+        queryScale_[queryIndex_] = scale_;
+    }
+}
+
+void DynamicResolution::EndScene() {
+    if (!enabled_)
+        return;
+
+    if (!queryPending_[queryIndex_]) {
+        glEndQuery(GL_TIME_ELAPSED);
+        queryPending_[queryIndex_] = true;
+    }
+    queryIndex_ = (queryIndex_ + 1) % kQueryCount;
+    ReadQueries();
+
+    // --- Upscale into the output at native size ---
+    GpuProfiler::Zone zone("upscale");
+    glBindFramebuffer(GL_FRAMEBUFFER, output_);
+    glViewport(0, 0, outputWidth_, outputHeight_);
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+
+    upscale_->Use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, color_);
+    upscale_->SetSampler2D("uScene", 0);
+    upscale_->SetVec2("uUvScale", glm::vec2(static_cast<float>(renderWidth_) / targetWidth_,
+                                            static_cast<float>(renderHeight_) / targetHeight_));
+    upscale_->SetVec2("uTexel", glm::vec2(1.0f / targetWidth_, 1.0f / targetHeight_));
+    // nothing to sharpen at native scale
+    upscale_->SetFloat("uSharpness", scale_ < kMaxScale ? sharpness_ : 0.0f);
+
+    glBindVertexArray(vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+}
+
+void DynamicResolution::ReadQueries() {
+    for (int i = 0; i < kQueryCount; ++i) {
+        if (!queryPending_[i])
+            continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries_[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries_[i], GL_QUERY_RESULT, &elapsed);
+        queryPending_[i] = false;
+
+        float ms = static_cast<float>(elapsed) / 1.0e6f;
+        gpuMs_ = gpuMs_ > 0.0f ? gpuMs_ * 0.9f + ms * 0.1f : ms;
+        if (queryScale_[i] == scale_)
+            UpdateScale(ms);
+    }
+}
+
+void DynamicResolution::UpdateScale(float sampleMs) {
+    if (pinned_)
+        return;
+
+    if (sampleMs > targetMs_) {
+        underFrames_ = 0;
+        if (++overFrames_ < kLowerAfterFrames || scale_ <= kMinScale)
+            return;
+
+        // cost follows pixel count, i.e. scale squared
+        float wanted = scale_ * std::sqrt(targetMs_ / sampleMs);
+        float stepped = std::floor(wanted / kScaleStep) * kScaleStep;
+        scale_ = std::clamp(std::min(stepped, scale_ - kScaleStep), kMinScale, kMaxScale);
+        overFrames_ = 0;
+    } else if (sampleMs < targetMs_ * kRaiseHeadroom) {
+        overFrames_ = 0;
+        if (++underFrames_ < kRaiseAfterFrames || scale_ >= kMaxScale)
+            return;
+
+        scale_ = std::min(scale_ + kScaleStep, kMaxScale);
+        underFrames_ = 0;
+    } else {
+        overFrames_ = 0;
+        underFrames_ = 0;
+    }
+}
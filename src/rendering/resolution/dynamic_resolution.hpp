@@ -0,0 +1,98 @@
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+#include "../shader.hpp"
+#include <glad/glad.h>
+#include <array>
+#include <memory>
+
+//
+// === DynamicResolution ===
+// Renders the scene into an offscreen target at a fraction of the output size
+// and upscales it (bilinear, optionally sharpened) into the output framebuffer
+// before ImGui draws at native resolution.
+//
+// The scale follows the scene pass GPU time, measured with a ring of
+// GL_TIME_ELAPSED queries that are only read once available, so there is no
+// stall. Going over the target drops the scale after kLowerAfterFrames samples,
+// it only goes back up after kRaiseAfterFrames samples with enough headroom.
+// The target is allocated at full output size; scaling only changes the
+// viewport, so changing the scale never reallocates.
+//
+class DynamicResolution {
+  public:
+    static constexpr float kMinScale = 0.5f;
+    static constexpr float kMaxScale = 1.0f;
+    static constexpr float kScaleStep = 0.05f;
+    static constexpr int kLowerAfterFrames = 3;
+    static constexpr int kRaiseAfterFrames = 30;
+    static constexpr float kRaiseHeadroom = 0.8f; // raise only below this share of the target
+    static constexpr int kQueryCount = 3;
+
+    DynamicResolution();
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Binds the scaled scene target (or `output` directly when disabled).
+    void BeginScene(GLuint output, int width, int height);
+    // Upscales into `output` and feeds the controller with finished queries.
+    void EndScene();
+
+    // ===== Settings =====
+    void SetTargetTime(float ms) { targetMs_ = ms; }
+    [[nodiscard]] float GetTargetTime() const { return targetMs_; }
+
+    void PinScale(float scale);
+    void Unpin() { pinned_ = false; }
+    [[nodiscard]] bool IsPinned() const { return pinned_; }
+
+    void SetEnabled(bool enabled) { enabled_ = enabled; }
+    [[nodiscard]] bool IsEnabled() const { return enabled_; }
+
+    void SetSharpness(float sharpness) { sharpness_ = sharpness; }
+    [[nodiscard]] float GetSharpness() const { return sharpness_; }
+
+    // ===== Getters =====
+    [[nodiscard]] float GetScale() const { return scale_; }
+    [[nodiscard]] int GetRenderWidth() const { return renderWidth_; }
+    [[nodiscard]] int GetRenderHeight() const { return renderHeight_; }
+    [[nodiscard]] float GetGpuTime() const { return gpuMs_; } // smoothed, ms
+
+  private:
+    void EnsureTarget(int width, int height);
+    void ReadQueries();
+    void UpdateScale(float sampleMs);
+
+    bool enabled_ = true;
+    bool pinned_ = false;
+    float targetMs_ = 16.6f;
+    float sharpness_ = 0.2f;
+    float scale_ = 1.0f;
+    float gpuMs_ = 0.0f;
+    int overFrames_ = 0;
+    int underFrames_ = 0;
+
+    GLuint output_ = 0;
+    int outputWidth_ = 0;
+    int outputHeight_ = 0;
+    int renderWidth_ = 0;
+    int renderHeight_ = 0;
+
+    GLuint fbo_ = 0;
+    GLuint color_ = 0;
+    GLuint depth_ = 0;
+    int targetWidth_ = 0;
+    int targetHeight_ = 0;
+
+    GLuint vao_ = 0;
+    std::unique_ptr<Shader> upscale_;
+
+    std::array<GLuint, kQueryCount> queries_{};
+    std::array<bool, kQueryCount> queryPending_{};
+    std::array<float, kQueryCount> queryScale_{}; // samples from an older scale are ignored
+    int queryIndex_ = 0;
+};
+
+#endif // DYNAMIC_RESOLUTION_HPP
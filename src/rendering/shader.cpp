@@ -1,4 +1,6 @@
 #include "Shader.hpp"
+#include <algorithm>
+#include <cstring>
 
 Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
     std::string vertexCode = LoadFile(vertexPath);
@@ -25,92 +27,166 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+    QueryInstancing();
 }
 
 Shader::~Shader() {
     glDeleteProgram(programId);
 }
 
+// ===== Uniform Cache =====
+GLint Shader::Location(const std::string& name) const {
+    auto it = locationCache.find(name);
+    if (it == locationCache.end())
+        it = locationCache.emplace(name, glGetUniformLocation(programId, name.c_str())).first;
+    return it->second;
+}
+
+bool Shader::Changed(GLint location, const void* value, uint32_t size) const {
+    if (location < 0)
+        return false;
+    // locations are small on every driver we know of, don't bet memory on it
+    if (location >= kMaxCachedLocation) {
+        ++uniformWrites;
+        return true;
+    }
+    if (static_cast<size_t>(location) >= valueCache.size())
+        valueCache.resize(static_cast<size_t>(location) + 1);
+    CachedUniform& cached = valueCache[location];
+    if (cached.size == size && std::memcmp(cached.words, value, size) == 0)
+        return false;
+    cached.size = size;
+    std::memcpy(cached.words, value, size);
+    ++uniformWrites;
+    return true;
+}
+
+void Shader::Forget(GLint location, int count) const {
+    ++uniformWrites;
+    for (GLint i = std::max(location, 0); i < location + count && static_cast<size_t>(i) < valueCache.size(); ++i)
+        valueCache[i].size = 0;
+}
+
+void Shader::ResetUniformCache() const {
+    locationCache.clear();
+    valueCache.clear();
+    samplerNames.clear();
+    samplersQueried = false;
+    materialApplied = false;
+}
+
 // ===== Matrix Uniforms =====
 void Shader::SetMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(programId, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    GLint location = Location(name);
+    if (Changed(location, &mat, sizeof(mat)))
+        glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::SetMat3(const std::string& name, const glm::mat3& mat) const {
-    glUniformMatrix3fv(glGetUniformLocation(programId, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    GLint location = Location(name);
+    if (Changed(location, &mat, sizeof(mat)))
+        glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::SetMat2(const std::string& name, const glm::mat2& mat) const {
-    glUniformMatrix2fv(glGetUniformLocation(programId, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    GLint location = Location(name);
+    if (Changed(location, &mat, sizeof(mat)))
+        glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
 }
 
 // ===== Vector Uniforms =====
 void Shader::SetVec4(const std::string& name, const glm::vec4& vec) const {
-    glUniform4f(glGetUniformLocation(programId, name.c_str()), vec.x, vec.y, vec.z, vec.w);
+    GLint location = Location(name);
+    if (Changed(location, &vec, sizeof(vec)))
+        glUniform4f(location, vec.x, vec.y, vec.z, vec.w);
 }
 
 void Shader::SetVec3(const std::string& name, const glm::vec3& vec) const {
-    glUniform3f(glGetUniformLocation(programId, name.c_str()), vec.x, vec.y, vec.z);
+    GLint location = Location(name);
+    if (Changed(location, &vec, sizeof(vec)))
+        glUniform3f(location, vec.x, vec.y, vec.z);
 }
 
 void Shader::SetVec2(const std::string& name, const glm::vec2& vec) const {
-    glUniform2f(glGetUniformLocation(programId, name.c_str()), vec.x, vec.y);
+    GLint location = Location(name);
+    if (Changed(location, &vec, sizeof(vec)))
+        glUniform2f(location, vec.x, vec.y);
 }
 
 // ===== Integer Vector Uniforms =====
 void Shader::SetIVec4(const std::string& name, const glm::ivec4& vec) const {
-    glUniform4i(glGetUniformLocation(programId, name.c_str()), vec.x, vec.y, vec.z, vec.w);
+    GLint location = Location(name);
+    if (Changed(location, &vec, sizeof(vec)))
+        glUniform4i(location, vec.x, vec.y, vec.z, vec.w);
 }
 
 void Shader::SetIVec3(const std::string& name, const glm::ivec3& vec) const {
-    glUniform3i(glGetUniformLocation(programId, name.c_str()), vec.x, vec.y, vec.z);
+    GLint location = Location(name);
+    if (Changed(location, &vec, sizeof(vec)))
+        glUniform3i(location, vec.x, vec.y, vec.z);
 }
 
 void Shader::SetIVec2(const std::string& name, const glm::ivec2& vec) const {
-    glUniform2i(glGetUniformLocation(programId, name.c_str()), vec.x, vec.y);
+    GLint location = Location(name);
+    if (Changed(location, &vec, sizeof(vec)))
+        glUniform2i(location, vec.x, vec.y);
 }
 
 // ===== Scalar Uniforms =====
 void Shader::SetFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(programId, name.c_str()), value);
+    GLint location = Location(name);
+    if (Changed(location, &value, sizeof(value)))
+        glUniform1f(location, value);
 }
 
 void Shader::SetInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(programId, name.c_str()), value);
+    GLint location = Location(name);
+    if (Changed(location, &value, sizeof(value)))
+        glUniform1i(location, value);
 }
 
 void Shader::SetUInt(const std::string& name, unsigned int value) const {
-    glUniform1ui(glGetUniformLocation(programId, name.c_str()), value);
+    GLint location = Location(name);
+    if (Changed(location, &value, sizeof(value)))
+        glUniform1ui(location, value);
 }
 
 void Shader::SetBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(programId, name.c_str()), static_cast<int>(value));
+    SetInt(name, static_cast<int>(value));
 }
 
 // ===== Array Uniforms =====
 void Shader::SetMat4Array(const std::string& name, const glm::mat4* matrices, int count) const {
-    glUniformMatrix4fv(glGetUniformLocation(programId, name.c_str()), count, GL_FALSE, &matrices[0][0][0]);
+    GLint location = Location(name);
+    Forget(location, count);
+    glUniformMatrix4fv(location, count, GL_FALSE, &matrices[0][0][0]);
 }
 
 void Shader::SetVec3Array(const std::string& name, const glm::vec3* vectors, int count) const {
-    glUniform3fv(glGetUniformLocation(programId, name.c_str()), count, &vectors[0][0]);
+    GLint location = Location(name);
+    Forget(location, count);
+    glUniform3fv(location, count, &vectors[0][0]);
 }
 
 void Shader::SetFloatArray(const std::string& name, const float* values, int count) const {
-    glUniform1fv(glGetUniformLocation(programId, name.c_str()), count, values);
+    GLint location = Location(name);
+    Forget(location, count);
+    glUniform1fv(location, count, values);
 }
 
 void Shader::SetIntArray(const std::string& name, const int* values, int count) const {
-    glUniform1iv(glGetUniformLocation(programId, name.c_str()), count, values);
+    GLint location = Location(name);
+    Forget(location, count);
+    glUniform1iv(location, count, values);
 }
 
 // ===== Sampler Uniforms =====
 void Shader::SetSampler2D(const std::string& name, int textureUnit) const {
-    glUniform1i(glGetUniformLocation(programId, name.c_str()), textureUnit);
+    SetInt(name, textureUnit);
 }
 
 void Shader::SetSamplerCube(const std::string& name, int textureUnit) const {
-    glUniform1i(glGetUniformLocation(programId, name.c_str()), textureUnit);
+    SetInt(name, textureUnit);
 }
 
 // ===== File Loader =====
@@ -133,6 +209,7 @@ std::string Shader::LoadFile(const std::string& path) {
 // ===== Reload Shader =====
 void Shader::Reload(const std::string& vertexPath, const std::string& fragmentPath) {
     glDeleteProgram(programId); // delete old program
+    ResetUniformCache();
 
     std::string vertexCode = LoadFile(vertexPath);
     std::string fragmentCode = LoadFile(fragmentPath);
@@ -158,6 +235,7 @@ void Shader::Reload(const std::string& vertexPath, const std::string& fragmentPa
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+    QueryInstancing();
 
     std::cout << "[Shader] Reloaded shader program (ID: " << programId << ")" << std::endl;
 }
@@ -259,6 +337,7 @@ std::unordered_map<std::string, Shader::UniformValue> Shader::GetActiveUniformVa
         }
 
         case GL_SAMPLER_2D:
+        case GL_SAMPLER_2D_ARRAY:
         case GL_SAMPLER_CUBE: {
             GLint v;
             glGetUniformiv(programId, location, &v);
@@ -273,3 +352,38 @@ std::unordered_map<std::string, Shader::UniformValue> Shader::GetActiveUniformVa
 
     return result;
 }
+
+const std::vector<std::string>& Shader::GetSamplerUniforms() const {
+    if (samplersQueried)
+        return samplerNames;
+    samplersQueried = true;
+    std::vector<std::string>& result = samplerNames;
+
+    GLint uniformCount = 0;
+    glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+    GLint maxNameLength = 0;
+    glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameData(maxNameLength);
+
+    for (GLint i = 0; i < uniformCount; i++) {
+        GLsizei nameLength = 0;
+        GLint size = 0;
+        GLenum type = 0;
+
+        glGetActiveUniform(programId, i, maxNameLength, &nameLength, &size, &type, nameData.data());
+        if (type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_ARRAY)
+            result.emplace_back(nameData.data(), nameLength);
+    }
+
+    return result;
+}
+
+bool Shader::HasSampler(std::string_view name) const {
+    for (const std::string& sampler : GetSamplerUniforms()) {
+        if (sampler == name)
+            return true;
+    }
+    return false;
+}
\ No newline at end of file
@@ -5,17 +5,19 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 class Shader {
 public:
     // ===== Constructors =====
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
-    Shader(GLuint programId) : programId(programId) {}
+    Shader(GLuint programId) : programId(programId) { QueryInstancing(); }
     ~Shader();
 
     // ===== Usage =====
@@ -56,13 +58,63 @@ public:
     // ===== Uniform Inspector =====
     using UniformValue = std::variant<int, float, bool, glm::vec2, glm::vec3, glm::vec4, glm::mat4, std::string>;
     std::unordered_map<std::string, UniformValue> GetActiveUniformValues() const;
+    // Queried once per program.
+    const std::vector<std::string>& GetSamplerUniforms() const;
+    bool HasSampler(std::string_view name) const;
+
+    // Programs declaring the per-instance attributes (mat4 iModel at location 3,
+    // vec4 iTexRect at 7, float iTexLayer at 8) are drawn in instanced batches.
+    bool IsInstanced() const { return instanced; }
+
+    // ===== Redundant Uniform Filtering =====
+    // The scalar, vector and matrix setters remember the last value written to
+    // each location and skip the glUniform call when it is the same; locations
+    // are looked up by name once. Bumped by every call actually made.
+    uint64_t GetUniformWrites() const { return uniformWrites; }
+    // Renderable::Apply skips its param uniforms when this material (its
+    // GetMaterialHash) was the last one pushed and nothing was written since.
+    bool IsMaterialCurrent(uint64_t material) const {
+        return materialApplied && appliedMaterial == material && appliedWrites == uniformWrites;
+    }
+    void MarkMaterialApplied(uint64_t material) const {
+        materialApplied = true;
+        appliedMaterial = material;
+        appliedWrites = uniformWrites;
+    }
 
     // ===== Getters & Setters =====
     GLuint GetProgramId() const { return programId; }
-    void SetProgramId(GLuint id) { programId = id; }
+    void SetProgramId(GLuint id) {
+        programId = id;
+        ResetUniformCache();
+    }
 
 private:
+    static constexpr GLint kMaxCachedLocation = 4096;
+
+    struct CachedUniform {
+        uint32_t size = 0; // bytes, 0 when unknown
+        uint32_t words[16];
+    };
+
+    void QueryInstancing() { instanced = glGetAttribLocation(programId, "iModel") >= 0; }
+    GLint Location(const std::string& name) const;
+    // Records the value, false when the location already holds it.
+    bool Changed(GLint location, const void* value, uint32_t size) const;
+    // Array setters write count locations from location on.
+    void Forget(GLint location, int count) const;
+    void ResetUniformCache() const;
+
     GLuint programId;
+    bool instanced = false;
+    mutable std::unordered_map<std::string, GLint> locationCache;
+    mutable std::vector<CachedUniform> valueCache; // by location
+    mutable uint64_t uniformWrites = 0;
+    mutable bool materialApplied = false;
+    mutable uint64_t appliedMaterial = 0;
+    mutable uint64_t appliedWrites = 0;
+    mutable std::vector<std::string> samplerNames;
+    mutable bool samplersQueried = false;
 };
 
 #endif // SHADER_HPP
@@ -0,0 +1,394 @@
+#include "block_compression.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace BlockCompression {
+
+namespace {
+
+using Block = uint8_t[16][4]; // 4x4 texels, RGBA
+
+// Gathers a 4x4 block as RGBA, clamping at the image edge. Missing channels
+// become 0 (green/blue) or 255 (alpha).
+void FetchBlock(const unsigned char* pixels, int width, int height, int channels, int bx, int by, Block& out) {
+    for (int y = 0; y < 4; ++y) {
+        int py = std::min(by * 4 + y, height - 1);
+        for (int x = 0; x < 4; ++x) {
+            int px = std::min(bx * 4 + x, width - 1);
+            const unsigned char* src = pixels + (static_cast<size_t>(py) * width + px) * channels;
+            uint8_t* dst = out[y * 4 + x];
+            dst[0] = src[0];
+            dst[1] = channels > 1 ? src[1] : 0;
+            dst[2] = channels > 2 ? src[2] : 0;
+            dst[3] = channels > 3 ? src[3] : 255;
+        }
+    }
+}
+
+// Principal axis of the block colors (first `dims` channels) by power
+// iteration, then the two texels furthest apart along it.
+void FindEndpoints(const Block& block, int dims, float e0[4], float e1[4]) {
+    float mean[4] = {0, 0, 0, 0};
+    for (const auto& texel : block)
+        for (int c = 0; c < dims; ++c)
+            mean[c] += texel[c] / 16.0f;
+
+    float cov[4][4] = {};
+    for (const auto& texel : block) {
+        float d[4];
+        for (int c = 0; c < dims; ++c)
+            d[c] = texel[c] - mean[c];
+        for (int i = 0; i < dims; ++i)
+            for (int j = 0; j < dims; ++j)
+                cov[i][j] += d[i] * d[j];
+    }
+
+    float axis[4] = {1, 1, 1, 1};
+    for (int iter = 0; iter < 8; ++iter) {
+        float next[4] = {0, 0, 0, 0};
+        for (int i = 0; i < dims; ++i)
+            for (int j = 0; j < dims; ++j)
+                next[i] += cov[i][j] * axis[j];
+
+        float len = 0.0f;
+        for (int c = 0; c < dims; ++c)
+            len = std::max(len, std::fabs(next[c]));
+        if (len < 1e-6f)
+            break;
+        for (int c = 0; c < dims; ++c)
+            axis[c] = next[c] / len;
+    }
+
+    float minT = 1e30f, maxT = -1e30f;
+    int minI = 0, maxI = 0;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < dims; ++c)
+            t += (block[i][c] - mean[c]) * axis[c];
+        if (t < minT) { minT = t; minI = i; }
+        if (t > maxT) { maxT = t; maxI = i; }
+    }
+
+    for (int c = 0; c < 4; ++c) {
+        e0[c] = block[maxI][c];
+        e1[c] = block[minI][c];
+    }
+}
+
+int ColorDistance(const uint8_t* a, const int* b, int dims) {
+    int sum = 0;
+    for (int c = 0; c < dims; ++c) {
+        int d = a[c] - b[c];
+        sum += d * d;
+    }
+    return sum;
+}
+
+void WriteLE(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i)
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+//
+// --- BC1: two RGB565 endpoints + 2-bit indices ---
+//
+uint16_t To565(const float c[4]) {
+    auto r = static_cast<uint16_t>(std::clamp(std::lround(c[0] * 31.0f / 255.0f), 0L, 31L));
+    auto g = static_cast<uint16_t>(std::clamp(std::lround(c[1] * 63.0f / 255.0f), 0L, 63L));
+    auto b = static_cast<uint16_t>(std::clamp(std::lround(c[2] * 31.0f / 255.0f), 0L, 31L));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void From565(uint16_t v, int out[4]) {
+    int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+    out[3] = 255;
+}
+
+void EncodeBC1(const Block& block, uint8_t out[8]) {
+    float e0[4], e1[4];
+    FindEndpoints(block, 3, e0, e1);
+
+    // inset the endpoints a little, extremes are usually outliers
+    for (int c = 0; c < 3; ++c) {
+        float inset = (e0[c] - e1[c]) / 16.0f;
+        e0[c] -= inset;
+        e1[c] += inset;
+    }
+
+    uint16_t c0 = To565(e0), c1 = To565(e1);
+    if (c0 < c1)
+        std::swap(c0, c1);
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][4];
+        From565(c0, palette[0]);
+        From565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDist = ColorDistance(block[i], palette[0], 3);
+            for (int p = 1; p < 4; ++p) {
+                int dist = ColorDistance(block[i], palette[p], 3);
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+        }
+    }
+
+    WriteLE(out, c0, 2);
+    WriteLE(out + 2, c1, 2);
+    WriteLE(out + 4, indices, 4);
+}
+
+//
+// --- BC4: one channel, two 8-bit endpoints + 3-bit indices ---
+//
+void EncodeBC4(const Block& block, int channel, uint8_t out[8]) {
+    uint8_t lo = 255, hi = 0;
+    for (const auto& texel : block) {
+        lo = std::min(lo, texel[channel]);
+        hi = std::max(hi, texel[channel]);
+    }
+
+    out[0] = hi;
+    out[1] = lo;
+
+    uint64_t indices = 0;
+    if (hi != lo) {
+        int palette[8] = {hi, lo};
+        for (int i = 1; i < 7; ++i)
+            palette[i + 1] = ((7 - i) * hi + i * lo + 3) / 7;
+
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDist = 256;
+            for (int p = 0; p < 8; ++p) {
+                int dist = std::abs(block[i][channel] - palette[p]);
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+
+    WriteLE(out + 2, indices, 6);
+}
+
+//
+// --- BC7 mode 6: RGBA 7.7.7.7 endpoints with a p-bit each, 4-bit indices ---
+//
+struct BitWriter {
+    uint8_t* out;
+    int pos = 0;
+
+    void Write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; ++i, ++pos) {
+            if (value & (1u << i))
+                out[pos >> 3] |= static_cast<uint8_t>(1u << (pos & 7));
+        }
+    }
+};
+
+void QuantizeBC7Endpoint(const float e[4], int q[4], int& pbit) {
+    int bestError = 1 << 30;
+    for (int p = 0; p < 2; ++p) {
+        int candidate[4], error = 0;
+        for (int c = 0; c < 4; ++c) {
+            candidate[c] = std::clamp(static_cast<int>(std::lround((e[c] - p) / 2.0f)), 0, 127);
+            int d = ((candidate[c] << 1) | p) - static_cast<int>(e[c]);
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            pbit = p;
+            std::copy(candidate, candidate + 4, q);
+        }
+    }
+}
+
+void EncodeBC7Mode6(const Block& block, uint8_t out[16]) {
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    float e0[4], e1[4];
+    FindEndpoints(block, 4, e0, e1);
+
+    int q0[4], q1[4], p0 = 0, p1 = 0;
+    QuantizeBC7Endpoint(e0, q0, p0);
+    QuantizeBC7Endpoint(e1, q1, p1);
+
+    int palette[16][4];
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            int a = (q0[c] << 1) | p0, b = (q1[c] << 1) | p1;
+            palette[i][c] = ((64 - weights[i]) * a + weights[i] * b + 32) >> 6;
+        }
+    }
+
+    int indices[16];
+    for (int i = 0; i < 16; ++i) {
+        int best = 0, bestDist = ColorDistance(block[i], palette[0], 4);
+        for (int p = 1; p < 16; ++p) {
+            int dist = ColorDistance(block[i], palette[p], 4);
+            if (dist < bestDist) {
+                bestDist = dist;
+                best = p;
+            }
+        }
+        indices[i] = best;
+    }
+
+    // the anchor index is stored with an implicit 0 MSB, flip the block if needed
+    if (indices[0] & 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (int& index : indices)
+            index = 15 - index;
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer{out};
+    writer.Write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        writer.Write(static_cast<uint32_t>(q0[c]), 7);
+        writer.Write(static_cast<uint32_t>(q1[c]), 7);
+    }
+    writer.Write(static_cast<uint32_t>(p0), 1);
+    writer.Write(static_cast<uint32_t>(p1), 1);
+    writer.Write(static_cast<uint32_t>(indices[0]), 3);
+    for (int i = 1; i < 16; ++i)
+        writer.Write(static_cast<uint32_t>(indices[i]), 4);
+}
+
+bool HasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (ext && std::strcmp(ext, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+uint32_t QuerySupport() {
+    uint32_t support = SupportRGTC;
+    if (HasExtension("GL_EXT_texture_compression_s3tc"))
+        support |= SupportS3TC;
+    if (GLAD_GL_VERSION_4_2 || HasExtension("GL_ARB_texture_compression_bptc"))
+        support |= SupportBPTC;
+    return support;
+}
+
+Format ChooseFormat(int channels, uint32_t support) {
+    switch (channels) {
+    case 1:
+        return Format::BC4;
+    case 2:
+        return Format::BC5;
+    case 3:
+        if (support & SupportS3TC)
+            return Format::BC1;
+        return (support & SupportBPTC) ? Format::BC7 : Format::None;
+    case 4:
+        if (support & SupportBPTC)
+            return Format::BC7;
+        return (support & SupportS3TC) ? Format::BC3 : Format::None;
+    default:
+        return Format::None;
+    }
+}
+
+size_t BlockBytes(Format format) {
+    switch (format) {
+    case Format::BC1:
+    case Format::BC4:
+        return 8;
+    case Format::BC3:
+    case Format::BC5:
+    case Format::BC7:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+size_t CompressedSize(Format format, int width, int height) {
+    size_t blocks = static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4);
+    return blocks * BlockBytes(format);
+}
+
+GLenum ToGLFormat(Format format) {
+    switch (format) {
+    case Format::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case Format::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case Format::BC4: return GL_COMPRESSED_RED_RGTC1;
+    case Format::BC5: return GL_COMPRESSED_RG_RGTC2;
+    case Format::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default: return 0;
+    }
+}
+
+const char* FormatName(Format format) {
+    switch (format) {
+    case Format::BC1: return "BC1";
+    case Format::BC3: return "BC3";
+    case Format::BC4: return "BC4";
+    case Format::BC5: return "BC5";
+    case Format::BC7: return "BC7";
+    default: return "raw";
+    }
+}
+
+std::vector<unsigned char> Compress(Format format, const unsigned char* pixels, int width, int height, int channels) {
+    std::vector<unsigned char> out(CompressedSize(format, width, height));
+    const size_t blockBytes = BlockBytes(format);
+    const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+
+    Block block;
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            FetchBlock(pixels, width, height, channels, bx, by, block);
+            uint8_t* dst = out.data() + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+
+            switch (format) {
+            case Format::BC1:
+                EncodeBC1(block, dst);
+                break;
+            case Format::BC3:
+                EncodeBC4(block, 3, dst);
+                EncodeBC1(block, dst + 8);
+                break;
+            case Format::BC4:
+                EncodeBC4(block, 0, dst);
+                break;
+            case Format::BC5:
+                EncodeBC4(block, 0, dst);
+                EncodeBC4(block, 1, dst + 8);
+                break;
+            case Format::BC7:
+                EncodeBC7Mode6(block, dst);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    return out;
+}
+
+} // namespace BlockCompression
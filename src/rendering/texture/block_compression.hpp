@@ -0,0 +1,51 @@
+#ifndef BLOCK_COMPRESSION_HPP
+#define BLOCK_COMPRESSION_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// S3TC enums are not part of the core profile glad was generated for
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+//
+// === BlockCompression ===
+// Small CPU encoders for the 4x4 block formats the texture baker emits:
+//   BC1 (RGB, 4 bpp), BC3 (RGBA, 8 bpp), BC4 (R, 4 bpp), BC5 (RG, 8 bpp)
+//   BC7 (RGBA, 8 bpp, mode 6 only: single subset, 4-bit indices)
+// They favour speed and simplicity over the last bit of quality.
+//
+namespace BlockCompression {
+
+enum class Format : uint32_t { None = 0, BC1 = 1, BC3 = 3, BC4 = 4, BC5 = 5, BC7 = 7 };
+
+enum FormatSupport : uint32_t {
+    SupportRGTC = 1 << 0, // BC4/BC5, core since GL 3.0
+    SupportS3TC = 1 << 1, // BC1/BC3, EXT_texture_compression_s3tc
+    SupportBPTC = 1 << 2, // BC7, ARB_texture_compression_bptc / GL 4.2
+};
+
+// GL thread only: queries which of the formats above the context can sample.
+uint32_t QuerySupport();
+
+// Picks the best supported format for an image with the given channel count,
+// or Format::None if it should stay uncompressed.
+Format ChooseFormat(int channels, uint32_t support);
+
+size_t BlockBytes(Format format);
+size_t CompressedSize(Format format, int width, int height);
+GLenum ToGLFormat(Format format);
+const char* FormatName(Format format);
+
+// Compresses one mip level. pixels is tightly packed with `channels` bytes per texel.
+std::vector<unsigned char> Compress(Format format, const unsigned char* pixels, int width, int height, int channels);
+
+} // namespace BlockCompression
+
+#endif // BLOCK_COMPRESSION_HPP
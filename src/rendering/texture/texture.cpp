@@ -0,0 +1,138 @@
+#include "texture.hpp"
+#include <algorithm>
+#include <iostream>
+
+Texture::Texture(std::string path, bool packed) : path_(std::move(path)), packed_(packed) {}
+
+Texture::~Texture() {
+    if (id_)
+        glDeleteTextures(1, &id_);
+}
+
+GLuint Texture::GetFallback() {
+    static GLuint fallback = 0;
+    if (!fallback) {
+        const unsigned char white[4] = {255, 255, 255, 255};
+        glGenTextures(1, &fallback);
+        glBindTexture(GL_TEXTURE_2D, fallback);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    return fallback;
+}
+
+GLuint Texture::GetFallbackArray() {
+    static GLuint fallback = 0;
+    if (!fallback) {
+        const unsigned char white[4] = {255, 255, 255, 255};
+        glGenTextures(1, &fallback);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, fallback);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    return fallback;
+}
+
+void Texture::Bind(int unit) const {
+    if (packed_) {
+        if (const TextureArray* array = GetArray()) {
+            array->Bind(unit);
+        } else {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, GetFallbackArray());
+        }
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, IsReady() ? id_ : GetFallback());
+}
+
+void Texture::SetPacked(TextureRef ref, const DecodedImage& image) {
+    ref_ = std::move(ref);
+    width_ = image.width;
+    height_ = image.height;
+    format_ = image.format;
+    byteSize_ = 0;
+    rgba8Size_ = 0;
+
+    int w = image.width, h = image.height;
+    for (size_t level = 0; level < image.LevelCount(); ++level) {
+        byteSize_ += image.Level(level).second;
+        rgba8Size_ += static_cast<size_t>(w) * h * 4;
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    state_ = TextureState::Ready;
+
+    std::cout << "[Texture] Packed " << path_ << " (" << width_ << "x" << height_ << ", "
+              << BlockCompression::FormatName(format_) << ") into layer " << ref_.layer << " of array "
+              << ref_.array->GetId() << std::endl;
+}
+
+void Texture::Upload(const DecodedImage& image, bool generateMipsOnGpu) {
+    static const GLenum formats[4] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    static const GLint internalFormats[4] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+
+    if (!image.IsValid() || image.channels < 1 || image.channels > 4) {
+        MarkFailed();
+        return;
+    }
+
+    GLenum format = formats[image.channels - 1];
+    GLint internalFormat = internalFormats[image.channels - 1];
+    GLenum compressedFormat = BlockCompression::ToGLFormat(image.format);
+
+    if (!id_)
+        glGenTextures(1, &id_);
+    glBindTexture(GL_TEXTURE_2D, id_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    width_ = image.width;
+    height_ = image.height;
+    format_ = image.format;
+    byteSize_ = 0;
+    rgba8Size_ = 0;
+
+    int w = image.width, h = image.height;
+    for (size_t level = 0; level < image.LevelCount(); ++level) {
+        auto [data, size] = image.Level(level);
+        if (compressedFormat)
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), compressedFormat, w, h, 0,
+                                   static_cast<GLsizei>(size), data);
+        else
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat, w, h, 0, format,
+                         GL_UNSIGNED_BYTE, data);
+
+        byteSize_ += size;
+        rgba8Size_ += static_cast<size_t>(w) * h * 4;
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    bool hasMips = image.LevelCount() > 1;
+    if (!hasMips && generateMipsOnGpu && !compressedFormat) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        byteSize_ += byteSize_ / 3;
+        rgba8Size_ += rgba8Size_ / 3;
+        hasMips = true;
+    } else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.LevelCount()) - 1);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, hasMips ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    state_ = TextureState::Ready;
+
+    std::cout << "[Texture] Uploaded " << path_ << " (" << width_ << "x" << height_ << ", "
+              << BlockCompression::FormatName(format_) << ", " << (hasMips ? "mipped" : "no mips")
+              << ") VRAM " << byteSize_ / 1024 << " KB, saved " << (rgba8Size_ - std::min(rgba8Size_, byteSize_)) / 1024
+              << " KB vs RGBA8" << std::endl;
+}
@@ -0,0 +1,97 @@
+#ifndef TEXTURE_HPP
+#define TEXTURE_HPP
+
+#include "../../io/mapped_file.hpp"
+#include "block_compression.hpp"
+#include "texture_array.hpp"
+#include <glad/glad.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class TextureState { Pending, Ready, Failed };
+
+//
+// === DecodedImage ===
+// CPU side result of decoding an image file. Level 0 is the full image,
+// further entries are the mip chain if it was generated on the worker.
+// Block compressed images either own their levels or point into a mapped
+// baked file, which `mapping` keeps alive until the upload.
+//
+struct DecodedImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    BlockCompression::Format format = BlockCompression::Format::None;
+    std::vector<std::vector<unsigned char>> levels;
+
+    std::shared_ptr<MappedFile> mapping;
+    std::vector<std::pair<const unsigned char*, size_t>> mappedLevels;
+
+    [[nodiscard]] size_t LevelCount() const { return mapping ? mappedLevels.size() : levels.size(); }
+    [[nodiscard]] std::pair<const unsigned char*, size_t> Level(size_t i) const {
+        if (mapping)
+            return mappedLevels[i];
+        return {levels[i].data(), levels[i].size()};
+    }
+    [[nodiscard]] bool IsValid() const { return width > 0 && height > 0 && LevelCount() > 0; }
+};
+
+//
+// === Texture ===
+// A 2D texture asset. Created in the Pending state by the TextureCache and
+// filled in on the GL thread once its image has been decoded. Binding a texture
+// that is not ready yet binds a 1x1 white fallback, so draws never stall.
+// Packed textures live in a layer (or atlas rect) of a shared TextureArray and
+// must be sampled through a sampler2DArray.
+//
+class Texture {
+public:
+    explicit Texture(std::string path, bool packed = false);
+    ~Texture();
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    void Bind(int unit) const;
+
+    // GL thread only
+    void Upload(const DecodedImage& image, bool generateMipsOnGpu);
+    void SetPacked(TextureRef ref, const DecodedImage& image);
+    void MarkFailed() { state_ = TextureState::Failed; }
+
+    // ===== Getters =====
+    [[nodiscard]] TextureState GetState() const { return state_; }
+    [[nodiscard]] bool IsReady() const { return state_ == TextureState::Ready; }
+    [[nodiscard]] const std::string& GetPath() const { return path_; }
+    [[nodiscard]] GLuint GetId() const { return id_; }
+    [[nodiscard]] int GetWidth() const { return width_; }
+    [[nodiscard]] int GetHeight() const { return height_; }
+    [[nodiscard]] size_t GetByteSize() const { return byteSize_; }
+    [[nodiscard]] size_t GetRgba8Size() const { return rgba8Size_; } // same mip chain as RGBA8
+    [[nodiscard]] BlockCompression::Format GetFormat() const { return format_; }
+
+    [[nodiscard]] bool IsPacked() const { return packed_; }
+    [[nodiscard]] const TextureArray* GetArray() const { return IsReady() ? ref_.array.get() : nullptr; }
+    [[nodiscard]] int GetLayer() const { return IsReady() ? ref_.layer : 0; }
+    [[nodiscard]] glm::vec4 GetRect() const { return IsReady() ? ref_.rect : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); }
+
+    static GLuint GetFallback();
+    static GLuint GetFallbackArray();
+
+private:
+    std::string path_;
+    bool packed_ = false;
+    TextureRef ref_;
+    GLuint id_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+    size_t byteSize_ = 0;
+    size_t rgba8Size_ = 0;
+    BlockCompression::Format format_ = BlockCompression::Format::None;
+    std::atomic<TextureState> state_{TextureState::Pending};
+};
+
+#endif // TEXTURE_HPP
@@ -0,0 +1,294 @@
+#include "texture_array.hpp"
+#include "texture.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+const GLenum kFormats[4] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+const GLint kInternalFormats[4] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+
+int RoundUp(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+TextureArray::TextureArray(BlockCompression::Format format, int channels, int width, int height, int levels, int capacity,
+                           int maxCapacity)
+    : format_(format), channels_(channels), width_(width), height_(height), levels_(levels),
+      capacity_(std::min(capacity, maxCapacity)), maxCapacity_(maxCapacity) {
+    id_ = CreateStorage(capacity_);
+
+    std::cout << "[TextureArray] Created " << width_ << "x" << height_ << "x" << capacity_ << " "
+              << BlockCompression::FormatName(format_) << " array (" << levels_ << " levels, "
+              << byteSize_ / 1024 << " KB, up to " << maxCapacity_ << " layers)" << std::endl;
+}
+
+GLuint TextureArray::CreateStorage(int capacity) {
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+    byteSize_ = 0;
+    GLenum compressed = BlockCompression::ToGLFormat(format_);
+    int w = width_, h = height_;
+    for (int level = 0; level < levels_; ++level) {
+        if (compressed) {
+            size_t size = BlockCompression::CompressedSize(format_, w, h) * capacity;
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, compressed, w, h, capacity, 0,
+                                   static_cast<GLsizei>(size), nullptr);
+            byteSize_ += size;
+        } else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, kInternalFormats[channels_ - 1], w, h, capacity, 0,
+                         kFormats[channels_ - 1], GL_UNSIGNED_BYTE, nullptr);
+            byteSize_ += static_cast<size_t>(w) * h * channels_ * capacity;
+        }
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels_ - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, levels_ > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return id;
+}
+
+int TextureArray::AllocateLayer() {
+    if (usedLayers_ == capacity_) {
+        if (capacity_ >= maxCapacity_)
+            return -1;
+        Grow(std::min(capacity_ * 2, maxCapacity_));
+    }
+    return usedLayers_++;
+}
+
+//
+// Copies the used layers into new storage level by level: straight on the
+// GPU with GL 4.3, otherwise through a pixel buffer that never leaves it.
+//
+void TextureArray::Grow(int capacity) {
+    GLuint id = CreateStorage(capacity);
+    GLenum compressed = BlockCompression::ToGLFormat(format_);
+    GLuint buffer = 0;
+    if (!GLAD_GL_VERSION_4_3) {
+        glGenBuffers(1, &buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+
+    int w = width_, h = height_;
+    for (int level = 0; level < levels_; ++level) {
+        if (GLAD_GL_VERSION_4_3) {
+            glCopyImageSubData(id_, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, id, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, w, h,
+                               usedLayers_);
+        } else {
+            // whole level of the old storage, every layer of which is in use
+            size_t layerSize = compressed ? BlockCompression::CompressedSize(format_, w, h)
+                                          : static_cast<size_t>(w) * h * channels_;
+            auto size = static_cast<GLsizei>(layerSize * capacity_);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_COPY);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, id_);
+            if (compressed)
+                glGetCompressedTexImage(GL_TEXTURE_2D_ARRAY, level, nullptr);
+            else
+                glGetTexImage(GL_TEXTURE_2D_ARRAY, level, kFormats[channels_ - 1], GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+            if (compressed)
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, w, h, usedLayers_, compressed, size,
+                                          nullptr);
+            else
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, w, h, usedLayers_, kFormats[channels_ - 1],
+                                GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    if (buffer) {
+        glDeleteBuffers(1, &buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    glDeleteTextures(1, &id_);
+    id_ = id;
+    capacity_ = capacity;
+}
+
+TextureArray::~TextureArray() {
+    if (id_)
+        glDeleteTextures(1, &id_);
+}
+
+void TextureArray::Bind(int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id_);
+}
+
+void TextureArray::UploadRegion(int layer, int level, int x, int y, int width, int height,
+                                const unsigned char* data, size_t size) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (GLenum compressed = BlockCompression::ToGLFormat(format_))
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, x, y, layer, width, height, 1, compressed,
+                                  static_cast<GLsizei>(size), data);
+    else
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, x, y, layer, width, height, 1, kFormats[channels_ - 1],
+                        GL_UNSIGNED_BYTE, data);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+//
+// === TexturePacker ===
+//
+std::optional<TextureRef> TexturePacker::Insert(const DecodedImage& image) {
+    if (!image.IsValid() || image.channels < 1 || image.channels > 4)
+        return std::nullopt;
+
+    if (image.width <= kAtlasMaxEntry && image.height <= kAtlasMaxEntry &&
+        static_cast<int>(image.LevelCount()) >= kAtlasLevels)
+        return InsertAtlas(image);
+
+    return InsertLayer(image);
+}
+
+std::optional<TextureRef> TexturePacker::InsertLayer(const DecodedImage& image) {
+    const int levels = static_cast<int>(image.LevelCount());
+    BucketKey key{static_cast<uint32_t>(image.format), image.channels, image.width, image.height, levels};
+    auto& arrays = buckets_[key];
+
+    int layer = arrays.empty() ? -1 : arrays.back()->AllocateLayer();
+    if (layer < 0) {
+        // cap arrays by what one layer costs; they start small and grow
+        size_t layerBytes = 0;
+        for (int level = 0; level < levels; ++level)
+            layerBytes += image.Level(level).second;
+        int maxCapacity = static_cast<int>(std::clamp<size_t>(kArrayBudgetBytes / std::max<size_t>(layerBytes, 1), 2,
+                                                              kArrayCapacity));
+        arrays.push_back(std::make_shared<TextureArray>(image.format, image.channels, image.width, image.height,
+                                                        levels, kArrayInitialCapacity, maxCapacity));
+        layer = arrays.back()->AllocateLayer();
+    }
+
+    auto& array = arrays.back();
+    int w = image.width, h = image.height;
+    for (int level = 0; level < levels; ++level) {
+        auto [data, size] = image.Level(level);
+        array->UploadRegion(layer, level, 0, 0, w, h, data, size);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    return TextureRef{array, layer, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)};
+}
+
+std::optional<TextureRef> TexturePacker::InsertAtlas(const DecodedImage& image) {
+    const bool compressed = image.format != BlockCompression::Format::None;
+    const int cellW = RoundUp(image.width, kAtlasCell);
+    const int cellH = RoundUp(image.height, kAtlasCell);
+
+    auto& pages = atlases_[AtlasKey{static_cast<uint32_t>(image.format), image.channels}];
+
+    int x = 0, y = 0;
+    AtlasPage* target = nullptr;
+    for (auto& page : pages) {
+        if (PlaceInPage(page, cellW, cellH, x, y)) {
+            target = &page;
+            break;
+        }
+    }
+
+    if (!target) {
+        // new page: next layer of the last atlas array, or a fresh array
+        std::shared_ptr<TextureArray> array = pages.empty() ? nullptr : pages.back().array;
+        int layer = array ? array->AllocateLayer() : -1;
+        if (layer < 0) {
+            array = std::make_shared<TextureArray>(image.format, image.channels, kAtlasSize, kAtlasSize,
+                                                   kAtlasLevels, 1, kAtlasPages);
+            layer = array->AllocateLayer();
+        }
+        pages.push_back({array, layer, {}, 0});
+        target = &pages.back();
+        if (!PlaceInPage(*target, cellW, cellH, x, y))
+            return std::nullopt;
+    }
+
+    // BCn sub-images are uploaded as whole blocks; the encoder clamps at the
+    // image edge, so the extra texels replicate the border inside our cell
+    int w = image.width, h = image.height;
+    for (int level = 0; level < kAtlasLevels; ++level) {
+        auto [data, size] = image.Level(level);
+        int uploadW = compressed ? RoundUp(w, 4) : w;
+        int uploadH = compressed ? RoundUp(h, 4) : h;
+        target->array->UploadRegion(target->layer, level, x >> level, y >> level, uploadW, uploadH, data, size);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    ++atlasEntries_;
+    const float inv = 1.0f / static_cast<float>(kAtlasSize);
+    return TextureRef{target->array, target->layer,
+                      glm::vec4(x * inv, y * inv, image.width * inv, image.height * inv)};
+}
+
+bool TexturePacker::PlaceInPage(AtlasPage& page, int width, int height, int& x, int& y) {
+    for (auto& shelf : page.shelves) {
+        if (height <= shelf.height && shelf.x + width <= kAtlasSize) {
+            x = shelf.x;
+            y = shelf.y;
+            shelf.x += width;
+            return true;
+        }
+    }
+
+    if (page.nextY + height > kAtlasSize)
+        return false;
+
+    page.shelves.push_back({page.nextY, height, width});
+    x = 0;
+    y = page.nextY;
+    page.nextY += height;
+    return true;
+}
+
+void TexturePacker::Clear() {
+    buckets_.clear();
+    atlases_.clear();
+    atlasEntries_ = 0;
+}
+
+size_t TexturePacker::GetArrayCount() const {
+    size_t count = 0;
+    for (const auto& [key, arrays] : buckets_)
+        count += arrays.size();
+    for (const auto& [key, pages] : atlases_) {
+        for (size_t i = 0; i < pages.size(); ++i) {
+            if (i == 0 || pages[i].array != pages[i - 1].array)
+                ++count;
+        }
+    }
+    return count;
+}
+
+size_t TexturePacker::GetByteSize() const {
+    size_t bytes = 0;
+    for (const auto& [key, arrays] : buckets_)
+        for (const auto& array : arrays)
+            bytes += array->GetByteSize();
+    for (const auto& [key, pages] : atlases_) {
+        for (size_t i = 0; i < pages.size(); ++i) {
+            if (i == 0 || pages[i].array != pages[i - 1].array)
+                bytes += pages[i].array->GetByteSize();
+        }
+    }
+    return bytes;
+}
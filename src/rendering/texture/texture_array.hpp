@@ -0,0 +1,136 @@
+#ifndef TEXTURE_ARRAY_HPP
+#define TEXTURE_ARRAY_HPP
+
+#include "block_compression.hpp"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+struct DecodedImage;
+
+//
+// === TextureArray ===
+// A GL_TEXTURE_2D_ARRAY of fixed size, format and mip count. Layers are handed
+// out by the TexturePacker, either to one whole texture or to an atlas page.
+// Storage starts at capacity layers and doubles, up to maxCapacity, when a
+// layer is asked for and none is left: the layers in use are copied into
+// the bigger texture on the GPU, so refs to the array stay valid.
+//
+class TextureArray {
+public:
+    TextureArray(BlockCompression::Format format, int channels, int width, int height, int levels, int capacity,
+                 int maxCapacity);
+    ~TextureArray();
+
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    void Bind(int unit) const;
+
+    // GL thread. Returns the new layer, growing the array if needed, or -1
+    // when it is at maxCapacity and full.
+    int AllocateLayer();
+
+    // Copies one mip level of an image (or part of an atlas page) into a layer.
+    void UploadRegion(int layer, int level, int x, int y, int width, int height,
+                      const unsigned char* data, size_t size);
+
+    // ===== Getters =====
+    [[nodiscard]] GLuint GetId() const { return id_; }
+    [[nodiscard]] int GetWidth() const { return width_; }
+    [[nodiscard]] int GetHeight() const { return height_; }
+    [[nodiscard]] int GetLevels() const { return levels_; }
+    [[nodiscard]] int GetCapacity() const { return capacity_; }
+    [[nodiscard]] int GetMaxCapacity() const { return maxCapacity_; }
+    [[nodiscard]] int GetUsedLayers() const { return usedLayers_; }
+    [[nodiscard]] size_t GetByteSize() const { return byteSize_; }
+
+private:
+    // New storage for capacity layers, all levels, sets byteSize_.
+    GLuint CreateStorage(int capacity);
+    void Grow(int capacity);
+
+    GLuint id_ = 0;
+    BlockCompression::Format format_;
+    int channels_;
+    int width_;
+    int height_;
+    int levels_;
+    int capacity_;
+    int maxCapacity_;
+    int usedLayers_ = 0;
+    size_t byteSize_ = 0;
+};
+
+//
+// === TextureRef ===
+// Where a packed texture lives: an array layer plus the sub-rectangle of that
+// layer it occupies (uv offset in xy, uv scale in zw; 0,0,1,1 for whole layers).
+//
+struct TextureRef {
+    std::shared_ptr<TextureArray> array;
+    int layer = 0;
+    glm::vec4 rect{0.0f, 0.0f, 1.0f, 1.0f};
+};
+
+//
+// === TexturePacker ===
+// Merges textures into shared arrays so draws with different textures can
+// share one bind. Same format/size/mip count textures get their own layer in
+// a bucket array; small ones are shelf packed into atlas pages, aligned to
+// 16 texel cells so the first kAtlasLevels mips stay block aligned for BCn.
+//
+class TexturePacker {
+public:
+    static constexpr int kArrayCapacity = 32;
+    static constexpr int kArrayInitialCapacity = 4; // grows from here
+    static constexpr size_t kArrayBudgetBytes = 64ull << 20; // caps layers for big textures
+    static constexpr int kAtlasSize = 1024;
+    static constexpr int kAtlasMaxEntry = 128;
+    static constexpr int kAtlasCell = 16;
+    static constexpr int kAtlasLevels = 3;
+    static constexpr int kAtlasPages = 4;
+
+    // GL thread. Returns nothing if the image cannot be packed (too few mips,
+    // unsupported size) and should be uploaded as a standalone texture.
+    std::optional<TextureRef> Insert(const DecodedImage& image);
+    // GL thread. Arrays still referenced by textures stay alive with them.
+    void Clear();
+
+    [[nodiscard]] size_t GetArrayCount() const;
+    [[nodiscard]] size_t GetAtlasEntryCount() const { return atlasEntries_; }
+    [[nodiscard]] size_t GetByteSize() const;
+
+private:
+    struct Shelf {
+        int y;
+        int height;
+        int x;
+    };
+
+    struct AtlasPage {
+        std::shared_ptr<TextureArray> array;
+        int layer;
+        std::vector<Shelf> shelves;
+        int nextY = 0;
+    };
+
+    // format, channels, width, height, levels
+    using BucketKey = std::tuple<uint32_t, int, int, int, int>;
+    // format, channels
+    using AtlasKey = std::tuple<uint32_t, int>;
+
+    std::optional<TextureRef> InsertLayer(const DecodedImage& image);
+    std::optional<TextureRef> InsertAtlas(const DecodedImage& image);
+    static bool PlaceInPage(AtlasPage& page, int width, int height, int& x, int& y);
+
+    std::map<BucketKey, std::vector<std::shared_ptr<TextureArray>>> buckets_;
+    std::map<AtlasKey, std::vector<AtlasPage>> atlases_;
+    size_t atlasEntries_ = 0;
+};
+
+#endif // TEXTURE_ARRAY_HPP
@@ -0,0 +1,218 @@
+#include "texture_baker.hpp"
+#include "texture_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace TextureBaker {
+
+namespace {
+
+// larger than any GL implementation allows, and small enough that the block
+// math in CompressedSize can't overflow on a corrupt header
+constexpr uint32_t kMaxBakedDimension = 1u << 16;
+
+bool SourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time) {
+    std::error_code ec;
+    size = fs::file_size(sourcePath, ec);
+    if (ec)
+        return false;
+    auto writeTime = fs::last_write_time(sourcePath, ec);
+    if (ec)
+        return false;
+    time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + 15) & ~uint64_t(15);
+}
+
+bool IsImageFile(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp" || ext == ".psd" ||
+           ext == ".ppm" || ext == ".pgm";
+}
+
+} // namespace
+
+std::string BakedPath(const std::string& sourcePath) {
+    // one entry per file however the path is spelled: normalized, relative
+    // to the working directory when it is below it
+    std::error_code ec;
+    fs::path source = fs::absolute(sourcePath, ec);
+    if (ec)
+        source = sourcePath;
+    source = source.lexically_normal();
+    fs::path relative = source.lexically_relative(fs::current_path(ec));
+    if (!ec && !relative.empty() && *relative.begin() != "..")
+        source = relative;
+
+    // FNV-1a over the normalized path, the stem only keeps the cache readable
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : source.generic_string()) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), "-%016llx.etx", static_cast<unsigned long long>(hash));
+    return std::string(kCacheDirectory) + "/" + source.stem().string() + suffix;
+}
+
+bool LoadBaked(const std::string& sourcePath, uint32_t support, DecodedImage& out) {
+    auto file = MappedFile::Open(BakedPath(sourcePath));
+    if (!file || file->Size() < sizeof(BakedHeader))
+        return false;
+
+    BakedHeader header;
+    std::memcpy(&header, file->Data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, 4) != 0 || header.version != kVersion || header.levelCount == 0)
+        return false;
+
+    // stale if the source changed since the bake (a missing source is fine, ship baked only)
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (SourceStamp(sourcePath, sourceSize, sourceTime) &&
+        (sourceSize != header.sourceSize || sourceTime != header.sourceTime))
+        return false;
+
+    auto format = static_cast<BlockCompression::Format>(header.format);
+    if (format == BlockCompression::Format::None ||
+        BlockCompression::ChooseFormat(static_cast<int>(header.channels), support) != format)
+        return false;
+    if (header.width == 0 || header.height == 0 || header.width > kMaxBakedDimension ||
+        header.height > kMaxBakedDimension)
+        return false;
+
+    size_t tableEnd = sizeof(BakedHeader) + header.levelCount * sizeof(BakedLevel);
+    if (file->Size() < tableEnd)
+        return false;
+
+    DecodedImage image;
+    image.width = static_cast<int>(header.width);
+    image.height = static_cast<int>(header.height);
+    image.channels = static_cast<int>(header.channels);
+    image.format = format;
+
+    // every level must lie inside the file (checked without overflowing
+    // offset + size) and hold exactly the blocks its mip size needs
+    const uint64_t fileSize = file->Size();
+    int w = image.width, h = image.height;
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        BakedLevel level;
+        std::memcpy(&level, file->Data() + sizeof(BakedHeader) + i * sizeof(BakedLevel), sizeof(level));
+        if (level.offset > fileSize || level.size > fileSize - level.offset)
+            return false;
+        if (level.size != BlockCompression::CompressedSize(format, w, h))
+            return false;
+        image.mappedLevels.emplace_back(file->Data() + level.offset, static_cast<size_t>(level.size));
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    image.mapping = std::move(file);
+    out = std::move(image);
+    return true;
+}
+
+bool Bake(const std::string& sourcePath, DecodedImage& image, uint32_t support) {
+    if (!image.IsValid() || image.mapping || image.format != BlockCompression::Format::None)
+        return false;
+
+    BlockCompression::Format format = BlockCompression::ChooseFormat(image.channels, support);
+    if (format == BlockCompression::Format::None)
+        return false;
+
+    if (image.levels.size() == 1)
+        TextureCache::BuildMipChain(image);
+
+    std::vector<std::vector<unsigned char>> compressed;
+    compressed.reserve(image.levels.size());
+    int w = image.width, h = image.height;
+    for (const auto& level : image.levels) {
+        compressed.push_back(BlockCompression::Compress(format, level.data(), w, h, image.channels));
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    image.levels = std::move(compressed);
+    image.format = format;
+
+    // --- Write the baked file next to the others, atomically via rename ---
+    BakedHeader header{};
+    std::memcpy(header.magic, kMagic, 4);
+    header.version = kVersion;
+    header.format = static_cast<uint32_t>(format);
+    header.width = static_cast<uint32_t>(image.width);
+    header.height = static_cast<uint32_t>(image.height);
+    header.channels = static_cast<uint32_t>(image.channels);
+    header.levelCount = static_cast<uint32_t>(image.levels.size());
+    SourceStamp(sourcePath, header.sourceSize, header.sourceTime);
+
+    std::vector<BakedLevel> table(image.levels.size());
+    uint64_t offset = AlignUp(sizeof(BakedHeader) + table.size() * sizeof(BakedLevel));
+    for (size_t i = 0; i < image.levels.size(); ++i) {
+        table[i] = {offset, image.levels[i].size()};
+        offset = AlignUp(offset + image.levels[i].size());
+    }
+
+    std::string bakedPath = BakedPath(sourcePath);
+    std::string tempPath = bakedPath + ".tmp";
+    std::error_code ec;
+    fs::create_directories(kCacheDirectory, ec);
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "[TextureBaker][WARN] Could not write " << tempPath << std::endl;
+            return true; // the image itself is compressed and usable
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(BakedLevel)));
+        for (size_t i = 0; i < image.levels.size(); ++i) {
+            file.seekp(static_cast<std::streamoff>(table[i].offset));
+            file.write(reinterpret_cast<const char*>(image.levels[i].data()), static_cast<std::streamsize>(image.levels[i].size()));
+        }
+    }
+
+    fs::rename(tempPath, bakedPath, ec);
+    if (ec)
+        std::cerr << "[TextureBaker][WARN] Could not replace " << bakedPath << ": " << ec.message() << std::endl;
+    else
+        std::cout << "[TextureBaker] Baked " << sourcePath << " -> " << bakedPath << " ("
+                  << BlockCompression::FormatName(format) << ", " << image.levels.size() << " levels)" << std::endl;
+    return true;
+}
+
+size_t BakeDirectory(const std::string& directory, uint32_t support) {
+    size_t baked = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file() || !IsImageFile(entry.path()))
+            continue;
+
+        std::string path = entry.path().generic_string();
+        DecodedImage cached;
+        if (LoadBaked(path, support, cached))
+            continue;
+
+        DecodedImage image = TextureCache::Decode(path, true);
+        if (Bake(path, image, support))
+            ++baked;
+    }
+
+    if (ec)
+        std::cerr << "[TextureBaker][WARN] Could not walk " << directory << ": " << ec.message() << std::endl;
+    std::cout << "[TextureBaker] Baked " << baked << " textures from " << directory << std::endl;
+    return baked;
+}
+
+} // namespace TextureBaker
@@ -0,0 +1,58 @@
+#ifndef TEXTURE_BAKER_HPP
+#define TEXTURE_BAKER_HPP
+
+#include "texture.hpp"
+#include <cstdint>
+#include <string>
+
+//
+// === TextureBaker ===
+// Block compressed texture cache. A baked file (.etx) holds a full BCn mip
+// chain laid out so it can be memory mapped and handed straight to
+// glCompressedTexImage2D. Files are stamped with the source size and mtime
+// and are rebaked when the source changes.
+//
+// Layout: BakedHeader | BakedLevel[levelCount] | level data (16 byte aligned)
+//
+namespace TextureBaker {
+
+constexpr char kMagic[4] = {'E', 'T', 'X', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr const char* kCacheDirectory = "assets/cache/textures";
+
+struct BakedHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t format; // BlockCompression::Format
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t levelCount;
+    uint32_t reserved;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+};
+
+struct BakedLevel {
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Cache file for a source: its stem plus a hash of the normalized path, so
+// sources with the same name in different directories don't collide.
+std::string BakedPath(const std::string& sourcePath);
+
+// Maps the baked file for sourcePath if it is up to date and its format is in
+// `support`. Level data points into the mapping.
+bool LoadBaked(const std::string& sourcePath, uint32_t support, DecodedImage& out);
+
+// Compresses a decoded image (level 0 plus CPU mip chain) in place and writes
+// the baked file. Leaves the image untouched if no supported format fits.
+bool Bake(const std::string& sourcePath, DecodedImage& image, uint32_t support);
+
+// Offline step: bakes every image under `directory`. Returns the number baked.
+size_t BakeDirectory(const std::string& directory, uint32_t support);
+
+} // namespace TextureBaker
+
+#endif // TEXTURE_BAKER_HPP
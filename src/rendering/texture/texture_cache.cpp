@@ -0,0 +1,186 @@
+#include "texture_cache.hpp"
+#include "texture_baker.hpp"
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+TextureCache& TextureCache::Instance() {
+    static TextureCache instance;
+    return instance;
+}
+
+TextureCache::TextureCache() {
+    // constructed first, so the pool outlives the decode jobs pointing at us
+    JobSystem::Instance();
+}
+
+TextureCache::~TextureCache() {
+    // queued decodes bail out, only the running ones are waited for
+    stopping_ = true;
+    JobSystem::Instance().Wait(decoding_);
+}
+
+std::shared_ptr<Texture> TextureCache::Load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (auto it = cache_.find(path); it != cache_.end())
+        return it->second;
+
+    auto texture = std::make_shared<Texture>(path, packingEnabled_);
+    cache_[path] = texture;
+    bool generateMips = mipGeneration_ == MipGeneration::Cpu;
+    JobSystem::Instance().Schedule([this, texture, generateMips]() { DecodeTexture(texture, generateMips); },
+                                   &decoding_);
+
+    return texture;
+}
+
+void TextureCache::QueryFormatSupport() {
+    formatSupport_ = BlockCompression::QuerySupport();
+    std::cout << "[TextureCache] Compressed formats: RGTC"
+              << ((formatSupport_ & BlockCompression::SupportS3TC) ? " S3TC" : "")
+              << ((formatSupport_ & BlockCompression::SupportBPTC) ? " BPTC" : "") << std::endl;
+}
+
+void TextureCache::DecodeTexture(const std::shared_ptr<Texture>& texture, bool generateMips) {
+    if (stopping_)
+        return;
+
+    const std::string& path = texture->GetPath();
+    uint32_t support = formatSupport_;
+    DecodedImage image;
+
+    if (!bakingEnabled_ || !TextureBaker::LoadBaked(path, support, image)) {
+        // baked files always carry a full mip chain
+        image = Decode(path, generateMips || bakingEnabled_);
+        if (bakingEnabled_)
+            TextureBaker::Bake(path, image, support);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uploadQueue_.push_back({texture, std::move(image)});
+}
+
+DecodedImage TextureCache::Decode(const std::string& path, bool generateMips) {
+    stbi_set_flip_vertically_on_load_thread(1);
+
+    DecodedImage image;
+    unsigned char* pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+    if (!pixels) {
+        std::cerr << "[TextureCache][WARN] Failed to decode " << path << ": " << stbi_failure_reason() << std::endl;
+        return {};
+    }
+
+    size_t size = static_cast<size_t>(image.width) * image.height * image.channels;
+    image.levels.emplace_back(pixels, pixels + size);
+    stbi_image_free(pixels);
+
+    if (generateMips)
+        BuildMipChain(image);
+
+    return image;
+}
+
+//
+// 2x2 box filter down to 1x1. Odd sizes clamp the last row/column.
+//
+void TextureCache::BuildMipChain(DecodedImage& image) {
+    int w = image.width, h = image.height;
+    const int c = image.channels;
+
+    while (w > 1 || h > 1) {
+        int nw = std::max(1, w / 2), nh = std::max(1, h / 2);
+        const std::vector<unsigned char>& src = image.levels.back();
+        std::vector<unsigned char> dst(static_cast<size_t>(nw) * nh * c);
+
+        for (int y = 0; y < nh; ++y) {
+            int y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+            for (int x = 0; x < nw; ++x) {
+                int x0 = std::min(x * 2, w - 1), x1 = std::min(x * 2 + 1, w - 1);
+                for (int ch = 0; ch < c; ++ch) {
+                    int sum = src[(static_cast<size_t>(y0) * w + x0) * c + ch] +
+                              src[(static_cast<size_t>(y0) * w + x1) * c + ch] +
+                              src[(static_cast<size_t>(y1) * w + x0) * c + ch] +
+                              src[(static_cast<size_t>(y1) * w + x1) * c + ch];
+                    dst[(static_cast<size_t>(y) * nw + x) * c + ch] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+
+        image.levels.push_back(std::move(dst));
+        w = nw;
+        h = nh;
+    }
+}
+
+size_t TextureCache::ProcessUploads(double budgetMs) {
+    auto start = std::chrono::steady_clock::now();
+    size_t uploaded = 0;
+
+    while (true) {
+        UploadJob job;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (uploadQueue_.empty())
+                break;
+            job = std::move(uploadQueue_.front());
+            uploadQueue_.pop_front();
+        }
+
+        if (!job.image.IsValid())
+            job.texture->MarkFailed();
+        else if (!job.texture->IsPacked())
+            job.texture->Upload(job.image, mipGeneration_ == MipGeneration::Gpu);
+        else if (auto ref = packer_.Insert(job.image))
+            job.texture->SetPacked(std::move(*ref), job.image);
+        else
+            job.texture->MarkFailed();
+        ++uploaded;
+
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= budgetMs)
+            break;
+    }
+
+    if (uploaded)
+        glActiveTexture(GL_TEXTURE0);
+    return uploaded;
+}
+
+size_t TextureCache::Trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::erase_if(cache_, [](const auto& entry) {
+        return entry.second.use_count() == 1 && entry.second->GetState() != TextureState::Pending;
+    });
+}
+
+void TextureCache::Clear() {
+    stopping_ = true;
+    JobSystem::Instance().Wait(decoding_);
+    stopping_ = false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uploadQueue_.clear();
+    cache_.clear();
+    packer_.Clear();
+}
+
+size_t TextureCache::GetCachedCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_.size();
+}
+
+size_t TextureCache::GetPendingCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return decoding_.GetPending() + uploadQueue_.size();
+}
+
+std::vector<std::shared_ptr<Texture>> TextureCache::GetTextures() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::shared_ptr<Texture>> result;
+    result.reserve(cache_.size());
+    for (const auto& entry : cache_)
+        result.push_back(entry.second);
+    return result;
+}
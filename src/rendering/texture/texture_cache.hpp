@@ -0,0 +1,92 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include "../../jobs/job_system.hpp"
+#include "texture.hpp"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class MipGeneration { None, Cpu, Gpu };
+
+//
+// === TextureCache ===
+// Deduplicates textures by path and loads them without blocking the frame:
+// Load() returns a Pending texture right away, a JobSystem job decodes it with
+// stb_image (and build the mip chain when MipGeneration::Cpu), and the GL
+// thread uploads finished images in ProcessUploads() within a time budget.
+// With baking enabled, decode jobs prefer an up to date block compressed file from
+// the TextureBaker cache and bake one on first use otherwise. With packing
+// enabled, uploads go into the TexturePacker's shared arrays instead.
+//
+class TextureCache {
+public:
+    static TextureCache& Instance();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    std::shared_ptr<Texture> Load(const std::string& path);
+
+    // GL thread, once per frame. Uploads at least one ready image, then keeps
+    // going until budgetMs is spent. Returns the number of textures uploaded.
+    size_t ProcessUploads(double budgetMs);
+
+    // Drops textures nobody references anymore. Returns how many were freed.
+    size_t Trim();
+
+    // GL thread, before the context goes away: waits for running decodes and
+    // drops every cached texture, queued upload and packed array. The GL
+    // objects are freed here as long as nothing else holds on to them.
+    void Clear();
+
+    // GL thread, once after context creation: which BCn formats can be used.
+    void QueryFormatSupport();
+    [[nodiscard]] uint32_t GetFormatSupport() const { return formatSupport_; }
+
+    void SetBakingEnabled(bool enabled) { bakingEnabled_ = enabled; }
+    [[nodiscard]] bool IsBakingEnabled() const { return bakingEnabled_; }
+
+    // Only affects textures loaded afterwards; shaders sample them as sampler2DArray.
+    void SetPackingEnabled(bool enabled) { packingEnabled_ = enabled; }
+    [[nodiscard]] bool IsPackingEnabled() const { return packingEnabled_; }
+    [[nodiscard]] const TexturePacker& GetPacker() const { return packer_; }
+
+    void SetMipGeneration(MipGeneration mode) { mipGeneration_ = mode; }
+    [[nodiscard]] MipGeneration GetMipGeneration() const { return mipGeneration_; }
+
+    [[nodiscard]] size_t GetCachedCount();
+    [[nodiscard]] size_t GetPendingCount();
+    [[nodiscard]] std::vector<std::shared_ptr<Texture>> GetTextures();
+
+    static DecodedImage Decode(const std::string& path, bool generateMips);
+    static void BuildMipChain(DecodedImage& image);
+
+private:
+    struct UploadJob {
+        std::shared_ptr<Texture> texture;
+        DecodedImage image;
+    };
+
+    TextureCache();
+    ~TextureCache();
+
+    void DecodeTexture(const std::shared_ptr<Texture>& texture, bool generateMips);
+
+    std::unordered_map<std::string, std::shared_ptr<Texture>> cache_;
+    std::deque<UploadJob> uploadQueue_;
+    std::mutex mutex_;
+    JobCounter decoding_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<MipGeneration> mipGeneration_{MipGeneration::Cpu};
+    std::atomic<bool> bakingEnabled_{true};
+    std::atomic<bool> packingEnabled_{false};
+    TexturePacker packer_; // GL thread only
+    std::atomic<uint32_t> formatSupport_{BlockCompression::SupportRGTC};
+};
+
+#endif // TEXTURE_CACHE_HPP
@@ -0,0 +1,199 @@
+#include "headless_window.hpp"
+#include "../bench/gpu_profiler.hpp"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef ETHERION_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessWindow::HeadlessWindow(int width, int height, int versionMajor, int versionMinor)
+    : screenWidth(width), screenHeight(height) {
+    std::cout << "[HeadlessWindow] Creating offscreen target: " << width << "x" << height << std::endl;
+    // a throwing constructor never reaches the destructor, so whatever was
+    // created before the failure is released here
+    try {
+        CreateContext(versionMajor, versionMinor);
+        CreateFramebuffer();
+        ImGuiInitialize();
+    } catch (...) {
+        Shutdown();
+        throw;
+    }
+}
+
+HeadlessWindow::~HeadlessWindow() {
+    Shutdown();
+}
+
+#ifdef ETHERION_HEADLESS_EGL
+
+void HeadlessWindow::CreateContext(int major, int minor) {
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+
+    // prefer Mesa's surfaceless platform, it needs neither X11 nor a DRM device
+    auto getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay)
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (eglDisplay == EGL_NO_DISPLAY)
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint eglMajor = 0, eglMinor = 0;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &eglMajor, &eglMinor))
+        throw std::runtime_error("[HeadlessWindow] Failed to initialize EGL display");
+    // kept from here on so Shutdown() releases it whatever fails next
+    display = eglDisplay;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+        throw std::runtime_error("[HeadlessWindow] EGL does not support desktop OpenGL");
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCount) || configCount == 0)
+        throw std::runtime_error("[HeadlessWindow] No EGL config with OpenGL support");
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+    if (eglContext == EGL_NO_CONTEXT)
+        throw std::runtime_error("[HeadlessWindow] Failed to create OpenGL " + std::to_string(major) + "." +
+                                 std::to_string(minor) + " core context");
+    context = eglContext;
+
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+        throw std::runtime_error("[HeadlessWindow] Failed to make surfaceless context current");
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+        throw std::runtime_error("[HeadlessWindow] Failed to initialize GLAD");
+
+    renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    std::cout << "[HeadlessWindow] EGL " << eglMajor << "." << eglMinor
+              << ", renderer: " << renderer << std::endl;
+}
+
+void HeadlessWindow::Shutdown() {
+    std::cout << "[HeadlessWindow] Shutting down" << std::endl;
+
+    if (ImGui::GetCurrentContext()) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    if (fbo) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        fbo = colorBuffer = depthBuffer = 0;
+    }
+
+    if (display) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context)
+            eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+    display = nullptr;
+    context = nullptr;
+}
+
+#else
+
+void HeadlessWindow::CreateContext(int, int) {
+    throw std::runtime_error("[HeadlessWindow] Built without EGL, headless mode is unavailable");
+}
+
+void HeadlessWindow::Shutdown() {}
+
+#endif
+
+void HeadlessWindow::CreateFramebuffer() {
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, screenWidth, screenHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, screenWidth, screenHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        throw std::runtime_error("[HeadlessWindow] Offscreen framebuffer is incomplete");
+
+    glViewport(0, 0, screenWidth, screenHeight);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void HeadlessWindow::ImGuiInitialize() {
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(screenWidth), static_cast<float>(screenHeight));
+    io.IniFilename = nullptr;
+    ImGui::StyleColorsDark();
+
+    ImGui_ImplOpenGL3_Init("#version 330 core");
+
+    std::cout << "[HeadlessWindow] ImGui initialized (no input backend)" << std::endl;
+}
+
+void HeadlessWindow::BeginFrame(float deltaTime) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, screenWidth, screenHeight);
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DeltaTime = deltaTime > 0.0f ? deltaTime : 1.0f / 60.0f;
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui::NewFrame();
+}
+
+void HeadlessWindow::EndFrame() {
+    {
+        GpuProfiler::Zone zone("imgui");
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
+
+    // there is no swap to pace us, wait for the frame so timings are real
+    glFinish();
+}
+
+bool HeadlessWindow::SaveFramebuffer(const std::string& path) const {
+    std::vector<unsigned char> pixels(static_cast<size_t>(screenWidth) * screenHeight * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, screenWidth, screenHeight, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "[HeadlessWindow][Error] Could not write " << path << std::endl;
+        return false;
+    }
+
+    file << "P6\n" << screenWidth << " " << screenHeight << "\n255\n";
+    // GL rows are bottom-up, PPM rows are top-down
+    for (int y = screenHeight - 1; y >= 0; --y)
+        file.write(reinterpret_cast<const char*>(&pixels[static_cast<size_t>(y) * screenWidth * 3]), screenWidth * 3);
+
+    std::cout << "[HeadlessWindow] Saved framebuffer to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef HEADLESS_WINDOW_HPP
+#define HEADLESS_WINDOW_HPP
+
+#include <glad/glad.h>
+
+#include <imgui.h>
+#include <imgui_impl_opengl3.h>
+
+#include <chrono>
+#include <string>
+
+//
+// === HeadlessWindow ===
+// Offscreen counterpart of Window for benchmarks and automated runs. Creates
+// a surfaceless EGL context (works on Mesa llvmpipe without a display or GPU)
+// and renders into an FBO of the requested size. ImGui gets a renderer but no
+// platform backend, so there is no input; the console still draws into the FBO.
+//
+// Only available when built with ETHERION_HEADLESS_EGL, otherwise the
+// constructor throws.
+//
+class HeadlessWindow {
+public:
+    HeadlessWindow(int width, int height, int versionMajor = 3, int versionMinor = 3);
+    ~HeadlessWindow();
+
+    HeadlessWindow(const HeadlessWindow&) = delete;
+    HeadlessWindow& operator=(const HeadlessWindow&) = delete;
+
+    void BeginFrame(float deltaTime);
+    void EndFrame();
+
+    // Writes the current FBO contents as a binary PPM.
+    bool SaveFramebuffer(const std::string& path) const;
+
+    // Time
+    float GetDeltaTime() {
+        auto now = std::chrono::steady_clock::now();
+        float deltaTime = std::chrono::duration<float>(now - lastFrame).count();
+        lastFrame = now;
+        return deltaTime;
+    }
+
+    // ======= Getters =======
+    int GetScreenWidth() const { return screenWidth; }
+    int GetScreenHeight() const { return screenHeight; }
+    GLuint GetFramebuffer() const { return fbo; }
+    const std::string& GetRendererName() const { return renderer; }
+
+private:
+    void CreateContext(int major, int minor);
+    void CreateFramebuffer();
+    void ImGuiInitialize();
+    void Shutdown();
+
+    void* display = nullptr; // EGLDisplay
+    void* context = nullptr; // EGLContext
+
+    GLuint fbo = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+
+    int screenWidth = 0;
+    int screenHeight = 0;
+    std::string renderer;
+
+    std::chrono::steady_clock::time_point lastFrame = std::chrono::steady_clock::now();
+};
+
+#endif /* HEADLESS_WINDOW_HPP */
@@ -1,4 +1,5 @@
 #include "Window.hpp"
+#include "../bench/gpu_profiler.hpp"
 #include <iostream>
 
 Window::Window(int width, int height, const char* title, int versionMajor, int versionMinor, int profile) {
@@ -93,6 +94,7 @@ void Window::ImGuiBeginFrame() {
 }
 
 void Window::ImGuiRender() {
+    GpuProfiler::Zone zone("imgui");
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
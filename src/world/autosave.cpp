@@ -0,0 +1,302 @@
+#include "autosave.hpp"
+#include "world.hpp"
+#include "../jobs/job_system.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Autosave::~Autosave() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void Autosave::OnParamsChanged(std::span<const ParamChange> changes) {
+    for (const ParamChange& change : changes) {
+        if (change.owner.index >= paramsChanged_.size())
+            paramsChanged_.resize(change.owner.index + 1, 0);
+        paramsChanged_[change.owner.index] = 1;
+    }
+}
+
+void Autosave::Update(float deltaTime) {
+    if (capturing_) {
+        Step();
+        return;
+    }
+    if (!enabled_ && !requested_)
+        return;
+    elapsed_ += deltaTime;
+    if (!requested_ && elapsed_ < interval_)
+        return;
+    // still writing the last one; the snapshot waits rather than the frame
+    if (writing_.load(std::memory_order_acquire))
+        return;
+    elapsed_ = 0.0f;
+    requested_ = false;
+
+    if (BeginCapture())
+        Step();
+}
+
+void Autosave::Resize(size_t blockCount) {
+    blocks_.resize(blockCount);
+    transforms_.resize(blockCount);
+    entitiesAt_.resize(blockCount, 0);
+    transformsAt_.resize(blockCount, 0);
+    paramsChanged_.resize(std::max(paramsChanged_.size(), blockCount << EntityStore::kStampShift), 0);
+}
+
+bool Autosave::LayoutChanged(size_t block) const {
+    return !blocks_[block] || world_.GetStore().GetLayoutStamp(block) >= entitiesAt_[block];
+}
+
+bool Autosave::ParamsChanged(size_t block) const {
+    auto params = paramsChanged_.begin() + static_cast<std::ptrdiff_t>(block << EntityStore::kStampShift);
+    return std::find(params, params + EntityStore::kStampBlock, 1) != params + EntityStore::kStampBlock;
+}
+
+bool Autosave::BeginCapture() {
+    auto start = std::chrono::steady_clock::now();
+    const EntityStore& store = world_.GetStore();
+    size_t blockCount = store.GetStampBlockCount();
+    Resize(blockCount);
+
+    bool full = mode_ == Mode::Full;
+    changedBlocks_.clear();
+    movedBlocks_.clear();
+    for (size_t b = 0; b < blockCount; ++b) {
+        auto block = static_cast<uint32_t>(b);
+        if (full || LayoutChanged(b) || ParamsChanged(b))
+            changedBlocks_.push_back(block);
+        else if (store.GetTransformStamp(b) >= transformsAt_[b])
+            movedBlocks_.push_back(block);
+    }
+    nextChanged_ = 0;
+    nextMoved_ = 0;
+    freshBlocks_ = full ? changedBlocks_.size() : 0;
+    rounds_ = 0;
+
+    pass_ = {};
+    pass_.blocks = blockCount;
+    pass_.captureMs = MillisecondsSince(start);
+    pass_.captureStepMs = pass_.captureMs;
+    pass_.captureFrames = 1;
+    if (changedBlocks_.empty() && movedBlocks_.empty()) {
+        PublishStats();
+        return false;
+    }
+    capturing_ = true;
+    return true;
+}
+
+void Autosave::Step() {
+    auto start = std::chrono::steady_clock::now();
+    EntityStore& store = world_.GetStore();
+    // anything edited from here on is stamped period or later
+    uint32_t period = store.NextStampPeriod();
+    size_t blockCount = store.GetStampBlockCount();
+    Resize(blockCount);
+
+    bool done = false;
+    while (!done && (rounds_ >= kMaxRounds || MillisecondsSince(start) < kStepBudgetMs)) {
+        work_.clear();
+        while (work_.size() < kStepBlocks) {
+            if (nextChanged_ < changedBlocks_.size()) {
+                bool reuse = nextChanged_ >= freshBlocks_;
+                uint32_t b = changedBlocks_[nextChanged_++];
+                if (b < blockCount)
+                    work_.push_back({b, true, reuse});
+            } else if (nextMoved_ < movedBlocks_.size()) {
+                // the entities it holds may be gone by now
+                uint32_t b = movedBlocks_[nextMoved_++];
+                if (b < blockCount)
+                    work_.push_back({b, LayoutChanged(b), true});
+            } else {
+                break;
+            }
+        }
+        if (!work_.empty())
+            CaptureWork(period);
+        else if (!Recheck())
+            done = true;
+    }
+
+    double stepMs = MillisecondsSince(start);
+    pass_.captureMs += stepMs;
+    pass_.captureStepMs = std::max(pass_.captureStepMs, stepMs);
+    ++pass_.captureFrames;
+    if (done)
+        Finish();
+}
+
+void Autosave::CaptureWork(uint32_t period) {
+    // only reads the world, and nothing else runs at the frame boundary
+    std::atomic<size_t> copied{0};
+    JobSystem::Instance().ParallelFor(work_.size(), kBlockGrain, [&](size_t begin, size_t end) {
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const Work& work = work_[i];
+            if (work.entities)
+                blocks_[work.block] = CaptureBlock(work.block, work.reuse, count);
+            transforms_[work.block] = SceneFile::CaptureTransforms(world_, *blocks_[work.block]);
+        }
+        copied.fetch_add(count, std::memory_order_relaxed);
+    });
+
+    for (const Work& work : work_) {
+        transformsAt_[work.block] = period;
+        if (!work.entities)
+            continue;
+        entitiesAt_[work.block] = period;
+        auto params = paramsChanged_.begin() + static_cast<std::ptrdiff_t>(work.block << EntityStore::kStampShift);
+        std::fill(params, params + EntityStore::kStampBlock, 0);
+        ++pass_.capturedBlocks;
+    }
+    pass_.capturedEntities += copied.load(std::memory_order_relaxed);
+    pass_.capturedTransforms += work_.size();
+}
+
+bool Autosave::Recheck() {
+    changedBlocks_.clear();
+    movedBlocks_.clear();
+    nextChanged_ = 0;
+    nextMoved_ = 0;
+    freshBlocks_ = 0;
+    for (size_t b = 0; b < blocks_.size(); ++b) {
+        if (LayoutChanged(b))
+            changedBlocks_.push_back(static_cast<uint32_t>(b));
+    }
+    if (changedBlocks_.empty())
+        return false;
+    ++rounds_;
+    return true;
+}
+
+void Autosave::Finish() {
+    capturing_ = false;
+    PublishStats();
+
+    auto snapshot = std::make_shared<SceneFile::Snapshot>();
+    snapshot->blocks = blocks_;
+    snapshot->transforms = transforms_;
+    {
+        std::lock_guard lock(mutex_);
+        pending_ = std::move(snapshot);
+        writing_.store(true, std::memory_order_release);
+    }
+    if (!thread_.joinable())
+        thread_ = std::thread(&Autosave::WorkerLoop, this);
+    wake_.notify_one();
+}
+
+void Autosave::PublishStats() {
+    std::lock_guard lock(mutex_);
+    size_t saves = stats_.saves, failures = stats_.failures;
+    double writeMs = stats_.writeMs;
+    uint64_t bytes = stats_.bytes;
+    stats_ = pass_;
+    stats_.saves = saves;
+    stats_.failures = failures;
+    stats_.writeMs = writeMs;
+    stats_.bytes = bytes;
+}
+
+std::shared_ptr<const SceneFile::SnapshotBlock> Autosave::CaptureBlock(uint32_t block, bool reuse,
+                                                                       size_t& copied) const {
+    const EntityStore& store = world_.GetStore();
+    EntityHandle root = world_.GetRoot()->GetHandle();
+    const SceneFile::SnapshotBlock* previous = reuse ? blocks_[block].get() : nullptr;
+    auto captured = std::make_shared<SceneFile::SnapshotBlock>();
+
+    // both in slot order, so the previous block is walked alongside
+    size_t at = 0;
+    uint32_t first = block << EntityStore::kStampShift;
+    for (uint32_t slot = first; slot < first + EntityStore::kStampBlock; ++slot) {
+        EntityHandle handle = store.GetSlotHandle(slot);
+        if (!handle.IsValid() || handle == root)
+            continue;
+        while (previous && at < previous->entities.size() && previous->entities[at]->handle.index < slot)
+            ++at;
+        if (previous && at < previous->entities.size() && !paramsChanged_[slot]) {
+            const auto& last = previous->entities[at];
+            EntityHandle parent = store.GetParent(handle);
+            uint32_t parentSlot = parent.IsValid() && parent != root ? parent.index : SceneFile::kNone;
+            if (last->handle == handle && last->parent == parentSlot &&
+                last->name == store.GetEntity(handle)->GetName()) {
+                captured->entities.push_back(last);
+                continue;
+            }
+        }
+        captured->entities.push_back(SceneFile::CaptureEntity(world_, handle));
+        ++copied;
+    }
+    return captured;
+}
+
+void Autosave::WorkerLoop() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || pending_; });
+        // a queued snapshot is still written on the way out
+        if (!pending_)
+            return;
+        auto snapshot = std::move(pending_);
+        std::string path = path_;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t bytes = SceneFile::Write(*snapshot, path);
+        double writeMs = MillisecondsSince(start);
+        // the last reference to blocks replaced since goes here, off the main thread
+        snapshot.reset();
+
+        lock.lock();
+        if (bytes) {
+            ++stats_.saves;
+            stats_.bytes = bytes;
+            stats_.writeMs = writeMs;
+        } else {
+            ++stats_.failures;
+            std::cerr << "[AUTOSAVE][WARN] Could not write " << path << std::endl;
+        }
+        if (!pending_) {
+            writing_.store(false, std::memory_order_release);
+            idle_.notify_all();
+        }
+    }
+}
+
+void Autosave::Wait() {
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this] { return !writing_.load(std::memory_order_acquire); });
+}
+
+void Autosave::SetEnabled(bool enabled) {
+    enabled_ = enabled;
+    elapsed_ = 0.0f;
+}
+
+void Autosave::SetPath(std::string path) {
+    std::lock_guard lock(mutex_);
+    path_ = std::move(path);
+}
+
+std::string Autosave::GetPath() const {
+    std::lock_guard lock(mutex_);
+    return path_;
+}
+
+Autosave::Stats Autosave::GetStats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
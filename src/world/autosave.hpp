@@ -0,0 +1,168 @@
+#ifndef AUTOSAVE_HPP
+#define AUTOSAVE_HPP
+
+#include "../entity/param_sync.hpp"
+#include "scene_file.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+class World;
+
+//
+// === Autosave ===
+// Saves the world as a SceneFile every interval without holding up the
+// frame. At the frame boundary (World::Update / BeginFrame, after the param
+// sync) it takes a snapshot: only entities that changed since the last one
+// are copied out, on the JobSystem, and everything else is shared with it;
+// transforms are copied per block of slots, apart from the rest. A thread of
+// its own then writes the snapshot, syncs it to disk and renames it over the
+// target.
+//
+// Copying is spread over frames, about kStepBudgetMs each, so a first save,
+// a full one or the one after a clear doesn't stall. Blocks whose entities
+// were created, destroyed, reparented or renamed after they were copied are
+// copied again before the snapshot is handed over, so it always holds one
+// frame's hierarchy; params and transforms are each as of the frame their
+// block was copied, and later changes go into the next save.
+//
+// Incremental mode finds what changed through the store's edit stamps and
+// the ParamSync batches, and skips the save when nothing did. Full mode
+// copies every entity every time. Uniforms set straight on a renderable
+// aren't tracked; incremental saves pick them up with the next change to
+// that entity's params, name or parent.
+//
+class Autosave : public ParamSubscriber {
+  public:
+    enum class Mode : uint8_t { Incremental, Full };
+
+    struct Stats {
+        size_t saves = 0;
+        size_t failures = 0;
+        // last snapshot
+        size_t blocks = 0;
+        size_t capturedBlocks = 0;
+        size_t capturedEntities = 0;
+        size_t capturedTransforms = 0; // blocks
+        double captureMs = 0.0; // main thread, all frames together
+        double captureStepMs = 0.0; // the longest frame of it
+        size_t captureFrames = 0;
+        // last write
+        double writeMs = 0.0; // autosave thread
+        uint64_t bytes = 0;
+    };
+
+    static constexpr const char* kDefaultPath = "projects/autosave.escn";
+    static constexpr float kDefaultInterval = 60.0f; // seconds
+
+    explicit Autosave(World& world) : world_(world) {}
+    // Waits for a write in progress, and one still queued.
+    ~Autosave();
+
+    Autosave(const Autosave&) = delete;
+    Autosave& operator=(const Autosave&) = delete;
+
+    void OnParamsChanged(std::span<const ParamChange> changes) override;
+
+    // Main thread, at the frame boundary. Starts a snapshot when the interval
+    // has passed or a save was requested, unless the last one is still being
+    // written (then it retries next frame), and carries on with one in
+    // progress.
+    void Update(float deltaTime);
+    // Starts a save at the next Update regardless of the interval or SetEnabled.
+    void Request() { requested_ = true; }
+    // Blocks until the last snapshot handed over is on disk.
+    void Wait();
+
+    void SetEnabled(bool enabled);
+    [[nodiscard]] bool IsEnabled() const { return enabled_; }
+    void SetInterval(float seconds) { interval_ = seconds > 1.0f ? seconds : 1.0f; }
+    [[nodiscard]] float GetInterval() const { return interval_; }
+    void SetPath(std::string path);
+    [[nodiscard]] std::string GetPath() const;
+    void SetMode(Mode mode) { mode_ = mode; }
+    [[nodiscard]] Mode GetMode() const { return mode_; }
+    [[nodiscard]] bool IsCapturing() const { return capturing_; }
+    [[nodiscard]] bool IsWriting() const { return writing_.load(std::memory_order_acquire); }
+    [[nodiscard]] Stats GetStats() const;
+
+  private:
+    // blocks per job when capturing
+    static constexpr size_t kBlockGrain = 4;
+    // blocks per ParallelFor, the budget is checked between them
+    static constexpr size_t kStepBlocks = 8;
+    static constexpr double kStepBudgetMs = 1.0;
+    // rechecks after which the rest is copied regardless of the budget
+    static constexpr int kMaxRounds = 8;
+
+    struct Work {
+        uint32_t block;
+        bool entities; // else transforms only
+        bool reuse;
+    };
+
+    // Queues what changed since each block was copied. False when nothing
+    // did (incremental mode).
+    bool BeginCapture();
+    // One frame's share; hands the snapshot over once every block is current.
+    void Step();
+    // Requeues blocks whose layout changed since they were copied.
+    bool Recheck();
+    void CaptureWork(uint32_t period);
+    void Finish();
+    void Resize(size_t blockCount);
+    [[nodiscard]] bool LayoutChanged(size_t block) const;
+    [[nodiscard]] bool ParamsChanged(size_t block) const;
+    // Copies the block's entities that changed, shares the rest with its last
+    // capture (none with reuse off). Adds the copies to copied.
+    std::shared_ptr<const SceneFile::SnapshotBlock> CaptureBlock(uint32_t block, bool reuse, size_t& copied) const;
+    void PublishStats();
+    void WorkerLoop();
+
+    World& world_;
+    bool enabled_ = false;
+    bool requested_ = false;
+    float interval_ = kDefaultInterval;
+    float elapsed_ = 0.0f;
+    Mode mode_ = Mode::Incremental;
+
+    // the latest copy of each block, shared with the snapshots made of them
+    std::vector<std::shared_ptr<const SceneFile::SnapshotBlock>> blocks_;
+    std::vector<std::shared_ptr<const std::vector<Transform>>> transforms_;
+    // per block, the stamp period its entities / transforms were copied in
+    std::vector<uint32_t> entitiesAt_;
+    std::vector<uint32_t> transformsAt_;
+    std::vector<uint8_t> paramsChanged_; // per slot, since its block was copied
+
+    // the snapshot in progress
+    bool capturing_ = false;
+    // blocks to capture whole / transforms only, and how far along each is
+    std::vector<uint32_t> changedBlocks_;
+    std::vector<uint32_t> movedBlocks_;
+    size_t nextChanged_ = 0;
+    size_t nextMoved_ = 0;
+    size_t freshBlocks_ = 0; // leading changedBlocks_ copied without reuse (full mode)
+    int rounds_ = 0;
+    std::vector<Work> work_;
+    Stats pass_; // its snapshot stats
+
+    // guarded by mutex_
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::shared_ptr<const SceneFile::Snapshot> pending_;
+    std::string path_ = kDefaultPath;
+    Stats stats_;
+    bool stopping_ = false;
+
+    std::atomic<bool> writing_{false};
+    std::thread thread_;
+};
+
+#endif // AUTOSAVE_HPP
@@ -0,0 +1,276 @@
+#include "behavior_system.hpp"
+#include "../entity/base_entity.hpp"
+#include "../jobs/job_system.hpp"
+#include <cmath>
+
+namespace {
+
+// entities per job; a step's worth of spin/bob is tiny, so chunks are big
+constexpr size_t kBodyGrain = 512;
+
+constexpr double kTwoPi = 6.283185307179586;
+
+bool SameTransform(const Transform& a, const Transform& b) {
+    return a.position == b.position && a.rotation == b.rotation && a.scale == b.scale;
+}
+
+} // namespace
+
+//
+// === Behavior ===
+//
+Behavior Behavior::Spin(const glm::vec3& degreesPerSecond) {
+    Behavior behavior;
+    behavior.type = Type::Spin;
+    behavior.vector = degreesPerSecond;
+    return behavior;
+}
+
+Behavior Behavior::Bob(const glm::vec3& offset, float frequency, float phase) {
+    Behavior behavior;
+    behavior.type = Type::Bob;
+    behavior.vector = offset;
+    behavior.frequency = frequency;
+    behavior.phase = phase;
+    return behavior;
+}
+
+Behavior Behavior::ParamWave(std::string_view param, float base, float amplitude, float frequency, float phase) {
+    Behavior behavior;
+    behavior.type = Type::ParamWave;
+    behavior.param = ParamKey::Intern(param);
+    behavior.base = base;
+    behavior.amplitude = amplitude;
+    behavior.frequency = frequency;
+    behavior.phase = phase;
+    return behavior;
+}
+
+Behavior Behavior::Custom(std::function<void(EntityHandle, float)> callback) {
+    Behavior behavior;
+    behavior.type = Type::Custom;
+    behavior.callback = std::move(callback);
+    return behavior;
+}
+
+//
+// === BehaviorSystem ===
+//
+void BehaviorSystem::Add(EntityHandle handle, Behavior behavior) {
+    if (stepping_)
+        pending_.emplace_back(handle, std::move(behavior));
+    else
+        AddNow(handle, std::move(behavior));
+}
+
+size_t BehaviorSystem::Remove(EntityHandle handle) {
+    if (!stepping_)
+        return RemoveNow(handle);
+
+    pending_.emplace_back(handle, std::nullopt);
+    uint32_t index = handle.index < bodyOfSlot_.size() ? bodyOfSlot_[handle.index] : kNone;
+    return index != kNone && bodies_[index].handle == handle ? bodies_[index].behaviors.size() : 0;
+}
+
+void BehaviorSystem::Clear() {
+    bodies_.clear();
+    bodyOfSlot_.clear();
+    pending_.clear();
+    behaviorCount_ = 0;
+}
+
+void BehaviorSystem::AddNow(EntityHandle handle, Behavior behavior) {
+    if (handle.index >= bodyOfSlot_.size())
+        bodyOfSlot_.resize(handle.index + 1, kNone);
+
+    uint32_t& index = bodyOfSlot_[handle.index];
+    // a body left over from an earlier entity in the same slot goes first
+    if (index != kNone && !(bodies_[index].handle == handle))
+        RemoveBody(index);
+    if (index == kNone) {
+        index = static_cast<uint32_t>(bodies_.size());
+        bodies_.emplace_back();
+        bodies_.back().handle = handle;
+    }
+
+    Body& body = bodies_[index];
+    body.hasCustom = body.hasCustom || behavior.type == Behavior::Type::Custom;
+    body.behaviors.push_back(std::move(behavior));
+    ++behaviorCount_;
+}
+
+size_t BehaviorSystem::RemoveNow(EntityHandle handle) {
+    if (handle.index >= bodyOfSlot_.size())
+        return 0;
+    uint32_t index = bodyOfSlot_[handle.index];
+    if (index == kNone || !(bodies_[index].handle == handle))
+        return 0;
+    size_t count = bodies_[index].behaviors.size();
+    RemoveBody(index);
+    return count;
+}
+
+// Swap with the last body, like the store's dense columns.
+void BehaviorSystem::RemoveBody(uint32_t index) {
+    behaviorCount_ -= bodies_[index].behaviors.size();
+    bodyOfSlot_[bodies_[index].handle.index] = kNone;
+    if (index + 1 != bodies_.size()) {
+        bodies_[index] = std::move(bodies_.back());
+        bodyOfSlot_[bodies_[index].handle.index] = index;
+    }
+    bodies_.pop_back();
+}
+
+void BehaviorSystem::Adopt(const EntityStore& store, Body& body) {
+    const Transform& stored = store.GetTransform(body.handle);
+    if (body.synced && SameTransform(stored, body.presented))
+        return;
+    body.previous = body.current = body.presented = stored;
+    body.synced = true;
+}
+
+//
+// Runs on a worker: reads and writes nothing but the body.
+//
+void BehaviorSystem::Simulate(Body& body, float step) const {
+    body.previous = body.current;
+    body.writes.clear();
+
+    const double t0 = time_;
+    const double t1 = time_ + step;
+    for (uint32_t k = 0; k < body.behaviors.size(); ++k) {
+        const Behavior& behavior = body.behaviors[k];
+        switch (behavior.type) {
+        case Behavior::Type::Spin:
+            body.current.rotation += behavior.vector * step;
+            break;
+        case Behavior::Type::Bob: {
+            // the change of the offset over the step, so bobbing stacks with other motion
+            double w = kTwoPi * behavior.frequency;
+            auto delta = static_cast<float>(std::sin(w * t1 + behavior.phase) - std::sin(w * t0 + behavior.phase));
+            body.current.position += behavior.vector * delta;
+            break;
+        }
+        case Behavior::Type::ParamWave: {
+            double w = kTwoPi * behavior.frequency;
+            auto value = static_cast<float>(behavior.base + behavior.amplitude * std::sin(w * t1 + behavior.phase));
+            body.writes.push_back({k, value});
+            break;
+        }
+        case Behavior::Type::Custom:
+            break;
+        }
+    }
+
+    // keep spinning angles small; previous moves along so the blend doesn't jump
+    for (int axis = 0; axis < 3; ++axis) {
+        float angle = body.current.rotation[axis];
+        if (std::abs(angle) < 3600.0f)
+            continue;
+        float turns = 360.0f * std::trunc(angle / 360.0f);
+        body.current.rotation[axis] -= turns;
+        body.previous.rotation[axis] -= turns;
+    }
+}
+
+void BehaviorSystem::ApplyWrites(EntityStore& store, Body& body) {
+    BaseEntity& entity = *store.GetEntity(body.handle);
+    for (size_t w = 0; w < body.writes.size(); ++w) {
+        ParamKey key = body.behaviors[body.writes[w].behavior].param;
+        bool overwritten = false;
+        for (size_t later = w + 1; later < body.writes.size() && !overwritten; ++later)
+            overwritten = body.behaviors[body.writes[later].behavior].param == key;
+        if (overwritten) {
+            ++conflicts_;
+            continue;
+        }
+
+        // int params stay int, like the console's /set
+        float value = body.writes[w].value;
+        if (entity.Params().TypeOf(key) == ParamType::Int)
+            entity.Params().Set(key, static_cast<int>(std::lround(value)));
+        else
+            entity.Params().Set(key, value);
+    }
+    // uniforms and lights follow at the next param sync (ParamBinder)
+}
+
+void BehaviorSystem::Step(EntityStore& store, float step) {
+    // entities that are gone lose their behaviors
+    for (uint32_t b = 0; b < bodies_.size();) {
+        if (store.Contains(bodies_[b].handle))
+            ++b;
+        else
+            RemoveBody(b);
+    }
+
+    // the store is only read until the chunks are done
+    stepping_ = true;
+    const EntityStore& source = store;
+    JobSystem::Instance().ParallelFor(bodies_.size(), kBodyGrain, [this, &source, step](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            Adopt(source, bodies_[b]);
+            Simulate(bodies_[b], step);
+        }
+    });
+
+    for (Body& body : bodies_) {
+        if (!body.writes.empty())
+            ApplyWrites(store, body);
+    }
+    time_ += step;
+
+    // Custom callbacks may do anything to the world, Clear() included, so
+    // bounds are rechecked and the callback copied before it's called.
+    // Stepping on a worker (pipelined frames) queues them for the main thread.
+    JobSystem& jobs = JobSystem::Instance();
+    for (size_t b = 0; b < bodies_.size(); ++b) {
+        if (!bodies_[b].hasCustom)
+            continue;
+        for (size_t k = 0; b < bodies_.size() && k < bodies_[b].behaviors.size(); ++k) {
+            const Behavior& behavior = bodies_[b].behaviors[k];
+            if (behavior.type != Behavior::Type::Custom || !store.Contains(bodies_[b].handle))
+                continue;
+            auto callback = behavior.callback;
+            if (jobs.IsMainThread())
+                callback(bodies_[b].handle, step);
+            else
+                jobs.ScheduleOnMainThread([callback, handle = bodies_[b].handle, step]() { callback(handle, step); });
+        }
+    }
+    stepping_ = false;
+
+    for (auto& [handle, behavior] : pending_) {
+        if (behavior)
+            AddNow(handle, std::move(*behavior));
+        else
+            RemoveNow(handle);
+    }
+    pending_.clear();
+}
+
+void BehaviorSystem::Present(EntityStore& store, float alpha) {
+    // blend in parallel, then write back what moved here: marking dirty isn't thread safe
+    const EntityStore& source = store;
+    JobSystem::Instance().ParallelFor(bodies_.size(), kBodyGrain, [this, &source, alpha](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            Body& body = bodies_[b];
+            body.moved = false;
+            if (!source.Contains(body.handle))
+                continue;
+            Adopt(source, body);
+
+            Transform blended;
+            blended.position = glm::mix(body.previous.position, body.current.position, alpha);
+            blended.rotation = glm::mix(body.previous.rotation, body.current.rotation, alpha);
+            blended.scale = glm::mix(body.previous.scale, body.current.scale, alpha);
+            body.moved = !SameTransform(blended, body.presented);
+            body.presented = blended;
+        }
+    });
+
+    for (const Body& body : bodies_) {
+        if (body.moved)
+            store.SetTransform(body.handle, body.presented);
+    }
+}
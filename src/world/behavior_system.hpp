@@ -0,0 +1,114 @@
+#ifndef BEHAVIOR_SYSTEM_HPP
+#define BEHAVIOR_SYSTEM_HPP
+
+#include "../entity/entity_store.hpp"
+#include "../entity/param_key.hpp"
+#include "../entity/transform.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//
+// === Behavior ===
+// Per entity logic run every fixed step. Spin, Bob and ParamWave are plain
+// data evaluated in parallel; Custom calls back on the main thread after
+// them, so it may touch anything (console scripts use it). When the step
+// itself runs on a worker, Custom waits for the next RunMainThreadJobs().
+//
+struct Behavior {
+    enum class Type { Spin, Bob, ParamWave, Custom };
+
+    Type type = Type::Spin;
+    glm::vec3 vector{0.0f};  // Spin: degrees per second per axis; Bob: peak offset
+    float frequency = 1.0f;  // Bob, ParamWave: cycles per second
+    float base = 0.0f;       // ParamWave: base + amplitude * sin(...)
+    float amplitude = 0.0f;  // ParamWave
+    float phase = 0.0f;      // Bob, ParamWave: radians
+    ParamKey param;          // ParamWave
+    std::function<void(EntityHandle, float)> callback; // Custom: (entity, step)
+
+    static Behavior Spin(const glm::vec3& degreesPerSecond);
+    static Behavior Bob(const glm::vec3& offset, float frequency, float phase = 0.0f);
+    static Behavior ParamWave(std::string_view param, float base, float amplitude, float frequency, float phase = 0.0f);
+    static Behavior Custom(std::function<void(EntityHandle, float)> callback);
+};
+
+//
+// === BehaviorSystem ===
+// Fixed step simulation of the entities that have behaviors. Each step
+// runs the parallel behaviors on the JobSystem in chunks of entities. An
+// entity's behaviors always run together and in order on a private copy
+// of its transform, so behaviors never race each other. Spin and Bob add
+// a delta per step and stack. Param writes are buffered and applied on
+// the calling thread once the chunks are done; the same param written
+// twice by one entity in a step counts as a conflict, and the later
+// behavior wins.
+//
+// The store only sees Present(): the last two simulated transforms
+// blended by how far the frame is into the next step. A transform that
+// changed in the store since then (console, picking, scripts) is taken
+// over as the new simulation state.
+//
+class BehaviorSystem {
+  public:
+    void Add(EntityHandle handle, Behavior behavior);
+    // Drops all behaviors of the entity; returns how many it had.
+    size_t Remove(EntityHandle handle);
+    void Clear();
+
+    void Step(EntityStore& store, float step);
+    // alpha in [0, 1]: 0 is the previous step, 1 the latest.
+    void Present(EntityStore& store, float alpha);
+
+    [[nodiscard]] size_t GetEntityCount() const { return bodies_.size(); }
+    [[nodiscard]] size_t GetBehaviorCount() const { return behaviorCount_; }
+    // Params written twice in one step by one entity, since the start.
+    [[nodiscard]] size_t GetConflictCount() const { return conflicts_; }
+    // Simulated seconds.
+    [[nodiscard]] double GetTime() const { return time_; }
+
+  private:
+    static constexpr uint32_t kNone = ~0u;
+
+    struct ParamWrite {
+        uint32_t behavior;
+        float value;
+    };
+
+    struct Body {
+        EntityHandle handle;
+        Transform previous;
+        Transform current;
+        Transform presented; // last written to the store
+        std::vector<Behavior> behaviors;
+        std::vector<ParamWrite> writes;
+        bool hasCustom = false;
+        bool synced = false; // presented matches the store
+        bool moved = false;  // presented changed in the last Present()
+    };
+
+    void AddNow(EntityHandle handle, Behavior behavior);
+    size_t RemoveNow(EntityHandle handle);
+    void RemoveBody(uint32_t index);
+    // Store was edited behind the simulation's back: start over from there.
+    static void Adopt(const EntityStore& store, Body& body);
+    void Simulate(Body& body, float step) const;
+    void ApplyWrites(EntityStore& store, Body& body);
+
+    std::vector<Body> bodies_;
+    // body per entity slot index, kNone if it has no behaviors
+    std::vector<uint32_t> bodyOfSlot_;
+    size_t behaviorCount_ = 0;
+    size_t conflicts_ = 0;
+    double time_ = 0.0;
+
+    // Add/Remove from Custom callbacks wait until the step is over; nullopt removes
+    bool stepping_ = false;
+    std::vector<std::pair<EntityHandle, std::optional<Behavior>>> pending_;
+};
+
+#endif // BEHAVIOR_SYSTEM_HPP
@@ -0,0 +1,67 @@
+#include "param_binder.hpp"
+#include "../entity/base_entity.hpp"
+#include "../entity/light_entity.hpp"
+
+// Text params that pick what the renderable is built from: the mesh, the
+// shader and the textures of its shader's samplers. Anything else (names,
+// tags) leaves it alone.
+bool ParamBinder::IsAssetKey(const BaseEntity& entity, ParamKey key) {
+    if (key == ParamKeys::Mesh || key == ParamKeys::Shader)
+        return true;
+    const std::shared_ptr<Shader>& shader = entity.GetRenderable().GetShader();
+    return shader && shader->HasSampler(key.GetName());
+}
+
+void ParamBinder::OnParamsChanged(std::span<const ParamChange> changes) {
+    rebuild_.clear();
+    for (const ParamChange& change : changes) {
+        if (change.removed || !store_.Contains(change.owner))
+            continue;
+        BaseEntity& entity = *store_.GetEntity(change.owner);
+        const CParams& params = entity.Params();
+        ParamKey key = change.key;
+
+        if (key == ParamKeys::Position || key == ParamKeys::Rotation || key == ParamKeys::Scale) {
+            Transform transform = entity.GetTransform();
+            if (key == ParamKeys::Position)
+                transform.position = params.GetOr(key, transform.position);
+            else if (key == ParamKeys::Rotation)
+                transform.rotation = params.GetOr(key, transform.rotation);
+            else
+                transform.scale = params.GetOr(key, transform.scale);
+            entity.SetTransform(transform);
+            ++stats_.transforms;
+            continue;
+        }
+
+        std::optional<ParamType> type = params.TypeOf(key);
+        if (type == ParamType::String && IsAssetKey(entity, key)) {
+            // changes come grouped by entity, so one look back is enough
+            if (rebuild_.empty() || !(rebuild_.back() == change.owner))
+                rebuild_.push_back(change.owner);
+            continue;
+        }
+
+        if (key == ParamKeys::Color || key == ParamKeys::Intensity || key == ParamKeys::Radius) {
+            if (auto light = dynamic_cast<LightEntity*>(&entity)) {
+                light->UpdateLightFromParams();
+                ++stats_.lights;
+            }
+        }
+
+        // a shader uniform of the same name follows, so /set and waves are visible
+        CParams& uniforms = entity.GetRenderable().Params();
+        if (type && uniforms.Has(key)) {
+            if (auto value = params.Get(key))
+                uniforms.Set(key, *value);
+            ++stats_.uniforms;
+        }
+    }
+
+    for (EntityHandle handle : rebuild_) {
+        if (store_.Contains(handle)) {
+            store_.GetEntity(handle)->UpdateRenderableFromParams();
+            ++stats_.renderables;
+        }
+    }
+}
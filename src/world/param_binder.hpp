@@ -0,0 +1,44 @@
+#ifndef PARAM_BINDER_HPP
+#define PARAM_BINDER_HPP
+
+#include "../entity/entity_store.hpp"
+#include "../entity/param_sync.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+//
+// === ParamBinder ===
+// Keeps what the world derives from entity params in step with them, from
+// the batches the store's ParamSync hands out:
+//   position / rotation / scale -> that component of the transform only
+//   mesh, shader, sampler names -> renderable rebuilt, once per entity
+//   color / intensity / radius  -> light refreshed
+//   anything the renderable has -> copied into its uniform of that name
+// Runs at the sync point on the main thread, rebuilding a renderable
+// loads GL resources.
+//
+class ParamBinder : public ParamSubscriber {
+  public:
+    struct Stats {
+        size_t transforms = 0;
+        size_t renderables = 0;
+        size_t lights = 0;
+        size_t uniforms = 0;
+    };
+
+    explicit ParamBinder(EntityStore& store) : store_(store) {}
+
+    void OnParamsChanged(std::span<const ParamChange> changes) override;
+
+    [[nodiscard]] const Stats& GetStats() const { return stats_; }
+
+  private:
+    static bool IsAssetKey(const BaseEntity& entity, ParamKey key);
+
+    EntityStore& store_;
+    Stats stats_;
+    std::vector<EntityHandle> rebuild_;
+};
+
+#endif // PARAM_BINDER_HPP
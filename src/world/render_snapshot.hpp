@@ -0,0 +1,116 @@
+#ifndef RENDER_SNAPSHOT_HPP
+#define RENDER_SNAPSHOT_HPP
+
+#include "../entity/base_entity.hpp"
+#include "../rendering/lighting/clustered_lighting.hpp"
+#include "../rendering/mesh/mesh.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+//
+// === RenderSnapshot ===
+// Everything drawing a frame needs, copied out of a World by Extract():
+// camera matrices, lights, the model matrix of every visible entity and a
+// copy of each renderable it draws with (mesh, shader, textures and
+// uniform values). World::Render() reads nothing else, so the world can
+// be simulated on another thread while a snapshot is drawn.
+//
+// Reset() keeps every buffer and the renderable copies of the last frame,
+// so extracting a similar frame doesn't allocate. A copy that is replaced
+// or dropped while holding the last reference to a mesh, shader or texture
+// leaves that reference in released, so the GL object is deleted by the
+// thread calling ReleaseRetired() and never by an Extract() on a worker.
+//
+struct RenderSnapshot {
+    struct Item {
+        glm::mat4 model;
+        uint32_t material;
+    };
+
+    struct Batch {
+        uint32_t material = 0;
+        std::vector<InstanceData> instances;
+    };
+
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 cameraPosition{0.0f};
+    float fov = 45.0f;
+    float aspectRatio = 1.0f;
+
+    std::vector<ClusteredLighting::Source> lights;
+    // drawn one by one, in extraction order
+    std::vector<Item> items;
+    // instanced; entries from batchCount on are spares
+    std::vector<Batch> batches;
+    size_t batchCount = 0;
+    // renderable copies items and batches point at; from materialCount on spares
+    std::vector<Renderable> materials;
+    size_t materialCount = 0;
+    size_t visibleCount = 0;
+    // last references taken from replaced copies, GL thread only releases them
+    std::vector<std::shared_ptr<const void>> released;
+
+    void Reset() {
+        lights.clear();
+        items.clear();
+        for (size_t b = 0; b < batchCount; ++b)
+            batches[b].instances.clear();
+        batchCount = 0;
+        materialCount = 0;
+        visibleCount = 0;
+    }
+
+    uint32_t AddMaterial(const Renderable& renderable) {
+        if (materialCount == materials.size())
+            materials.emplace_back();
+        else
+            Retire(materials[materialCount]);
+        materials[materialCount] = renderable;
+        return static_cast<uint32_t>(materialCount++);
+    }
+
+    // Spare copies from materialCount on, with their last references retired.
+    void TrimMaterials() {
+        for (size_t i = materialCount; i < materials.size(); ++i)
+            Retire(materials[i]);
+        materials.resize(materialCount);
+    }
+
+    // GL thread.
+    void ReleaseRetired() { released.clear(); }
+
+    // Drops copies holding the last reference to a mesh, shader or texture,
+    // so its GL object is deleted here and not by an Extract() on a worker.
+    void ReleaseUnshared() {
+        for (Renderable& material : materials) {
+            bool unshared = material.GetMesh().use_count() == 1 || material.GetShader().use_count() == 1;
+            for (const auto& [sampler, texture] : material.GetTextures())
+                unshared = unshared || texture.use_count() == 1;
+            if (unshared)
+                material = Renderable();
+        }
+    }
+
+    uint32_t AddBatch(uint32_t material) {
+        if (batchCount == batches.size())
+            batches.emplace_back();
+        batches[batchCount].material = material;
+        return static_cast<uint32_t>(batchCount++);
+    }
+
+  private:
+    void Retire(const Renderable& material) {
+        if (material.GetMesh().use_count() == 1)
+            released.push_back(material.GetMesh());
+        if (material.GetShader().use_count() == 1)
+            released.push_back(material.GetShader());
+        for (const auto& [sampler, texture] : material.GetTextures()) {
+            if (texture.use_count() == 1)
+                released.push_back(texture);
+        }
+    }
+};
+
+#endif // RENDER_SNAPSHOT_HPP
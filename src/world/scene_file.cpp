@@ -0,0 +1,635 @@
+#include "scene_file.hpp"
+#include "world.hpp"
+#include "../entity/light_entity.hpp"
+#include "../io/atomic_file.hpp"
+#include "../io/mapped_file.hpp"
+#include "../rendering/loaders/texture_loader.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// records are read in place from the mapping
+static_assert(std::is_trivially_copyable_v<SceneFile::EntityRecord> && sizeof(SceneFile::EntityRecord) == 40);
+static_assert(std::is_trivially_copyable_v<SceneFile::ParamRecord> && sizeof(SceneFile::ParamRecord) == 12);
+static_assert(std::is_trivially_copyable_v<SceneFile::AssetRecord> && sizeof(SceneFile::AssetRecord) == 8);
+static_assert(std::is_trivially_copyable_v<Transform> && sizeof(Transform) == 9 * sizeof(float));
+
+namespace SceneFile {
+
+namespace {
+
+constexpr size_t kSectionCount = static_cast<size_t>(Section::Count);
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + 15) & ~uint64_t(15);
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const char* AssetKindName(AssetKind kind) {
+    switch (kind) {
+    case AssetKind::Mesh: return "mesh";
+    case AssetKind::Shader: return "shader";
+    case AssetKind::Texture: return "texture";
+    }
+    return "unknown";
+}
+
+const char* ParamTypeName(ParamType type) {
+    switch (type) {
+    case ParamType::Int: return "int";
+    case ParamType::Float: return "float";
+    case ParamType::Bool: return "bool";
+    case ParamType::Vec2: return "vec2";
+    case ParamType::Vec3: return "vec3";
+    case ParamType::Vec4: return "vec4";
+    case ParamType::Mat4: return "mat4";
+    case ParamType::String: return "string";
+    }
+    return "unknown";
+}
+
+struct TextHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+};
+
+//
+// === Writing ===
+// Everything is gathered into the section arrays first so the offsets are
+// known, then written front to back.
+//
+class SceneWriter {
+  public:
+    uint32_t AddString(std::string_view text) {
+        auto it = stringIds_.find(text);
+        if (it != stringIds_.end())
+            return it->second;
+        auto id = static_cast<uint32_t>(stringOffsets_.size());
+        stringOffsets_.push_back(static_cast<uint32_t>(stringData_.size()));
+        stringData_.append(text);
+        // keyed by the text's own copy, stringData_ may move
+        stringIds_.emplace(std::string(text), id);
+        return id;
+    }
+
+    uint32_t AddAsset(AssetKind kind, std::string_view name) {
+        uint32_t nameId = AddString(name);
+        auto [it, added] = assetIds_.try_emplace({static_cast<uint32_t>(kind), nameId},
+                                                 static_cast<uint32_t>(assets.size()));
+        if (added)
+            assets.push_back({static_cast<uint32_t>(kind), nameId});
+        return it->second;
+    }
+
+    // Appends params as one run, returns where it starts.
+    uint32_t AddParams(const CParams& source) {
+        auto begin = static_cast<uint32_t>(params.size());
+        for (const CParams::Entry& entry : source.All()) {
+            ParamRecord record{AddString(entry.key.GetName()), static_cast<uint32_t>(entry.GetType()),
+                               static_cast<uint32_t>(words.size())};
+            switch (entry.GetType()) {
+            case ParamType::Int: AddWords(source.Read<int>(entry)); break;
+            case ParamType::Float: AddWords(source.Read<float>(entry)); break;
+            case ParamType::Bool: AddWords(source.Read<bool>(entry) ? 1u : 0u); break;
+            case ParamType::Vec2: AddWords(source.Read<glm::vec2>(entry)); break;
+            case ParamType::Vec3: AddWords(source.Read<glm::vec3>(entry)); break;
+            case ParamType::Vec4: AddWords(source.Read<glm::vec4>(entry)); break;
+            case ParamType::Mat4: AddWords(source.Read<glm::mat4>(entry)); break;
+            case ParamType::String: record.value = AddString(source.ReadString(entry)); break;
+            }
+            params.push_back(record);
+        }
+        return begin;
+    }
+
+    // Appends an entity and its transform, returns its record index.
+    uint32_t AddEntity(std::string_view name, uint32_t parent, uint32_t flags, const Transform& transform,
+                       const CParams& params, const CParams& renderParams) {
+        EntityRecord record{};
+        record.name = AddString(name);
+        record.parent = parent;
+        record.flags = flags;
+        record.paramCount = static_cast<uint32_t>(params.Size());
+        record.paramBegin = AddParams(params);
+        record.renderParamCount = static_cast<uint32_t>(renderParams.Size());
+        record.renderParamBegin = AddParams(renderParams);
+
+        std::string_view mesh = params.GetString(ParamKeys::Mesh).value_or("");
+        std::string_view shader = params.GetString(ParamKeys::Shader).value_or("");
+        record.mesh = mesh.empty() ? kNone : AddAsset(AssetKind::Mesh, mesh);
+        record.shader = shader.empty() ? kNone : AddAsset(AssetKind::Shader, shader);
+
+        entities.push_back(record);
+        transforms.push_back(transform);
+        return static_cast<uint32_t>(entities.size() - 1);
+    }
+
+    // Returns the file size, 0 if it couldn't be written.
+    uint64_t Write(const std::string& path) {
+        stringOffsets_.push_back(static_cast<uint32_t>(stringData_.size()));
+
+        SceneHeader header{};
+        std::memcpy(header.magic, kMagic, 4);
+        header.version = kVersion;
+        header.entityCount = static_cast<uint32_t>(entities.size());
+        header.stringCount = static_cast<uint32_t>(stringOffsets_.size() - 1);
+        header.paramCount = static_cast<uint32_t>(params.size());
+        header.wordCount = static_cast<uint32_t>(words.size());
+        header.assetCount = static_cast<uint32_t>(assets.size());
+        header.sectionCount = static_cast<uint32_t>(kSectionCount);
+
+        uint64_t sizes[kSectionCount] = {
+            stringOffsets_.size() * sizeof(uint32_t) + stringData_.size(), entities.size() * sizeof(EntityRecord),
+            transforms.size() * sizeof(Transform), params.size() * sizeof(ParamRecord),
+            words.size() * sizeof(uint32_t), assets.size() * sizeof(AssetRecord)};
+        uint64_t offset = AlignUp(sizeof(SceneHeader));
+        for (size_t s = 0; s < kSectionCount; ++s) {
+            header.sections[s] = {offset, sizes[s]};
+            offset = AlignUp(offset + sizes[s]);
+        }
+
+        auto file = AtomicFile::Create(path);
+        if (!file)
+            return 0;
+        position_ = 0;
+        Put(*file, &header, sizeof(header));
+        PadTo(*file, header.sections[0].offset);
+        Put(*file, stringOffsets_.data(), stringOffsets_.size() * sizeof(uint32_t));
+        Put(*file, stringData_.data(), stringData_.size());
+        const std::pair<const void*, uint64_t> arrays[] = {
+            {entities.data(), sizes[1]}, {transforms.data(), sizes[2]}, {params.data(), sizes[3]},
+            {words.data(), sizes[4]}, {assets.data(), sizes[5]}};
+        for (size_t s = 1; s < kSectionCount; ++s) {
+            PadTo(*file, header.sections[s].offset);
+            Put(*file, arrays[s - 1].first, arrays[s - 1].second);
+        }
+        return file->Commit() ? file->GetSize() : 0;
+    }
+
+    std::vector<EntityRecord> entities;
+    std::vector<Transform> transforms;
+    std::vector<ParamRecord> params;
+    std::vector<uint32_t> words;
+    std::vector<AssetRecord> assets;
+
+  private:
+    template <typename T> void AddWords(const T& value) {
+        static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+        size_t at = words.size();
+        words.resize(at + sizeof(T) / sizeof(uint32_t));
+        std::memcpy(words.data() + at, static_cast<const void*>(&value), sizeof(T));
+    }
+
+    // AtomicFile stops writing after the first failure, Commit() reports it
+    void Put(AtomicFile& file, const void* data, uint64_t size) {
+        file.Write(data, size);
+        position_ += size;
+    }
+
+    void PadTo(AtomicFile& file, uint64_t offset) {
+        static constexpr char kZeros[16] = {};
+        Put(file, kZeros, offset - position_);
+    }
+
+    std::vector<uint32_t> stringOffsets_;
+    std::string stringData_;
+    std::unordered_map<std::string, uint32_t, TextHash, std::equal_to<>> stringIds_;
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> assetIds_;
+    uint64_t position_ = 0;
+};
+
+//
+// === Reading ===
+// Typed views into the mapping, checked once so the loader and the export
+// index them without further bounds checks.
+//
+class SceneView {
+  public:
+    bool Open(const MappedFile& file, std::string& error) {
+        if (file.Size() < sizeof(SceneHeader))
+            return Fail(error, "too small");
+        std::memcpy(&header_, file.Data(), sizeof(header_));
+        if (std::memcmp(header_.magic, kMagic, 4) != 0)
+            return Fail(error, "not a scene file");
+        if (header_.version != kVersion)
+            return Fail(error, "version " + std::to_string(header_.version) + ", expected " +
+                                   std::to_string(kVersion));
+        if (header_.sectionCount != kSectionCount)
+            return Fail(error, "bad section count");
+        for (const SceneSection& section : header_.sections) {
+            if (section.offset % 16 != 0 || section.offset > file.Size() || section.size > file.Size() - section.offset)
+                return Fail(error, "section out of bounds");
+        }
+
+        const unsigned char* base = file.Data();
+        auto at = [&](Section s) { return base + header_.sections[static_cast<size_t>(s)].offset; };
+        auto size = [&](Section s) { return header_.sections[static_cast<size_t>(s)].size; };
+        if (size(Section::Strings) < (uint64_t(header_.stringCount) + 1) * sizeof(uint32_t) ||
+            size(Section::Entities) < uint64_t(header_.entityCount) * sizeof(EntityRecord) ||
+            size(Section::Transforms) < uint64_t(header_.entityCount) * sizeof(Transform) ||
+            size(Section::Params) < uint64_t(header_.paramCount) * sizeof(ParamRecord) ||
+            size(Section::Words) < uint64_t(header_.wordCount) * sizeof(uint32_t) ||
+            size(Section::Assets) < uint64_t(header_.assetCount) * sizeof(AssetRecord))
+            return Fail(error, "section too small");
+
+        // sections are 16 byte aligned in a page aligned mapping
+        stringOffsets_ = reinterpret_cast<const uint32_t*>(at(Section::Strings));
+        stringData_ = reinterpret_cast<const char*>(stringOffsets_ + header_.stringCount + 1);
+        entities_ = reinterpret_cast<const EntityRecord*>(at(Section::Entities));
+        transforms_ = reinterpret_cast<const Transform*>(at(Section::Transforms));
+        params_ = reinterpret_cast<const ParamRecord*>(at(Section::Params));
+        words_ = reinterpret_cast<const uint32_t*>(at(Section::Words));
+        assets_ = reinterpret_cast<const AssetRecord*>(at(Section::Assets));
+
+        uint64_t characters = size(Section::Strings) - (uint64_t(header_.stringCount) + 1) * sizeof(uint32_t);
+        for (uint32_t i = 0; i < header_.stringCount; ++i) {
+            if (stringOffsets_[i] > stringOffsets_[i + 1])
+                return Fail(error, "bad string table");
+        }
+        if (stringOffsets_[header_.stringCount] > characters)
+            return Fail(error, "bad string table");
+
+        for (uint32_t i = 0; i < header_.paramCount; ++i) {
+            const ParamRecord& param = params_[i];
+            if (param.key >= header_.stringCount || param.type > static_cast<uint32_t>(ParamType::String))
+                return Fail(error, "bad param " + std::to_string(i));
+            auto type = static_cast<ParamType>(param.type);
+            bool fits = type == ParamType::String
+                            ? param.value < header_.stringCount
+                            : uint64_t(param.value) + ParamWordCount(type) <= header_.wordCount;
+            if (!fits)
+                return Fail(error, "bad param value " + std::to_string(i));
+        }
+        for (uint32_t i = 0; i < header_.assetCount; ++i) {
+            if (assets_[i].name >= header_.stringCount || assets_[i].kind > static_cast<uint32_t>(AssetKind::Texture))
+                return Fail(error, "bad asset " + std::to_string(i));
+        }
+        for (uint32_t i = 0; i < header_.entityCount; ++i) {
+            const EntityRecord& entity = entities_[i];
+            bool ok = entity.name < header_.stringCount && (entity.parent == kNone || entity.parent < i) &&
+                      uint64_t(entity.paramBegin) + entity.paramCount <= header_.paramCount &&
+                      uint64_t(entity.renderParamBegin) + entity.renderParamCount <= header_.paramCount &&
+                      (entity.mesh == kNone || entity.mesh < header_.assetCount) &&
+                      (entity.shader == kNone || entity.shader < header_.assetCount);
+            if (!ok)
+                return Fail(error, "bad entity " + std::to_string(i));
+        }
+        return true;
+    }
+
+    [[nodiscard]] const SceneHeader& Header() const { return header_; }
+    [[nodiscard]] std::string_view String(uint32_t id) const {
+        return {stringData_ + stringOffsets_[id], stringOffsets_[id + 1] - stringOffsets_[id]};
+    }
+    [[nodiscard]] const EntityRecord& Entity(uint32_t i) const { return entities_[i]; }
+    [[nodiscard]] const Transform& GetTransform(uint32_t i) const { return transforms_[i]; }
+    [[nodiscard]] const ParamRecord& Param(uint32_t i) const { return params_[i]; }
+    [[nodiscard]] const AssetRecord& Asset(uint32_t i) const { return assets_[i]; }
+
+    template <typename T> [[nodiscard]] T Read(const ParamRecord& param) const {
+        T value;
+        std::memcpy(static_cast<void*>(&value), words_ + param.value, sizeof(T));
+        return value;
+    }
+
+  private:
+    static bool Fail(std::string& error, std::string message) {
+        error = std::move(message);
+        return false;
+    }
+
+    SceneHeader header_{};
+    const uint32_t* stringOffsets_ = nullptr;
+    const char* stringData_ = nullptr;
+    const EntityRecord* entities_ = nullptr;
+    const Transform* transforms_ = nullptr;
+    const ParamRecord* params_ = nullptr;
+    const uint32_t* words_ = nullptr;
+    const AssetRecord* assets_ = nullptr;
+};
+
+// Sets a run of params on target; keys are interned once per file string.
+void LoadParams(const SceneView& view, uint32_t begin, uint32_t count, std::vector<ParamKey>& keys, CParams& target) {
+    for (uint32_t i = begin; i < begin + count; ++i) {
+        const ParamRecord& param = view.Param(i);
+        ParamKey& key = keys[param.key];
+        if (!key.IsValid())
+            key = ParamKey::Intern(view.String(param.key));
+        switch (static_cast<ParamType>(param.type)) {
+        case ParamType::Int: target.Set(key, view.Read<int>(param)); break;
+        case ParamType::Float: target.Set(key, view.Read<float>(param)); break;
+        case ParamType::Bool: target.Set(key, view.Read<uint32_t>(param) != 0); break;
+        case ParamType::Vec2: target.Set(key, view.Read<glm::vec2>(param)); break;
+        case ParamType::Vec3: target.Set(key, view.Read<glm::vec3>(param)); break;
+        case ParamType::Vec4: target.Set(key, view.Read<glm::vec4>(param)); break;
+        case ParamType::Mat4: target.Set(key, view.Read<glm::mat4>(param)); break;
+        case ParamType::String: target.Set(key, std::string(view.String(param.value))); break;
+        }
+    }
+}
+
+// Shortest text that reads back to the same float, so diffs show real changes.
+void ExportFloat(std::ostream& out, float value) {
+    char text[32];
+    std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+    out << ' ' << std::string_view(text, static_cast<size_t>(result.ptr - text));
+}
+
+void ExportVec3(std::ostream& out, const glm::vec3& value) {
+    for (int i = 0; i < 3; ++i)
+        ExportFloat(out, value[i]);
+}
+
+void ExportParams(std::ostream& out, const SceneView& view, const char* label, uint32_t begin, uint32_t count) {
+    for (uint32_t i = begin; i < begin + count; ++i) {
+        const ParamRecord& param = view.Param(i);
+        auto type = static_cast<ParamType>(param.type);
+        out << "  " << label << ' ' << view.String(param.key) << ' ' << ParamTypeName(type);
+        if (type == ParamType::String) {
+            out << " \"" << view.String(param.value) << "\"\n";
+            continue;
+        }
+        if (type == ParamType::Int) {
+            out << ' ' << view.Read<int>(param) << '\n';
+            continue;
+        }
+        if (type == ParamType::Bool) {
+            out << ' ' << (view.Read<uint32_t>(param) != 0 ? "true" : "false") << '\n';
+            continue;
+        }
+        // vectors and matrices are floats word by word
+        ParamRecord word = param;
+        for (uint32_t w = 0; w < ParamWordCount(type); ++w, ++word.value)
+            ExportFloat(out, view.Read<float>(word));
+        out << '\n';
+    }
+}
+
+} // namespace
+
+bool Save(World& world, const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    const EntityStore& store = world.GetStore();
+    EntityHandle root = world.GetRoot()->GetHandle();
+
+    SceneWriter writer;
+    writer.entities.reserve(store.Size());
+    writer.transforms.reserve(store.Size());
+    // record index per entity slot, to point children at their parent
+    std::unordered_map<uint32_t, uint32_t> recordOfSlot;
+    store.Traverse([&](EntityHandle handle, int) {
+        if (handle == root)
+            return;
+        const BaseEntity& entity = *store.GetEntity(handle);
+        EntityHandle parent = store.GetParent(handle);
+        auto it = parent.IsValid() ? recordOfSlot.find(parent.index) : recordOfSlot.end();
+        uint32_t flags = dynamic_cast<const LightEntity*>(&entity) ? kLightFlag : 0;
+        recordOfSlot[handle.index] =
+            writer.AddEntity(entity.GetName(), it != recordOfSlot.end() ? it->second : kNone, flags,
+                             store.GetTransform(handle), entity.Params(), entity.GetRenderable().Params());
+        // textures are named by the param of their sampler
+        for (const auto& [sampler, texture] : entity.GetRenderable().GetTextures()) {
+            std::string_view name = entity.Params().GetString(ParamKey::Find(sampler)).value_or("");
+            if (!name.empty())
+                writer.AddAsset(AssetKind::Texture, name);
+        }
+    });
+
+    uint64_t bytes = writer.Write(path);
+    if (bytes == 0) {
+        std::cerr << "[SCENE][WARN] Could not write " << path << std::endl;
+        return false;
+    }
+    std::cout << "[SCENE] Saved " << writer.entities.size() << " entities to " << path << " (" << bytes
+              << " bytes, " << std::fixed << std::setprecision(2) << MillisecondsSince(start) << " ms)" << std::endl;
+    return true;
+}
+
+std::shared_ptr<const EntitySnapshot> CaptureEntity(const World& world, EntityHandle handle) {
+    const EntityStore& store = world.GetStore();
+    const BaseEntity& entity = *store.GetEntity(handle);
+    auto snapshot = std::make_shared<EntitySnapshot>();
+    snapshot->handle = handle;
+    EntityHandle parent = store.GetParent(handle);
+    snapshot->parent = parent.IsValid() && parent != world.GetRoot()->GetHandle() ? parent.index : kNone;
+    snapshot->flags = dynamic_cast<const LightEntity*>(&entity) ? kLightFlag : 0;
+    snapshot->name = entity.GetName();
+    // copies allocate from the default resource, not the world's arena
+    snapshot->params = entity.Params();
+    snapshot->renderParams = entity.GetRenderable().Params();
+    for (const auto& [sampler, texture] : entity.GetRenderable().GetTextures()) {
+        std::string_view name = entity.Params().GetString(ParamKey::Find(sampler)).value_or("");
+        if (!name.empty())
+            snapshot->textures.emplace_back(name);
+    }
+    return snapshot;
+}
+
+std::shared_ptr<const std::vector<Transform>> CaptureTransforms(const World& world, const SnapshotBlock& block) {
+    const EntityStore& store = world.GetStore();
+    auto transforms = std::make_shared<std::vector<Transform>>();
+    transforms->reserve(block.entities.size());
+    for (const auto& entity : block.entities)
+        transforms->push_back(store.GetTransform(entity->handle));
+    return transforms;
+}
+
+uint64_t Write(const Snapshot& snapshot, const std::string& path) {
+    // entities by slot, then parents before children as Load expects
+    size_t slotCount = snapshot.blocks.size() * EntityStore::kStampBlock;
+    std::vector<const EntitySnapshot*> entities(slotCount, nullptr);
+    std::vector<const Transform*> transforms(slotCount, nullptr);
+    size_t entityCount = 0;
+    for (size_t b = 0; b < snapshot.blocks.size(); ++b) {
+        const SnapshotBlock& block = *snapshot.blocks[b];
+        for (size_t i = 0; i < block.entities.size(); ++i) {
+            uint32_t slot = block.entities[i]->handle.index;
+            entities[slot] = block.entities[i].get();
+            transforms[slot] = &(*snapshot.transforms[b])[i];
+        }
+        entityCount += block.entities.size();
+    }
+
+    // children as linked lists, in slot order
+    std::vector<uint32_t> firstChild(slotCount, kNone);
+    std::vector<uint32_t> nextSibling(slotCount, kNone);
+    std::vector<uint32_t> stack;
+    for (size_t slot = slotCount; slot-- > 0;) {
+        if (!entities[slot])
+            continue;
+        uint32_t parent = entities[slot]->parent;
+        if (parent != kNone && parent < slotCount && entities[parent]) {
+            nextSibling[slot] = firstChild[parent];
+            firstChild[parent] = static_cast<uint32_t>(slot);
+        } else {
+            stack.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+
+    SceneWriter writer;
+    writer.entities.reserve(entityCount);
+    writer.transforms.reserve(entityCount);
+    std::vector<uint32_t> recordOfSlot(slotCount, kNone);
+    while (!stack.empty()) {
+        uint32_t slot = stack.back();
+        stack.pop_back();
+        const EntitySnapshot& entity = *entities[slot];
+        uint32_t parent = entity.parent != kNone && entity.parent < slotCount ? recordOfSlot[entity.parent] : kNone;
+        recordOfSlot[slot] = writer.AddEntity(entity.name, parent, entity.flags, *transforms[slot], entity.params,
+                                              entity.renderParams);
+        for (const std::string& texture : entity.textures)
+            writer.AddAsset(AssetKind::Texture, texture);
+        // pushed last to first so the first child comes out next
+        size_t mark = stack.size();
+        for (uint32_t child = firstChild[slot]; child != kNone; child = nextSibling[child])
+            stack.push_back(child);
+        std::reverse(stack.begin() + static_cast<std::ptrdiff_t>(mark), stack.end());
+    }
+    return writer.Write(path);
+}
+
+bool Load(World& world, const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    auto file = MappedFile::Open(path);
+    if (!file) {
+        std::cerr << "[SCENE][WARN] Could not open " << path << std::endl;
+        return false;
+    }
+    SceneView view;
+    std::string error;
+    if (!view.Open(*file, error)) {
+        std::cerr << "[SCENE][WARN] " << path << ": " << error << std::endl;
+        return false;
+    }
+
+    world.Clear();
+    const SceneHeader& header = view.Header();
+    std::vector<ParamKey> keys(header.stringCount);
+    std::vector<std::shared_ptr<BaseEntity>> entities;
+    std::vector<uint32_t> parents;
+    entities.reserve(header.entityCount);
+    parents.reserve(header.entityCount);
+
+    // every asset the table lists loads once, up front; entities share them
+    std::vector<std::shared_ptr<Mesh>> meshes(header.assetCount);
+    std::vector<std::shared_ptr<Shader>> shaders(header.assetCount);
+    std::vector<std::vector<std::string>> samplers(header.assetCount);
+    std::unordered_map<std::string_view, std::shared_ptr<Texture>> textures;
+    for (uint32_t i = 0; i < header.assetCount; ++i) {
+        std::string name(view.String(view.Asset(i).name));
+        switch (static_cast<AssetKind>(view.Asset(i).kind)) {
+        case AssetKind::Mesh: meshes[i] = BaseEntity::LoadMesh(name); break;
+        case AssetKind::Shader:
+            shaders[i] = BaseEntity::LoadShader(name);
+            if (shaders[i])
+                samplers[i] = shaders[i]->GetSamplerUniforms();
+            else
+                std::cerr << "[SCENE][WARN] Shader '" << name << "' not found" << std::endl;
+            break;
+        case AssetKind::Texture: textures[view.String(view.Asset(i).name)] = TextureLoader::LoadTexture(name); break;
+        }
+    }
+    const std::vector<std::string> noSamplers;
+    size_t renderables = 0;
+
+    for (uint32_t i = 0; i < header.entityCount; ++i) {
+        const EntityRecord& record = view.Entity(i);
+        auto& entity = entities.emplace_back(world.MakeEntity((record.flags & kLightFlag) != 0));
+        parents.push_back(record.parent == kNone ? World::kNoParent : record.parent);
+        entity->SetName(view.String(record.name));
+        entity->SetTransform(view.GetTransform(i));
+        LoadParams(view, record.paramBegin, record.paramCount, keys, entity->Params());
+
+        if (record.mesh != kNone || record.shader != kNone) {
+            Renderable& renderable = entity->GetRenderable();
+            renderable.SetMesh(record.mesh != kNone ? meshes[record.mesh] : nullptr);
+            renderable.SetShader(record.shader != kNone ? shaders[record.shader] : nullptr);
+            // textures are named by the param of their sampler
+            for (const std::string& sampler : record.shader != kNone ? samplers[record.shader] : noSamplers) {
+                std::optional<std::string_view> texture = entity->Params().GetString(ParamKey::Find(sampler));
+                if (!texture || texture->empty())
+                    continue;
+                auto it = textures.find(*texture);
+                renderable.SetTexture(sampler, it != textures.end() ? it->second
+                                                                     : TextureLoader::LoadTexture(std::string(*texture)));
+            }
+            ++renderables;
+        }
+        LoadParams(view, record.renderParamBegin, record.renderParamCount, keys, entity->GetRenderable().Params());
+
+        if (record.flags & kLightFlag)
+            static_cast<LightEntity&>(*entity).UpdateLightFromParams();
+    }
+
+    world.AddEntities(entities, parents);
+    std::cout << "[SCENE] Loaded " << header.entityCount << " entities from " << path << " ("
+              << renderables << " renderables, " << header.assetCount << " assets, " << std::fixed << std::setprecision(2)
+              << MillisecondsSince(start) << " ms)" << std::endl;
+    return true;
+}
+
+bool Export(const std::string& scenePath, const std::string& textPath) {
+    auto file = MappedFile::Open(scenePath);
+    SceneView view;
+    std::string error = "could not open";
+    if (!file || !view.Open(*file, error)) {
+        std::cerr << "[SCENE][WARN] " << scenePath << ": " << error << std::endl;
+        return false;
+    }
+
+    std::ofstream out(textPath, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "[SCENE][WARN] Could not write " << textPath << std::endl;
+        return false;
+    }
+
+    const SceneHeader& header = view.Header();
+    out << "scene v" << header.version << ": " << header.entityCount << " entities, " << header.assetCount
+        << " assets, " << header.stringCount << " strings\n";
+    for (uint32_t i = 0; i < header.assetCount; ++i)
+        out << "asset " << AssetKindName(static_cast<AssetKind>(view.Asset(i).kind)) << ' '
+            << view.String(view.Asset(i).name) << '\n';
+
+    for (uint32_t i = 0; i < header.entityCount; ++i) {
+        const EntityRecord& record = view.Entity(i);
+        const Transform& transform = view.GetTransform(i);
+        out << "entity " << i << " \"" << view.String(record.name) << "\"";
+        if (record.parent != kNone)
+            out << " parent " << record.parent;
+        if (record.flags & kLightFlag)
+            out << " light";
+        out << '\n';
+        out << "  transform";
+        ExportVec3(out, transform.position);
+        out << " /";
+        ExportVec3(out, transform.rotation);
+        out << " /";
+        ExportVec3(out, transform.scale);
+        out << '\n';
+        ExportParams(out, view, "param", record.paramBegin, record.paramCount);
+        ExportParams(out, view, "uniform", record.renderParamBegin, record.renderParamCount);
+    }
+
+    out.flush();
+    if (!out.good()) {
+        std::cerr << "[SCENE][WARN] Could not write " << textPath << std::endl;
+        return false;
+    }
+    std::cout << "[SCENE] Exported " << scenePath << " to " << textPath << std::endl;
+    return true;
+}
+
+} // namespace SceneFile
@@ -0,0 +1,140 @@
+#ifndef SCENE_FILE_HPP
+#define SCENE_FILE_HPP
+
+#include "../entity/entity_handle.hpp"
+#include "../entity/params.hpp"
+#include "../entity/transform.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class World;
+
+//
+// === SceneFile ===
+// Binary scene format (.escn), laid out to be memory mapped and read in
+// place: no text is parsed on load. Every entity of the world but the root
+// is saved with its name, parent, local transform, params and renderable
+// params; meshes, shaders and textures are referenced by name. Behaviors,
+// tweens and the camera are runtime state and aren't saved.
+//
+// Layout: SceneHeader | sections in SceneSection order, each 16 byte aligned
+//   Strings      uint32 offsets[stringCount + 1], then the characters
+//   Entities     EntityRecord[entityCount], parents before their children
+//   Transforms   Transform[entityCount]
+//   Params       ParamRecord[paramCount], each entity's params in one run
+//   Words        uint32 words[wordCount], numeric param values
+//   Assets       AssetRecord[assetCount]
+//
+// Saving writes the file front to back in one pass next to the target,
+// syncs it and renames it over (AtomicFile), so a failed save or a crash
+// never leaves half a scene behind.
+//
+namespace SceneFile {
+
+constexpr char kMagic[4] = {'E', 'S', 'C', 'N'};
+constexpr uint32_t kVersion = 1;
+constexpr const char* kDefaultPath = "projects/untitled.escn";
+// parent of entities directly under the world root, and "no asset"
+constexpr uint32_t kNone = ~0u;
+
+enum class Section : uint32_t { Strings, Entities, Transforms, Params, Words, Assets, Count };
+
+struct SceneSection {
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct SceneHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entityCount;
+    uint32_t stringCount;
+    uint32_t paramCount;
+    uint32_t wordCount;
+    uint32_t assetCount;
+    uint32_t sectionCount;
+    SceneSection sections[static_cast<size_t>(Section::Count)];
+};
+
+struct EntityRecord {
+    uint32_t name;   // string
+    uint32_t parent; // earlier record, kNone under the root
+    uint32_t flags;
+    uint32_t paramBegin;
+    uint32_t paramCount;
+    uint32_t renderParamBegin;
+    uint32_t renderParamCount;
+    uint32_t mesh;   // asset, kNone without
+    uint32_t shader; // asset, kNone without
+    uint32_t reserved;
+};
+
+constexpr uint32_t kLightFlag = 1;
+
+struct ParamRecord {
+    uint32_t key;   // string
+    uint32_t type;  // ParamType
+    uint32_t value; // first word, or the string for ParamType::String
+};
+
+enum class AssetKind : uint32_t { Mesh, Shader, Texture };
+
+struct AssetRecord {
+    uint32_t kind; // AssetKind
+    uint32_t name; // string, as the params name it ("cube", not the path)
+};
+
+// Saves the world's entities. False (and the old file kept) on failure.
+bool Save(World& world, const std::string& path);
+
+// Replaces the world's entities with the scene's. The file is checked
+// before anything is touched; false leaves the world as it was. Every
+// asset in the table is loaded once before the entities are built.
+bool Load(World& world, const std::string& path);
+
+//
+// === Snapshots ===
+// What Save writes, copied out of the world so it can be written on another
+// thread while the world moves on (Autosave). Entities are cut into blocks
+// of store slots (EntityStore::kStampBlock); neither changes once captured,
+// so a snapshot shares every entity and block that didn't change with the
+// one before. Transforms are kept apart, they change far more often.
+//
+struct EntitySnapshot {
+    EntityHandle handle;
+    uint32_t parent = kNone; // slot, kNone under the root
+    uint32_t flags = 0;
+    std::string name;
+    CParams params;
+    CParams renderParams;
+    std::vector<std::string> textures;
+};
+
+struct SnapshotBlock {
+    std::vector<std::shared_ptr<const EntitySnapshot>> entities; // by slot
+};
+
+struct Snapshot {
+    std::vector<std::shared_ptr<const SnapshotBlock>> blocks;
+    // per block, in the order of its entities
+    std::vector<std::shared_ptr<const std::vector<Transform>>> transforms;
+};
+
+// Where nothing writes to the world; reads only, so blocks can be captured
+// in parallel.
+std::shared_ptr<const EntitySnapshot> CaptureEntity(const World& world, EntityHandle handle);
+std::shared_ptr<const std::vector<Transform>> CaptureTransforms(const World& world, const SnapshotBlock& block);
+
+// Writes a snapshot the way Save writes the world, from any thread, and
+// syncs it to disk before renaming. Returns the bytes written, 0 on failure.
+uint64_t Write(const Snapshot& snapshot, const std::string& path);
+
+// Human readable dump of a scene file for diffing, one line per asset,
+// entity, param and uniform. Not meant to be read back.
+bool Export(const std::string& scenePath, const std::string& textPath);
+
+} // namespace SceneFile
+
+#endif // SCENE_FILE_HPP
@@ -0,0 +1,452 @@
+#include "spatial_index.hpp"
+#include "../jobs/job_system.hpp"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// trees smaller than this are culled on the calling thread
+constexpr size_t kParallelCullLeaves = 4096;
+
+Bounds Union(const Bounds& a, const Bounds& b) { return {glm::min(a.min, b.min), glm::max(a.max, b.max)}; }
+
+float Area(const Bounds& box) {
+    glm::vec3 d = box.max - box.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+bool ContainsBox(const Bounds& outer, const Bounds& inner) {
+    return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::lessThanEqual(inner.max, outer.max));
+}
+
+bool Overlaps(const Bounds& a, const Bounds& b) {
+    return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+}
+
+bool TouchesSphere(const Bounds& box, const glm::vec3& center, float radiusSq) {
+    glm::vec3 d = center - glm::clamp(center, box.min, box.max);
+    return glm::dot(d, d) <= radiusSq;
+}
+
+// Slab test against [0, maxT]. Axes the ray doesn't move along only check
+// that the origin is inside the slab, which also keeps flat boxes hittable.
+bool RayHits(const Bounds& box, const glm::vec3& origin, const glm::vec3& direction, float maxT, float& enter) {
+    float tMin = 0.0f;
+    float tMax = maxT;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (direction[axis] == 0.0f) {
+            if (origin[axis] < box.min[axis] || origin[axis] > box.max[axis])
+                return false;
+            continue;
+        }
+        float inv = 1.0f / direction[axis];
+        float t1 = (box.min[axis] - origin[axis]) * inv;
+        float t2 = (box.max[axis] - origin[axis]) * inv;
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+        if (tMin > tMax)
+            return false;
+    }
+    enter = tMin;
+    return true;
+}
+
+enum class Side { Outside, Inside, Intersecting };
+
+// Planes as (normal, d), inside when dot(normal, p) + d >= 0.
+Side Classify(const std::array<glm::vec4, 6>& planes, const Bounds& box) {
+    Side side = Side::Inside;
+    for (const glm::vec4& plane : planes) {
+        glm::vec3 normal(plane);
+        // corner furthest along the normal and the one opposite it
+        glm::vec3 positive = box.min;
+        glm::vec3 negative = box.max;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (normal[axis] >= 0.0f)
+                std::swap(positive[axis], negative[axis]);
+        }
+        if (glm::dot(normal, positive) + plane.w < 0.0f)
+            return Side::Outside;
+        if (glm::dot(normal, negative) + plane.w < 0.0f)
+            side = Side::Intersecting;
+    }
+    return side;
+}
+
+// Gribb/Hartmann: clip space -w <= x,y,z <= w as planes on the matrix rows.
+std::array<glm::vec4, 6> ExtractPlanes(const glm::mat4& m) {
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    return {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2};
+}
+
+} // namespace
+
+//
+// === Maintenance ===
+//
+void SpatialIndex::Update(const EntityStore& store) {
+    reinserted_ = 0;
+    for (EntityHandle handle : store.GetChanged()) {
+        if (!store.Contains(handle))
+            continue;
+
+        const Bounds& tight = store.GetBounds(handle);
+        Bounds fat{tight.min - glm::vec3(kMargin), tight.max + glm::vec3(kMargin)};
+        if (handle.index >= leaves_.size())
+            leaves_.resize(handle.index + 1, kNull);
+
+        int32_t leaf = leaves_[handle.index];
+        if (leaf != kNull && nodes_[leaf].handle != handle) {
+            // slot was reused without Remove, the old leaf is garbage
+            Remove(nodes_[leaf].handle);
+            leaf = kNull;
+        }
+
+        if (leaf != kNull) {
+            Node& node = nodes_[leaf];
+            node.tight = tight;
+            // still inside its fat box, and that box hasn't become far too big (shrunk entity)
+            if (ContainsBox(node.box, tight) && Area(node.box) <= 4.0f * Area(fat))
+                continue;
+            RemoveLeaf(leaf);
+            ++reinserted_;
+        } else {
+            leaf = AllocateNode();
+            leaves_[handle.index] = leaf;
+            nodes_[leaf].handle = handle;
+            ++leafCount_;
+        }
+
+        nodes_[leaf].tight = tight;
+        nodes_[leaf].box = fat;
+        InsertLeaf(leaf);
+    }
+}
+
+void SpatialIndex::Remove(EntityHandle handle) {
+    if (handle.index >= leaves_.size())
+        return;
+    int32_t leaf = leaves_[handle.index];
+    if (leaf == kNull || nodes_[leaf].handle != handle)
+        return;
+
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+    leaves_[handle.index] = kNull;
+    --leafCount_;
+}
+
+void SpatialIndex::Clear() {
+    nodes_.clear();
+    leaves_.clear();
+    root_ = kNull;
+    freeList_ = kNull;
+    leafCount_ = 0;
+    reinserted_ = 0;
+}
+
+int32_t SpatialIndex::AllocateNode() {
+    int32_t node;
+    if (freeList_ != kNull) {
+        node = freeList_;
+        freeList_ = nodes_[node].left;
+    } else {
+        node = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[node] = Node{};
+    return node;
+}
+
+void SpatialIndex::FreeNode(int32_t node) {
+    nodes_[node].left = freeList_;
+    nodes_[node].height = -1;
+    freeList_ = node;
+}
+
+void SpatialIndex::InsertLeaf(int32_t leaf) {
+    if (root_ == kNull) {
+        root_ = leaf;
+        nodes_[leaf].parent = kNull;
+        return;
+    }
+
+    // --- Find the cheapest sibling by surface area ---
+    const Bounds box = nodes_[leaf].box;
+    int32_t index = root_;
+    while (!nodes_[index].IsLeaf()) {
+        const Node& node = nodes_[index];
+        float area = Area(node.box);
+        float combinedArea = Area(Union(node.box, box));
+        // pairing with this node creates a parent covering both
+        float cost = 2.0f * combinedArea;
+        // every ancestor grows by the same amount whichever child we descend into
+        float inheritance = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int32_t child) {
+            const Node& c = nodes_[child];
+            float grown = Area(Union(c.box, box));
+            return (c.IsLeaf() ? grown : grown - Area(c.box)) + inheritance;
+        };
+        float leftCost = descendCost(node.left);
+        float rightCost = descendCost(node.right);
+        if (cost < leftCost && cost < rightCost)
+            break;
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+
+    // --- New parent for sibling and leaf ---
+    int32_t sibling = index;
+    int32_t oldParent = nodes_[sibling].parent;
+    int32_t newParent = AllocateNode();
+    Node& parent = nodes_[newParent];
+    parent.parent = oldParent;
+    parent.box = Union(box, nodes_[sibling].box);
+    parent.height = nodes_[sibling].height + 1;
+    parent.left = sibling;
+    parent.right = leaf;
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    if (oldParent == kNull)
+        root_ = newParent;
+    else if (nodes_[oldParent].left == sibling)
+        nodes_[oldParent].left = newParent;
+    else
+        nodes_[oldParent].right = newParent;
+
+    FixUpwards(newParent);
+}
+
+void SpatialIndex::RemoveLeaf(int32_t leaf) {
+    if (leaf == root_) {
+        root_ = kNull;
+        return;
+    }
+
+    int32_t parent = nodes_[leaf].parent;
+    int32_t grandParent = nodes_[parent].parent;
+    int32_t sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+    FreeNode(parent);
+
+    nodes_[sibling].parent = grandParent;
+    if (grandParent == kNull) {
+        root_ = sibling;
+        return;
+    }
+    if (nodes_[grandParent].left == parent)
+        nodes_[grandParent].left = sibling;
+    else
+        nodes_[grandParent].right = sibling;
+    FixUpwards(grandParent);
+}
+
+void SpatialIndex::FixUpwards(int32_t index) {
+    while (index != kNull) {
+        index = Balance(index);
+        Node& node = nodes_[index];
+        const Node& left = nodes_[node.left];
+        const Node& right = nodes_[node.right];
+        node.height = 1 + std::max(left.height, right.height);
+        node.box = Union(left.box, right.box);
+        index = node.parent;
+    }
+}
+
+//
+// Rotates the taller grandchild up when the children's heights differ by more
+// than one. Returns the node now in a's place.
+//
+int32_t SpatialIndex::Balance(int32_t a) {
+    Node& nodeA = nodes_[a];
+    if (nodeA.IsLeaf() || nodeA.height < 2)
+        return a;
+
+    int32_t b = nodeA.left;
+    int32_t c = nodeA.right;
+    int32_t balance = nodes_[c].height - nodes_[b].height;
+    if (balance >= -1 && balance <= 1)
+        return a;
+
+    // up is the taller child, keep is the one a keeps
+    int32_t up = balance > 1 ? c : b;
+    int32_t keep = balance > 1 ? b : c;
+    Node& nodeUp = nodes_[up];
+    int32_t f = nodeUp.left;
+    int32_t g = nodeUp.right;
+
+    // up takes a's place
+    nodeUp.left = a;
+    nodeUp.parent = nodeA.parent;
+    nodeA.parent = up;
+    if (nodeUp.parent == kNull)
+        root_ = up;
+    else if (nodes_[nodeUp.parent].left == a)
+        nodes_[nodeUp.parent].left = up;
+    else
+        nodes_[nodeUp.parent].right = up;
+
+    // up keeps its taller child, a gets the other one in up's old spot
+    int32_t tall = nodes_[f].height > nodes_[g].height ? f : g;
+    int32_t shorter = tall == f ? g : f;
+    nodeUp.right = tall;
+    if (balance > 1)
+        nodeA.right = shorter;
+    else
+        nodeA.left = shorter;
+    nodes_[shorter].parent = a;
+
+    nodeA.box = Union(nodes_[keep].box, nodes_[shorter].box);
+    nodeA.height = 1 + std::max(nodes_[keep].height, nodes_[shorter].height);
+    nodeUp.box = Union(nodeA.box, nodes_[tall].box);
+    nodeUp.height = 1 + std::max(nodeA.height, nodes_[tall].height);
+    return up;
+}
+
+//
+// === Queries ===
+//
+EntityHandle SpatialIndex::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                                   float* distance) const {
+    EntityHandle best;
+    float bestT = maxDistance;
+    float enter = 0.0f;
+    stack_.clear();
+    if (root_ != kNull)
+        stack_.push_back(root_);
+    while (!stack_.empty()) {
+        const Node& node = nodes_[stack_.back()];
+        stack_.pop_back();
+        if (!RayHits(node.box, origin, direction, bestT, enter))
+            continue;
+
+        if (!node.IsLeaf()) {
+            stack_.push_back(node.left);
+            stack_.push_back(node.right);
+        } else if (RayHits(node.tight, origin, direction, bestT, enter)) {
+            // bestT only shrinks, so this is the nearest so far
+            best = node.handle;
+            bestT = enter;
+        }
+    }
+
+    if (distance && best.IsValid())
+        *distance = bestT;
+    return best;
+}
+
+void SpatialIndex::QueryBox(const Bounds& box, std::vector<EntityHandle>& out) const {
+    stack_.clear();
+    if (root_ != kNull)
+        stack_.push_back(root_);
+    while (!stack_.empty()) {
+        const Node& node = nodes_[stack_.back()];
+        stack_.pop_back();
+        if (!Overlaps(node.box, box))
+            continue;
+        if (!node.IsLeaf()) {
+            stack_.push_back(node.left);
+            stack_.push_back(node.right);
+        } else if (Overlaps(node.tight, box)) {
+            out.push_back(node.handle);
+        }
+    }
+}
+
+void SpatialIndex::QuerySphere(const glm::vec3& center, float radius, std::vector<EntityHandle>& out) const {
+    float radiusSq = radius * radius;
+    stack_.clear();
+    if (root_ != kNull)
+        stack_.push_back(root_);
+    while (!stack_.empty()) {
+        const Node& node = nodes_[stack_.back()];
+        stack_.pop_back();
+        if (!TouchesSphere(node.box, center, radiusSq))
+            continue;
+        if (!node.IsLeaf()) {
+            stack_.push_back(node.left);
+            stack_.push_back(node.right);
+        } else if (TouchesSphere(node.tight, center, radiusSq)) {
+            out.push_back(node.handle);
+        }
+    }
+}
+
+void SpatialIndex::QueryFrustum(const glm::mat4& viewProjection, std::vector<EntityHandle>& out) const {
+    const std::array<glm::vec4, 6> planes = ExtractPlanes(viewProjection);
+    if (root_ == kNull)
+        return;
+    JobSystem& jobs = JobSystem::Instance();
+    if (leafCount_ < kParallelCullLeaves) {
+        CullSubtree(planes, root_, stack_, out);
+        return;
+    }
+
+    // split the top of the tree, untested, until there are enough subtrees to
+    // spread; the jobs test each one from its root as usual
+    size_t target = (jobs.GetWorkerCount() + 1) * 4;
+    stack_.assign(1, root_);
+    for (size_t level = 0; stack_.size() < target && level < 16; ++level) {
+        size_t count = stack_.size();
+        for (size_t k = 0; k < count; ++k) {
+            const Node& node = nodes_[stack_[k]];
+            if (node.IsLeaf())
+                continue;
+            stack_[k] = node.left;
+            stack_.push_back(node.right);
+        }
+        if (stack_.size() == count)
+            break;
+    }
+
+    if (cullTasks_.size() < stack_.size())
+        cullTasks_.resize(stack_.size());
+    for (size_t k = 0; k < stack_.size(); ++k) {
+        cullTasks_[k].start = stack_[k];
+        cullTasks_[k].out.clear();
+    }
+    jobs.ParallelFor(stack_.size(), 1, [this, &planes](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k)
+            CullSubtree(planes, cullTasks_[k].start, cullTasks_[k].stack, cullTasks_[k].out);
+    });
+    for (size_t k = 0; k < stack_.size(); ++k)
+        out.insert(out.end(), cullTasks_[k].out.begin(), cullTasks_[k].out.end());
+}
+
+void SpatialIndex::CullSubtree(const std::array<glm::vec4, 6>& planes, int32_t start, std::vector<int32_t>& stack,
+                               std::vector<EntityHandle>& out) const {
+    // nodes known to be fully inside are pushed as -(index + 2) and emptied without tests
+    auto inside = [](int32_t index) { return -index - 2; };
+    stack.assign(1, start);
+    while (!stack.empty()) {
+        int32_t entry = stack.back();
+        stack.pop_back();
+
+        if (entry < 0) {
+            const Node& node = nodes_[-entry - 2];
+            if (node.IsLeaf()) {
+                out.push_back(node.handle);
+            } else {
+                stack.push_back(inside(node.left));
+                stack.push_back(inside(node.right));
+            }
+            continue;
+        }
+
+        const Node& node = nodes_[entry];
+        Side side = Classify(planes, node.IsLeaf() ? node.tight : node.box);
+        if (side == Side::Outside)
+            continue;
+        if (node.IsLeaf())
+            out.push_back(node.handle);
+        else if (side == Side::Inside)
+            stack.push_back(inside(entry));
+        else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+#include "../entity/entity_store.hpp"
+#include "../entity/transform.hpp"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+//
+// === SpatialIndex ===
+// Dynamic AABB tree over the world bounds of a World's entities. Leaves keep
+// a fattened copy of the entity's box, so an entity that moves a little only
+// refreshes its leaf; one that leaves its fat box is taken out and reinserted
+// (cheapest sibling by surface area, then rotations on the way up keep the
+// tree balanced). Update() follows EntityStore::GetChanged(), so the cost per
+// frame is the number of entities that moved, not the world size.
+//
+// Queries prune whole subtrees, and the frustum query stops testing below a
+// node that is fully inside, so they cost roughly the size of their result.
+// Hits are tested against the exact bounds, not the fat ones. Large trees
+// are culled on the JobSystem, one job per subtree near the root.
+//
+class SpatialIndex {
+  public:
+    // Refits the entities UpdateTransforms just rebuilt.
+    void Update(const EntityStore& store);
+    // Has to be called before the store forgets the handle.
+    void Remove(EntityHandle handle);
+    void Clear();
+
+    // Nearest entity whose bounds the ray enters within maxDistance; invalid if
+    // none. direction doesn't have to be normalized, distance is in its units.
+    EntityHandle Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                         float* distance = nullptr) const;
+    // Results are appended to out.
+    void QueryBox(const Bounds& box, std::vector<EntityHandle>& out) const;
+    void QuerySphere(const glm::vec3& center, float radius, std::vector<EntityHandle>& out) const;
+    // Entities whose bounds touch the frustum of projection * view (GL clip space).
+    // The order of the results is unspecified.
+    void QueryFrustum(const glm::mat4& viewProjection, std::vector<EntityHandle>& out) const;
+
+    [[nodiscard]] size_t Size() const { return leafCount_; }
+    [[nodiscard]] int GetHeight() const { return root_ == kNull ? 0 : nodes_[root_].height; }
+    // Leaves reinserted by the last Update (the rest were refit in place).
+    [[nodiscard]] size_t GetReinsertedCount() const { return reinserted_; }
+
+  private:
+    static constexpr int32_t kNull = -1;
+    // fattening added on every side, in world units
+    static constexpr float kMargin = 0.1f;
+
+    struct Node {
+        Bounds box;   // fat for leaves, union of children otherwise
+        Bounds tight; // leaves only: the entity's exact bounds
+        int32_t parent = kNull;
+        int32_t left = kNull; // next free node while on the free list
+        int32_t right = kNull;
+        int32_t height = 0;   // 0: leaf, -1: free
+        EntityHandle handle;
+
+        [[nodiscard]] bool IsLeaf() const { return left == kNull; }
+    };
+
+    int32_t AllocateNode();
+    void FreeNode(int32_t node);
+    void InsertLeaf(int32_t leaf);
+    void RemoveLeaf(int32_t leaf);
+    int32_t Balance(int32_t node);
+    // walks from node to the root, rebalancing and refitting boxes
+    void FixUpwards(int32_t node);
+    void CullSubtree(const std::array<glm::vec4, 6>& planes, int32_t start, std::vector<int32_t>& stack,
+                     std::vector<EntityHandle>& out) const;
+
+    // subtree culled by one job: its own stack and results
+    struct CullTask {
+        int32_t start = kNull;
+        std::vector<int32_t> stack;
+        std::vector<EntityHandle> out;
+    };
+
+    std::vector<Node> nodes_;
+    int32_t root_ = kNull;
+    int32_t freeList_ = kNull;
+    size_t leafCount_ = 0;
+    size_t reinserted_ = 0;
+    // leaf per entity slot index, kNull if not indexed
+    std::vector<int32_t> leaves_;
+    // traversal stack, kept so queries don't allocate
+    mutable std::vector<int32_t> stack_;
+    mutable std::vector<CullTask> cullTasks_;
+};
+
+#endif // SPATIAL_INDEX_HPP
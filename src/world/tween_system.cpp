@@ -0,0 +1,346 @@
+#include "tween_system.hpp"
+#include "../entity/base_entity.hpp"
+#include "../jobs/job_system.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TWEEN_SYSTEM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TWEEN_SYSTEM_AVX2
+#else
+#define TWEEN_SYSTEM_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace {
+
+// tracks per job; a track is a handful of flops, so chunks are big
+constexpr size_t kTrackGrain = 4096;
+
+constexpr float kTwoPi = 6.28318530717959f;
+// shorter tracks would divide by (almost) zero
+constexpr float kMinDuration = 1e-4f;
+
+using TransformKernels::Path;
+
+//
+// === Scalar ===
+//
+// w = 3u^2t c1 + 3ut^2 c2 + t^3, the cubic Bezier through (0, c1, c2, 1).
+inline float BezierWeight(float t, float c1, float c2) {
+    float u = 1.0f - t;
+    return 3.0f * u * t * (u * c1 + t * c2) + t * t * t;
+}
+
+// Step response of a damped spring, omega in rad/s.
+inline float SpringWeight(float seconds, float omega, float zeta) {
+    if (zeta >= 1.0f)
+        return 1.0f - std::exp(-omega * seconds) * (1.0f + omega * seconds);
+    float damped = omega * std::sqrt(1.0f - zeta * zeta);
+    float decay = std::exp(-zeta * omega * seconds);
+    return 1.0f - decay * (std::cos(damped * seconds) + zeta * omega / damped * std::sin(damped * seconds));
+}
+
+void BezierWeightsScalar(float* elapsed, const float* duration, const float* c1, const float* c2, float* weight,
+                         size_t begin, size_t end, float dt) {
+    for (size_t i = begin; i < end; ++i) {
+        elapsed[i] += dt;
+        weight[i] = BezierWeight(std::min(elapsed[i] / duration[i], 1.0f), c1[i], c2[i]);
+    }
+}
+
+void BlendScalar(const float* from, const float* delta, const float* weight, float* value, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+        value[i] = from[i] + delta[i] * weight[i];
+}
+
+#ifdef TWEEN_SYSTEM_X86
+
+//
+// === SSE2 ===
+//
+void BezierWeightsSSE2(float* elapsed, const float* duration, const float* c1, const float* c2, float* weight,
+                       size_t begin, size_t end, float dt) {
+    __m128 step = _mm_set1_ps(dt), one = _mm_set1_ps(1.0f), three = _mm_set1_ps(3.0f);
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 e = _mm_add_ps(_mm_loadu_ps(elapsed + i), step);
+        _mm_storeu_ps(elapsed + i, e);
+        __m128 t = _mm_min_ps(_mm_div_ps(e, _mm_loadu_ps(duration + i)), one);
+        __m128 u = _mm_sub_ps(one, t);
+        __m128 controls = _mm_add_ps(_mm_mul_ps(u, _mm_loadu_ps(c1 + i)), _mm_mul_ps(t, _mm_loadu_ps(c2 + i)));
+        __m128 w = _mm_mul_ps(_mm_mul_ps(three, _mm_mul_ps(u, t)), controls);
+        w = _mm_add_ps(w, _mm_mul_ps(_mm_mul_ps(t, t), t));
+        _mm_storeu_ps(weight + i, w);
+    }
+    BezierWeightsScalar(elapsed, duration, c1, c2, weight, i, end, dt);
+}
+
+void BlendSSE2(const float* from, const float* delta, const float* weight, float* value, size_t begin, size_t end) {
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 blended = _mm_mul_ps(_mm_loadu_ps(delta + i), _mm_loadu_ps(weight + i));
+        _mm_storeu_ps(value + i, _mm_add_ps(_mm_loadu_ps(from + i), blended));
+    }
+    BlendScalar(from, delta, weight, value, i, end);
+}
+
+//
+// === AVX2 ===
+//
+TWEEN_SYSTEM_AVX2 void BezierWeightsAVX2(float* elapsed, const float* duration, const float* c1, const float* c2,
+                                         float* weight, size_t begin, size_t end, float dt) {
+    __m256 step = _mm256_set1_ps(dt), one = _mm256_set1_ps(1.0f), three = _mm256_set1_ps(3.0f);
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 e = _mm256_add_ps(_mm256_loadu_ps(elapsed + i), step);
+        _mm256_storeu_ps(elapsed + i, e);
+        __m256 t = _mm256_min_ps(_mm256_div_ps(e, _mm256_loadu_ps(duration + i)), one);
+        __m256 u = _mm256_sub_ps(one, t);
+        __m256 controls = _mm256_fmadd_ps(u, _mm256_loadu_ps(c1 + i), _mm256_mul_ps(t, _mm256_loadu_ps(c2 + i)));
+        __m256 w = _mm256_mul_ps(_mm256_mul_ps(three, _mm256_mul_ps(u, t)), controls);
+        _mm256_storeu_ps(weight + i, _mm256_fmadd_ps(_mm256_mul_ps(t, t), t, w));
+    }
+    BezierWeightsScalar(elapsed, duration, c1, c2, weight, i, end, dt);
+}
+
+TWEEN_SYSTEM_AVX2 void BlendAVX2(const float* from, const float* delta, const float* weight, float* value,
+                                 size_t begin, size_t end) {
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 blended = _mm256_fmadd_ps(_mm256_loadu_ps(delta + i), _mm256_loadu_ps(weight + i),
+                                         _mm256_loadu_ps(from + i));
+        _mm256_storeu_ps(value + i, blended);
+    }
+    BlendScalar(from, delta, weight, value, i, end);
+}
+
+#endif // TWEEN_SYSTEM_X86
+
+void BezierWeights(Path path, float* elapsed, const float* duration, const float* c1, const float* c2, float* weight,
+                   size_t begin, size_t end, float dt) {
+    switch (path) {
+#ifdef TWEEN_SYSTEM_X86
+    case Path::AVX2: BezierWeightsAVX2(elapsed, duration, c1, c2, weight, begin, end, dt); break;
+    case Path::SSE2: BezierWeightsSSE2(elapsed, duration, c1, c2, weight, begin, end, dt); break;
+#endif
+    default: BezierWeightsScalar(elapsed, duration, c1, c2, weight, begin, end, dt); break;
+    }
+}
+
+void Blend(Path path, const float* from, const float* delta, const float* weight, float* value, size_t begin,
+           size_t end) {
+    switch (path) {
+#ifdef TWEEN_SYSTEM_X86
+    case Path::AVX2: BlendAVX2(from, delta, weight, value, begin, end); break;
+    case Path::SSE2: BlendSSE2(from, delta, weight, value, begin, end); break;
+#endif
+    default: BlendScalar(from, delta, weight, value, begin, end); break;
+    }
+}
+
+// Lane count and values of a numeric param, 0 for anything else.
+uint32_t ToLanes(const CParams::Value& value, float out[4]) {
+    switch (static_cast<ParamType>(value.index())) {
+    case ParamType::Int: out[0] = static_cast<float>(std::get<int>(value)); return 1;
+    case ParamType::Float: out[0] = std::get<float>(value); return 1;
+    case ParamType::Vec2: std::copy_n(&std::get<glm::vec2>(value).x, 2, out); return 2;
+    case ParamType::Vec3: std::copy_n(&std::get<glm::vec3>(value).x, 3, out); return 3;
+    case ParamType::Vec4: std::copy_n(&std::get<glm::vec4>(value).x, 4, out); return 4;
+    default: return 0;
+    }
+}
+
+} // namespace
+
+//
+// === Tween ===
+//
+Tween Tween::Linear(float seconds) {
+    Tween tween;
+    tween.curve = Curve::Linear;
+    tween.duration = seconds;
+    return tween;
+}
+
+Tween Tween::Bezier(float seconds, float c1, float c2) {
+    Tween tween;
+    tween.curve = Curve::Bezier;
+    tween.duration = seconds;
+    tween.c1 = c1;
+    tween.c2 = c2;
+    return tween;
+}
+
+Tween Tween::Spring(float seconds, float frequency, float damping) {
+    Tween tween;
+    tween.curve = Curve::Spring;
+    tween.duration = seconds;
+    tween.c1 = frequency;
+    tween.c2 = damping;
+    return tween;
+}
+
+//
+// === TweenSystem ===
+//
+bool TweenSystem::Add(const EntityStore& store, EntityHandle handle, ParamKey key, const CParams::Value& target,
+                      const Tween& tween) {
+    if (!store.Contains(handle) || !key.IsValid())
+        return false;
+    float to[kMaxLanes] = {};
+    uint32_t lanes = ToLanes(target, to);
+    if (lanes == 0)
+        return false;
+
+    // ints and floats tween into each other, vectors only into their own size
+    auto type = static_cast<ParamType>(target.index());
+    float from[kMaxLanes] = {};
+    std::copy_n(to, lanes, from);
+    if (std::optional<CParams::Value> current = store.GetEntity(handle)->Params().Get(key)) {
+        if (ToLanes(*current, from) != lanes)
+            return false;
+        type = static_cast<ParamType>(current->index());
+    }
+
+    Add(handle, key, type, std::span<const float>(from, lanes), std::span<const float>(to, lanes), tween);
+    return true;
+}
+
+void TweenSystem::Add(EntityHandle handle, ParamKey key, ParamType type, std::span<const float> from,
+                      std::span<const float> to, const Tween& tween) {
+    auto lanes = static_cast<uint32_t>(std::clamp<size_t>(std::min(from.size(), to.size()), 1, kMaxLanes));
+    bool spring = tween.curve == Tween::Curve::Spring;
+    uint32_t b = (spring ? kMaxLanes : 0) + lanes - 1;
+
+    // one track per param: a new one takes over from wherever the old one is
+    if (auto it = lookup_.find(LookupKey(handle, key)); it != lookup_.end())
+        RemoveTrack(it->second & 7, it->second >> 3);
+
+    Batch& batch = batches_[b];
+    batch.lanes = lanes;
+    batch.spring = spring;
+    lookup_[LookupKey(handle, key)] = Locate(b, batch.Size());
+    batch.handles.push_back(handle);
+    batch.keys.push_back(key);
+    batch.types.push_back(type);
+    batch.elapsed.push_back(0.0f);
+    batch.duration.push_back(std::max(tween.duration, kMinDuration));
+    batch.c1.push_back(spring ? kTwoPi * tween.c1 : tween.c1);
+    batch.c2.push_back(spring ? std::max(tween.c2, 0.0f) : tween.c2);
+    batch.weight.push_back(0.0f);
+    for (uint32_t l = 0; l < lanes; ++l) {
+        batch.from[l].push_back(from[l]);
+        batch.delta[l].push_back(to[l] - from[l]);
+        batch.value[l].push_back(from[l]);
+    }
+}
+
+size_t TweenSystem::Remove(EntityHandle handle) {
+    size_t removed = 0;
+    for (uint32_t b = 0; b < kBatchCount; ++b) {
+        for (size_t i = batches_[b].Size(); i-- > 0;) {
+            if (batches_[b].handles[i] == handle) {
+                RemoveTrack(b, i);
+                ++removed;
+            }
+        }
+    }
+    return removed;
+}
+
+void TweenSystem::Clear() {
+    for (Batch& batch : batches_)
+        batch = Batch();
+    lookup_.clear();
+}
+
+// Swap with the last track of the batch, column by column.
+void TweenSystem::RemoveTrack(uint32_t b, size_t index) {
+    Batch& batch = batches_[b];
+    lookup_.erase(LookupKey(batch.handles[index], batch.keys[index]));
+    auto take = [index](auto& column) {
+        column[index] = column.back();
+        column.pop_back();
+    };
+    take(batch.handles);
+    take(batch.keys);
+    take(batch.types);
+    take(batch.elapsed);
+    take(batch.duration);
+    take(batch.c1);
+    take(batch.c2);
+    take(batch.weight);
+    for (uint32_t l = 0; l < batch.lanes; ++l) {
+        take(batch.from[l]);
+        take(batch.delta[l]);
+        take(batch.value[l]);
+    }
+    if (index < batch.Size())
+        lookup_[LookupKey(batch.handles[index], batch.keys[index])] = Locate(b, index);
+}
+
+void TweenSystem::Advance(float deltaTime) { Advance(deltaTime, TransformKernels::GetActivePath()); }
+
+void TweenSystem::Advance(float deltaTime, Path path) {
+    if (!TransformKernels::IsSupported(path))
+        path = Path::Scalar;
+    float dt = std::max(deltaTime, 0.0f);
+
+    for (Batch& batch : batches_) {
+        JobSystem::Instance().ParallelFor(batch.Size(), kTrackGrain, [&batch, path, dt](size_t begin, size_t end) {
+            if (batch.spring) {
+                for (size_t i = begin; i < end; ++i) {
+                    batch.elapsed[i] += dt;
+                    batch.weight[i] = batch.elapsed[i] >= batch.duration[i]
+                                          ? 1.0f
+                                          : SpringWeight(batch.elapsed[i], batch.c1[i], batch.c2[i]);
+                }
+            } else {
+                BezierWeights(path, batch.elapsed.data(), batch.duration.data(), batch.c1.data(), batch.c2.data(),
+                              batch.weight.data(), begin, end, dt);
+            }
+            for (uint32_t l = 0; l < batch.lanes; ++l)
+                Blend(path, batch.from[l].data(), batch.delta[l].data(), batch.weight.data(), batch.value[l].data(),
+                      begin, end);
+        });
+    }
+}
+
+size_t TweenSystem::Apply(EntityStore& store) {
+    lastWrites_ = 0;
+    for (uint32_t b = 0; b < kBatchCount; ++b) {
+        Batch& batch = batches_[b];
+        const auto& v = batch.value;
+        done_.clear();
+        for (size_t i = 0; i < batch.Size(); ++i) {
+            if (!store.Contains(batch.handles[i])) {
+                done_.push_back(static_cast<uint32_t>(i));
+                continue;
+            }
+
+            CParams& params = store.GetEntity(batch.handles[i])->Params();
+            ParamKey key = batch.keys[i];
+            switch (batch.types[i]) {
+            case ParamType::Int: params.Set(key, static_cast<int>(std::lround(v[0][i]))); break;
+            case ParamType::Float: params.Set(key, v[0][i]); break;
+            case ParamType::Vec2: params.Set(key, glm::vec2(v[0][i], v[1][i])); break;
+            case ParamType::Vec3: params.Set(key, glm::vec3(v[0][i], v[1][i], v[2][i])); break;
+            case ParamType::Vec4: params.Set(key, glm::vec4(v[0][i], v[1][i], v[2][i], v[3][i])); break;
+            default: break;
+            }
+            ++lastWrites_;
+
+            if (batch.elapsed[i] >= batch.duration[i]) {
+                done_.push_back(static_cast<uint32_t>(i));
+                ++finished_;
+            }
+        }
+        // back to front, so the tracks swapped in have been seen already
+        for (auto it = done_.rbegin(); it != done_.rend(); ++it)
+            RemoveTrack(b, *it);
+    }
+    return lastWrites_;
+}
@@ -0,0 +1,117 @@
+#ifndef TWEEN_SYSTEM_HPP
+#define TWEEN_SYSTEM_HPP
+
+#include "../entity/entity_store.hpp"
+#include "../entity/param_key.hpp"
+#include "../entity/params.hpp"
+#include "../entity/transform_kernels.hpp"
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+//
+// === Tween ===
+// How a track gets from its start to its target value. Linear and Bezier
+// are the same cubic on the progress: c1 and c2 are the control ordinates
+// (linear is 1/3, 2/3), so an ease-out is (1, 1) and an overshoot goes past
+// 1. Spring is a damped spring in seconds (c1 Hz, c2 damping ratio, 1 and
+// up is critically damped) that snaps to the target after duration.
+//
+struct Tween {
+    enum class Curve : uint8_t { Linear, Bezier, Spring };
+
+    Curve curve = Curve::Linear;
+    float duration = 1.0f; // seconds
+    float c1 = 1.0f / 3.0f;
+    float c2 = 2.0f / 3.0f;
+
+    static Tween Linear(float seconds);
+    static Tween Bezier(float seconds, float c1, float c2);
+    static Tween Spring(float seconds, float frequency, float damping);
+};
+
+//
+// === TweenSystem ===
+// Tracks animating one (entity, param) each from its value when added to a
+// target. Int, float and vec2/3/4 params can be tweened; ints are rounded
+// on write. A new track on a param that already has one replaces it.
+//
+// Tracks are kept in SoA batches, one per curve family (polynomial or
+// spring) and lane count, so a batch is a few flat float columns. Advance()
+// runs the batches in chunks on the JobSystem: progress and weights for 4
+// or 8 tracks at a time (SSE2/AVX2, the TransformKernels path; spring
+// weights need exp and sin and are scalar), then every lane column blended
+// the same way. Apply() writes the values back to CParams in one pass and
+// drops finished tracks and tracks of entities that are gone.
+//
+class TweenSystem {
+  public:
+    // Starts from the param's current value, or the target if it has none.
+    // False if the target isn't int, float or a vector, or its type doesn't
+    // match the param's.
+    bool Add(const EntityStore& store, EntityHandle handle, ParamKey key, const CParams::Value& target,
+             const Tween& tween);
+    // from and to hold one to four lanes, type says how they're written.
+    void Add(EntityHandle handle, ParamKey key, ParamType type, std::span<const float> from, std::span<const float> to,
+             const Tween& tween);
+    // Drops the entity's tracks; returns how many it had.
+    size_t Remove(EntityHandle handle);
+    void Clear();
+
+    void Update(EntityStore& store, float deltaTime) {
+        Advance(deltaTime);
+        Apply(store);
+    }
+    // Reads and writes only the tracks, any thread.
+    void Advance(float deltaTime);
+    // Forces a path, falls back to scalar if the CPU can't run it (benchmarks).
+    void Advance(float deltaTime, TransformKernels::Path path);
+    // Main thread or wherever nothing else uses the store. Returns the values written.
+    size_t Apply(EntityStore& store);
+
+    [[nodiscard]] size_t GetTrackCount() const { return lookup_.size(); }
+    [[nodiscard]] size_t GetLastWriteCount() const { return lastWrites_; }
+    // Tracks that reached their target, since the start.
+    [[nodiscard]] size_t GetFinishedCount() const { return finished_; }
+
+  private:
+    static constexpr uint32_t kMaxLanes = 4;
+    // polynomial and spring batches per lane count
+    static constexpr uint32_t kBatchCount = 2 * kMaxLanes;
+
+    struct Batch {
+        std::vector<EntityHandle> handles;
+        std::vector<ParamKey> keys;
+        std::vector<ParamType> types;
+        std::vector<float> elapsed;
+        std::vector<float> duration;
+        std::vector<float> c1;
+        std::vector<float> c2;
+        std::vector<float> weight;
+        std::vector<float> from[kMaxLanes];
+        std::vector<float> delta[kMaxLanes];
+        std::vector<float> value[kMaxLanes];
+        uint32_t lanes = 1;
+        bool spring = false;
+
+        [[nodiscard]] size_t Size() const { return handles.size(); }
+    };
+
+    static uint64_t LookupKey(EntityHandle handle, ParamKey key) {
+        return uint64_t(handle.index) << 32 | key.GetId();
+    }
+    static_assert(kBatchCount <= 8, "Locate() keeps the batch in 3 bits");
+    static uint32_t Locate(uint32_t batch, size_t index) { return static_cast<uint32_t>(index) << 3 | batch; }
+
+    void RemoveTrack(uint32_t batch, size_t index);
+
+    Batch batches_[kBatchCount];
+    // (entity slot, key) -> Locate(batch, index)
+    std::unordered_map<uint64_t, uint32_t> lookup_;
+    std::vector<uint32_t> done_;
+    size_t lastWrites_ = 0;
+    size_t finished_ = 0;
+};
+
+#endif // TWEEN_SYSTEM_HPP
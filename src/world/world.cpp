@@ -1,15 +1,26 @@
 #include "world.hpp"
+#include "../bench/gpu_profiler.hpp"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 
 
 World::World(const char* name) {
     //fuck c++
-    worldRoot_ = std::move(CreateEntity(glm::vec3(0.f), glm::vec3(0.f), glm::vec3(1.f), name));
+    // the root survives Clear(), so it lives on the heap rather than in the arena
+    worldRoot_ = std::make_shared<BaseEntity>(glm::vec3(0.f), glm::vec3(0.f), glm::vec3(1.f), name);
+    store_.Create(worldRoot_);
+    store_.GetParamSync().Subscribe(&binder_);
+    store_.GetParamSync().Subscribe(&autosave_);
 }
 
 World::~World() {
+    JobSystem::Instance().Wait(updating_);
     RemoveEntity(worldRoot_);
+    // entities still referenced elsewhere keep working detached
+    store_.Clear();
+    if (instanceBuffer_)
+        glDeleteBuffers(1, &instanceBuffer_);
 }
 
 std::shared_ptr<BaseEntity> World::CreateEntity(
@@ -18,11 +29,27 @@ std::shared_ptr<BaseEntity> World::CreateEntity(
     const glm::vec3& scale,
     const char* name
 ) {
-    auto entity = std::make_shared<BaseEntity>(position, rotation, scale, name);
-    entities_.push_back(entity);
+    auto entity = std::allocate_shared<BaseEntity>(ArenaAllocator<BaseEntity>(arena_), position, rotation, scale,
+                                                   name, arena_.get());
+    AttachToRoot(store_.Create(entity));
 
     std::cout << "[WORLD] Created entity: " << name
-              << " (Total: " << entities_.size() << ")" << std::endl;
+              << " (Total: " << store_.Size() << ")" << std::endl;
+    return entity;
+}
+
+std::shared_ptr<LightEntity> World::CreateLight(
+    const glm::vec3& position,
+    const PointLight& light,
+    const char* name
+) {
+    auto entity = std::allocate_shared<LightEntity>(ArenaAllocator<LightEntity>(arena_), position, light, name,
+                                                    arena_.get());
+    AttachToRoot(store_.Create(entity));
+    lights_.push_back(entity);
+
+    std::cout << "[WORLD] Created light: " << name
+              << " (Lights: " << lights_.size() << ")" << std::endl;
     return entity;
 }
 
@@ -31,9 +58,16 @@ void World::AddEntity(std::shared_ptr<BaseEntity> entity) {
         std::cerr << "[WORLD][WARN] Attempted to add null entity." << std::endl;
         return;
     }
+    if (entity->IsAttached()) {
+        std::cerr << "[WORLD][WARN] Entity " << entity->GetName() << " already belongs to a world." << std::endl;
+        return;
+    }
 
-    entities_.push_back(std::move(entity));
-    std::cout << "[WORLD] Added entity (Total: " << entities_.size() << ")" << std::endl;
+    if (auto light = std::dynamic_pointer_cast<LightEntity>(entity))
+        lights_.push_back(std::move(light));
+
+    AttachToRoot(store_.Create(std::move(entity)));
+    std::cout << "[WORLD] Added entity (Total: " << store_.Size() << ")" << std::endl;
 }
 
 void World::RemoveEntity(const std::shared_ptr<BaseEntity>& entity) {
@@ -42,35 +76,358 @@ void World::RemoveEntity(const std::shared_ptr<BaseEntity>& entity) {
         return;
     }
 
-    auto it = std::find(entities_.begin(), entities_.end(), entity);
-    if (it != entities_.end()) {
-        std::cout << "[WORLD] Removing entity: " << (*it)->GetName() << std::endl;
-        entities_.erase(it);
-    } else {
+    EntityHandle handle = entity->GetHandle();
+    if (!store_.Contains(handle) || store_.GetEntity(handle) != entity) {
         std::cerr << "[WORLD][WARN] Entity not found for removal." << std::endl;
+        return;
+    }
+
+    if (dynamic_cast<const LightEntity*>(entity.get())) {
+        auto light = std::find(lights_.begin(), lights_.end(), entity);
+        if (light != lights_.end()) {
+            std::swap(*light, lights_.back());
+            lights_.pop_back();
+        }
     }
+
+    spatial_.Remove(handle);
+    store_.Destroy(handle);
 }
 
 void World::Clear() {
-    std::cout << "[WORLD] Clearing all entities (" << entities_.size() << ")" << std::endl;
-    entities_.clear();
+    std::cout << "[WORLD] Clearing all entities (" << store_.Size() << ")" << std::endl;
+    spatial_.Clear();
+    behaviors_.Clear();
+    tweens_.Clear();
+    store_.Clear();
+    lights_.clear();
+    pendingDestroy_.clear();
+    // everything goes back in one reset, unless something outside still holds an entity
+    if (!arena_->Reset())
+        std::cerr << "[WORLD][WARN] " << arena_->GetLiveAllocations()
+                  << " arena allocations still referenced, memory kept for reuse" << std::endl;
+    // the root survives a clear
+    if (worldRoot_)
+        store_.Create(worldRoot_);
+}
+
+//
+// === Simulation ===
+//
+void World::Update(float deltaTime) {
+    SyncParams();
+    autosave_.Update(deltaTime);
+    Simulate(deltaTime);
+}
+
+void World::Simulate(float deltaTime) {
+    float dt = std::clamp(deltaTime, 0.0f, kMaxDeltaTime);
+    accumulator_ += dt;
+    lastSteps_ = 0;
+    while (accumulator_ >= fixedStep_) {
+        if (lastSteps_ == kMaxSteps) {
+            accumulator_ = std::fmod(accumulator_, fixedStep_);
+            break;
+        }
+        behaviors_.Step(store_, fixedStep_);
+        accumulator_ -= fixedStep_;
+        ++lastSteps_;
+    }
+
+    alpha_ = accumulator_ / fixedStep_;
+    behaviors_.Present(store_, alpha_);
+    tweens_.Update(store_, dt);
+}
+
+bool World::AddBehavior(const std::shared_ptr<BaseEntity>& entity, Behavior behavior) {
+    if (!entity || !store_.Contains(entity->GetHandle()) || entity == worldRoot_)
+        return false;
+    behaviors_.Add(entity->GetHandle(), std::move(behavior));
+    return true;
+}
+
+size_t World::RemoveBehaviors(const std::shared_ptr<BaseEntity>& entity) {
+    return entity ? behaviors_.Remove(entity->GetHandle()) : 0;
+}
+
+bool World::AddTween(const std::shared_ptr<BaseEntity>& entity, std::string_view param, const CParams::Value& target,
+                     const Tween& tween) {
+    if (!entity || entity == worldRoot_)
+        return false;
+    return tweens_.Add(store_, entity->GetHandle(), ParamKey::Intern(param), target, tween);
+}
+
+size_t World::RemoveTweens(const std::shared_ptr<BaseEntity>& entity) {
+    return entity ? tweens_.Remove(entity->GetHandle()) : 0;
+}
+
+//
+// === Hierarchy ===
+//
+void World::AttachToRoot(EntityHandle handle) {
+    // still null while the constructor creates the root itself
+    if (worldRoot_)
+        store_.SetParent(handle, worldRoot_->GetHandle());
+}
+
+bool World::SetParent(const std::shared_ptr<BaseEntity>& child, const std::shared_ptr<BaseEntity>& parent) {
+    if (!child || !store_.Contains(child->GetHandle()) || child == worldRoot_)
+        return false;
+
+    const auto& newParent = parent ? parent : worldRoot_;
+    if (!store_.Contains(newParent->GetHandle()) || !store_.SetParent(child->GetHandle(), newParent->GetHandle())) {
+        std::cerr << "[WORLD][WARN] Cannot parent " << child->GetName() << " to " << newParent->GetName() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<BaseEntity> World::GetParent(const std::shared_ptr<BaseEntity>& child) const {
+    return child ? GetEntity(store_.GetParent(child->GetHandle())) : nullptr;
+}
+
+//
+// === Batches ===
+//
+std::vector<std::shared_ptr<BaseEntity>> World::CreateEntities(size_t count, const BaseEntity& prototype) {
+    std::vector<std::shared_ptr<BaseEntity>> entities;
+    if (count == 0)
+        return entities;
+
+    entities.reserve(count);
+    ArenaAllocator<BaseEntity> allocator(arena_);
+    for (size_t i = 0; i < count; ++i) {
+        auto& entity = entities.emplace_back(std::allocate_shared<BaseEntity>(allocator, arena_.get()));
+        entity->CopyFrom(prototype);
+    }
+
+    store_.Create(entities);
+    // under the root, appending there never moves anything
+    for (const auto& entity : entities)
+        AttachToRoot(entity->GetHandle());
+    std::cout << "[WORLD] Created " << count << " x " << prototype.GetName() << " (Total: " << store_.Size() << ")"
+              << std::endl;
+    return entities;
+}
+
+std::shared_ptr<BaseEntity> World::MakeEntity(bool light) {
+    if (light)
+        return std::allocate_shared<LightEntity>(ArenaAllocator<LightEntity>(arena_), arena_.get());
+    return std::allocate_shared<BaseEntity>(ArenaAllocator<BaseEntity>(arena_), arena_.get());
+}
+
+void World::AddEntities(std::span<const std::shared_ptr<BaseEntity>> entities, std::span<const uint32_t> parents) {
+    store_.Create(entities);
+    // parents come first, so each entity lands right where its parent's
+    // subtree ends and parenting never moves anything
+    for (size_t i = 0; i < entities.size(); ++i) {
+        uint32_t parent = i < parents.size() ? parents[i] : kNoParent;
+        if (parent < i && store_.Contains(entities[parent]->GetHandle()))
+            store_.SetParent(entities[i]->GetHandle(), entities[parent]->GetHandle());
+        else
+            AttachToRoot(entities[i]->GetHandle());
+        if (auto light = std::dynamic_pointer_cast<LightEntity>(entities[i]))
+            lights_.push_back(std::move(light));
+    }
+    std::cout << "[WORLD] Added " << entities.size() << " entities (Total: " << store_.Size() << ")" << std::endl;
+}
+
+void World::DestroyEntities(std::span<const EntityHandle> handles) {
+    pendingDestroy_.insert(pendingDestroy_.end(), handles.begin(), handles.end());
+}
+
+void World::FlushDestroyed() {
+    if (pendingDestroy_.empty())
+        return;
+
+    // the root is not something scripts get to delete
+    EntityHandle root = worldRoot_ ? worldRoot_->GetHandle() : EntityHandle{};
+    bool lightRemoved = false;
+    for (EntityHandle& handle : pendingDestroy_) {
+        if (handle == root) {
+            handle = {};
+            continue;
+        }
+        spatial_.Remove(handle);
+        if (store_.Contains(handle) && dynamic_cast<const LightEntity*>(store_.GetEntity(handle).get()))
+            lightRemoved = true;
+    }
+
+    store_.Destroy(pendingDestroy_);
+    pendingDestroy_.clear();
+
+    if (lightRemoved)
+        std::erase_if(lights_, [](const auto& light) { return !light->IsAttached(); });
 }
 
 void World::SetCamera(Camera& camera) {
     //THIS FUCK WAS CAUSING ME TO GET ACCESS VIOLATED SINCE IT WAS A FUCKING SHARED_PTR... FUCK SHARED_PTRS...
-    camera_ = camera;
+    camera_ = &camera;
+}
+
+const Camera& World::GetCamera() const {
+    return *camera_;
 }
 
-Camera World::GetCamera() const {
-    return camera_;
+//
+// === Spatial queries ===
+//
+void World::SyncSpatialIndex() {
+    store_.UpdateTransforms();
+    spatial_.Update(store_);
 }
 
+std::shared_ptr<BaseEntity> World::Pick(float ndcX, float ndcY, float aspectRatio, float* distance) {
+    SyncSpatialIndex();
+    // far plane of the projection DrawAll uses
+    glm::vec3 direction = camera_->GetRayDirection(ndcX, ndcY, aspectRatio);
+    return GetEntity(spatial_.Raycast(camera_->GetPosition(), direction, 100.0f, distance));
+}
+
+//
+// === Rendering ===
+//
 void World::DrawAll(float aspectRatio) {
-    if (entities_.empty())
+    Extract(front_, aspectRatio);
+    front_.ReleaseRetired();
+    Render(front_);
+}
+
+void World::Extract(RenderSnapshot& snapshot, float aspectRatio) {
+    // frame boundary: nothing is iterating the store yet
+    FlushDestroyed();
+    snapshot.Reset();
+
+    // same projection Renderable::Draw uses, the clusters have to match it
+    snapshot.view = camera_->GetViewMatrix();
+    snapshot.projection = glm::perspective(glm::radians(camera_->GetZoom()), aspectRatio, 0.1f, 100.0f);
+    snapshot.cameraPosition = camera_->GetPosition();
+    snapshot.fov = camera_->GetZoom();
+    snapshot.aspectRatio = aspectRatio;
+
+    SyncSpatialIndex();
+    for (const auto& entity : lights_) {
+        const PointLight& light = entity->GetLight();
+        // world position, lights can sit under a parent
+        snapshot.lights.push_back({glm::vec3(entity->GetModelMatrix()[3]), light.color, light.intensity, light.radius});
+    }
+
+    batchSlots_.clear();
+    if (cullingEnabled_) {
+        visible_.clear();
+        spatial_.QueryFrustum(snapshot.projection * snapshot.view, visible_);
+        snapshot.visibleCount = visible_.size();
+        for (EntityHandle handle : visible_)
+            ExtractEntity(snapshot, store_.IndexOf(handle));
+    } else {
+        snapshot.visibleCount = store_.Size();
+        for (uint32_t i = 0; i < store_.Size(); ++i)
+            ExtractEntity(snapshot, i);
+    }
+    visibleCount_ = snapshot.visibleCount;
+
+    // spare copies would keep meshes and textures of past frames alive
+    snapshot.TrimMaterials();
+}
+
+// Copies the renderable once per non-instanced entity and once per batch.
+void World::ExtractEntity(RenderSnapshot& snapshot, uint32_t index) {
+    const RenderHandle& handle = store_.RenderHandles()[index];
+    if (!handle.renderable)
         return;
 
-    for (auto& entity : entities_) {
-        if (entity)
-            entity->Draw(camera_, aspectRatio);
+    const glm::mat4& model = store_.Models()[index];
+    if (!handle.instanced) {
+        snapshot.items.push_back({model, snapshot.AddMaterial(*handle.renderable)});
+        return;
+    }
+
+    // entities only share a batch when the material drawn for all of them
+    // would draw each the same: unpacked primaries have to be the same texture
+    const Texture* texture = handle.renderable->GetPrimaryTexture();
+    bool packed = texture && texture->IsPacked();
+    const void* primary = packed ? static_cast<const void*>(texture->GetArray()) : texture;
+    auto [slot, inserted] = batchSlots_.try_emplace(
+        {handle.shader, handle.mesh, primary, handle.renderable->GetMaterialHash()}, 0u);
+    if (inserted)
+        slot->second = snapshot.AddBatch(snapshot.AddMaterial(*handle.renderable));
+
+    InstanceData instance{};
+    instance.Model = model;
+    instance.TexRect = packed ? texture->GetRect() : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    instance.TexLayer = packed ? static_cast<float>(texture->GetLayer()) : 0.0f;
+    snapshot.batches[slot->second].instances.push_back(instance);
+}
+
+void World::Render(const RenderSnapshot& snapshot) {
+    drawCalls_ = 0;
+    instancedCount_ = 0;
+    {
+        GpuProfiler::Zone zone("lighting");
+        lighting_.Update(snapshot.lights, snapshot.view, snapshot.fov, snapshot.aspectRatio, 0.1f, 100.0f);
     }
+
+    for (const RenderSnapshot::Item& item : snapshot.items) {
+        const Renderable& material = snapshot.materials[item.material];
+        if (!material.IsValid())
+            continue;
+        const Shader& shader = *material.GetShader();
+        material.Apply(snapshot.view, snapshot.projection, &lighting_);
+        shader.SetVec3("viewPos", snapshot.cameraPosition);
+        shader.SetMat4("model", item.model);
+        material.GetMesh()->Draw(shader);
+        ++drawCalls_;
+    }
+
+    GpuProfiler::Zone zone("instanced");
+    if (!instanceBuffer_)
+        glGenBuffers(1, &instanceBuffer_);
+
+    for (size_t b = 0; b < snapshot.batchCount; ++b) {
+        const RenderSnapshot::Batch& batch = snapshot.batches[b];
+        size_t bytes = batch.instances.size() * sizeof(InstanceData);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+        if (bytes > instanceCapacity_)
+            instanceCapacity_ = bytes * 2;
+        // orphan every time so the driver doesn't wait on the previous batch
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instanceCapacity_), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), batch.instances.data());
+
+        const Renderable& material = snapshot.materials[batch.material];
+        const Shader& shader = *material.GetShader();
+        material.Apply(snapshot.view, snapshot.projection, &lighting_);
+        shader.SetVec3("viewPos", snapshot.cameraPosition);
+        material.GetMesh()->DrawInstanced(shader, instanceBuffer_, static_cast<GLsizei>(batch.instances.size()));
+
+        ++drawCalls_;
+        instancedCount_ += batch.instances.size();
+    }
+}
+
+//
+// Update and extraction run as one job; the GL thread renders the snapshot
+// extracted by the previous frame meanwhile.
+//
+void World::BeginFrame(float deltaTime, float aspectRatio) {
+    // GL objects only die on this thread: entities destroyed since the last
+    // frame, and whatever back_ alone still holds from two frames ago
+    FlushDestroyed();
+    // param changes can load and replace meshes and shaders, so they are
+    // synced before looking for what back_ alone still holds
+    SyncParams();
+    back_.ReleaseUnshared();
+    autosave_.Update(deltaTime);
+    JobSystem::Instance().Schedule(
+        [this, deltaTime, aspectRatio]() {
+            Simulate(deltaTime);
+            Extract(back_, aspectRatio);
+        },
+        &updating_);
+}
+
+void World::EndFrame() {
+    JobSystem::Instance().Wait(updating_);
+    // what the extraction replaced goes here, on the GL thread
+    back_.ReleaseRetired();
+    std::swap(front_, back_);
 }
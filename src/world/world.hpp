@@ -3,8 +3,24 @@
 
 #include "../rendering/camera/camera.hpp"
 #include "../entity/base_entity.hpp"
+#include "../entity/entity_store.hpp"
+#include "../entity/light_entity.hpp"
+#include "../rendering/lighting/clustered_lighting.hpp"
 #include "../rendering/shader.hpp"
+#include "../jobs/job_system.hpp"
+#include "autosave.hpp"
+#include "behavior_system.hpp"
+#include "param_binder.hpp"
+#include "render_snapshot.hpp"
+#include "spatial_index.hpp"
+#include "tween_system.hpp"
+#include "world_arena.hpp"
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 class World : public BaseEntity {
@@ -19,32 +35,186 @@ class World : public BaseEntity {
         const char* name = "Entity"
     );
 
+    std::shared_ptr<LightEntity> CreateLight(
+        const glm::vec3& position,
+        const PointLight& light = PointLight{},
+        const char* name = "Light"
+    );
+
     void AddEntity(std::shared_ptr<BaseEntity> entity);
     void RemoveEntity(const std::shared_ptr<BaseEntity>& entity);
     void Clear();
 
+    // Spawns count copies of prototype (name, transform, params, renderable)
+    // under the root.
+    std::vector<std::shared_ptr<BaseEntity>> CreateEntities(size_t count, const BaseEntity& prototype);
+    // Loaders build detached entities in the world's arena with MakeEntity,
+    // fill them in and attach them all with AddEntities. parents[i] is the
+    // index of an earlier entity in the same span, or kNoParent for the root.
+    static constexpr uint32_t kNoParent = ~0u;
+    std::shared_ptr<BaseEntity> MakeEntity(bool light = false);
+    void AddEntities(std::span<const std::shared_ptr<BaseEntity>> entities, std::span<const uint32_t> parents);
+    // Queued until the next frame boundary (FlushDestroyed), so passes that are
+    // iterating the store are never invalidated. Stale handles are ignored.
+    void DestroyEntities(std::span<const EntityHandle> handles);
+    void FlushDestroyed();
+
+    // Entities live under the world root unless parented elsewhere; a null
+    // parent means the root. Transforms are local to the parent.
+    bool SetParent(const std::shared_ptr<BaseEntity>& child, const std::shared_ptr<BaseEntity>& parent);
+    std::shared_ptr<BaseEntity> GetParent(const std::shared_ptr<BaseEntity>& child) const;
+    const std::shared_ptr<BaseEntity>& GetRoot() const { return worldRoot_; }
+    size_t GetPendingDestroyCount() const { return pendingDestroy_.size(); }
+
+    // The world keeps a pointer, so the camera has to outlive it (or be
+    // replaced); until then it draws from a default camera.
     void SetCamera(Camera& camera);
-    Camera GetCamera() const;
+    const Camera& GetCamera() const;
 
+    // ===== Simulation =====
+    // Runs behaviors in fixed steps for the dt that passed (an accumulator
+    // carries the remainder), then blends the last two steps into the
+    // transforms DrawAll sees. A long hitch runs at most kMaxSteps steps and
+    // drops the rest rather than falling further behind.
+    // Starts at the param sync point (SyncParams).
+    void Update(float deltaTime);
+    // Hands the param changes since the last sync to the store's
+    // subscribers (ParamBinder: transforms, renderables, lights, uniforms).
+    // Main thread; Update and BeginFrame call it. Returns the change count.
+    size_t SyncParams() { return store_.SyncParams(); }
+    const ParamBinder& GetParamBinder() const { return binder_; }
+    // Behaviors need the entity to be alive; false otherwise.
+    bool AddBehavior(const std::shared_ptr<BaseEntity>& entity, Behavior behavior);
+    size_t RemoveBehaviors(const std::shared_ptr<BaseEntity>& entity);
+    const BehaviorSystem& GetBehaviors() const { return behaviors_; }
+    // Animates a numeric param from its current value to target; tweens
+    // advance once per Update by the frame's dt, after the behaviors, and
+    // replace any tween already on that param.
+    bool AddTween(const std::shared_ptr<BaseEntity>& entity, std::string_view param, const CParams::Value& target,
+                  const Tween& tween);
+    size_t RemoveTweens(const std::shared_ptr<BaseEntity>& entity);
+    TweenSystem& GetTweens() { return tweens_; }
+    const TweenSystem& GetTweens() const { return tweens_; }
+    void SetFixedStep(float seconds) { fixedStep_ = std::max(seconds, 1e-4f); }
+    float GetFixedStep() const { return fixedStep_; }
+    // How far between the last two steps the presented transforms are, [0, 1).
+    float GetInterpolationAlpha() const { return alpha_; }
+    int GetLastStepCount() const { return lastSteps_; }
+
+    // ===== Autosave =====
+    // Off until enabled; snapshots at the frame boundary (right after the
+    // param sync in Update and BeginFrame) and writes on its own thread.
+    Autosave& GetAutosave() { return autosave_; }
+    const Autosave& GetAutosave() const { return autosave_; }
+
+    // ===== Rendering =====
+    // Extract() copies what a frame draws into a snapshot (culling included),
+    // Render() draws one on the GL thread without touching the world.
+    // DrawAll does both back to back.
     void DrawAll(float aspectRatio);
-    size_t GetEntityCount() const { return entities_.size(); }
+    void Extract(RenderSnapshot& snapshot, float aspectRatio);
+    void Render(const RenderSnapshot& snapshot);
+
+    // Pipelined frames: BeginFrame() runs Update and Extract into the back
+    // snapshot on a worker, so the GL thread can Render(GetFrontSnapshot()),
+    // last frame's, meanwhile. Nothing may touch the world between the two;
+    // EndFrame() waits for the worker and swaps the snapshots.
+    void BeginFrame(float deltaTime, float aspectRatio);
+    void EndFrame();
+    const RenderSnapshot& GetFrontSnapshot() const { return front_; }
+    void SetPipelined(bool enabled) { pipelined_ = enabled; }
+    bool IsPipelined() const { return pipelined_; }
+    size_t GetEntityCount() const { return store_.Size(); }
+    size_t GetLightCount() const { return lights_.size(); }
+    const ClusteredLighting& GetLighting() const { return lighting_; }
+    size_t GetDrawCallCount() const { return drawCalls_; }
+    size_t GetInstancedCount() const { return instancedCount_; }
+    // Entities whose model matrix was rebuilt this frame.
+    std::span<const EntityHandle> GetChangedEntities() const { return store_.GetChanged(); }
+
+    // ===== Spatial queries =====
+    // Rebuilds dirty transforms and refits the index; DrawAll does this every
+    // frame, call it first when querying right after moving things.
+    void SyncSpatialIndex();
+    const SpatialIndex& GetSpatialIndex() const { return spatial_; }
+    // Entity under a point in NDC ([-1, 1], +y up) as seen from the camera,
+    // by bounds. Null if nothing is hit within the far plane.
+    std::shared_ptr<BaseEntity> Pick(float ndcX, float ndcY, float aspectRatio, float* distance = nullptr);
+    // Frustum culling in DrawAll through the index; off draws everything.
+    void SetCulling(bool enabled) { cullingEnabled_ = enabled; }
+    bool IsCullingEnabled() const { return cullingEnabled_; }
+    // Entities that survived culling last frame (renderable or not).
+    size_t GetVisibleCount() const { return visibleCount_; }
 
-    std::vector<std::shared_ptr<BaseEntity>> GetEntities() { return entities_; }
+    // Every entity in dense order, without copying or touching refcounts;
+    // invalidated by creating or destroying entities.
+    std::span<const std::shared_ptr<BaseEntity>> GetEntities() const { return store_.Entities(); }
 
-    std::shared_ptr<BaseEntity> GetEntity(const std::string &name) {
-        for (auto &e : entities_) {
-            if (e->GetName() == name) {
-                return e;
-            }
-        }
-        return nullptr;
+    EntityStore& GetStore() { return store_; }
+    const EntityStore& GetStore() const { return store_; }
+    // Entities, their names and params are allocated here; Clear() resets it.
+    const WorldArena& GetArena() const { return *arena_; }
+
+    // The oldest entity with that name, through the store's name index.
+    std::shared_ptr<BaseEntity> GetEntity(std::string_view name) const {
+        return GetEntity(store_.Find(name));
+    }
+
+    // Null when the handle is stale (entity removed since).
+    std::shared_ptr<BaseEntity> GetEntity(EntityHandle handle) const {
+        return store_.Contains(handle) ? store_.GetEntity(handle) : nullptr;
     }
+    bool IsAlive(EntityHandle handle) const { return store_.Contains(handle); }
 
 
   private:
-    std::vector<std::shared_ptr<BaseEntity>> entities_;
+    static constexpr int kMaxSteps = 8;
+    // a single dt above this (breakpoints, loading) counts as this much
+    static constexpr float kMaxDeltaTime = 0.25f;
+
+    // shader, mesh, primary texture (its array when packed), material hash:
+    // everything an instanced draw has to share
+    using BatchKey = std::tuple<const Shader*, const Mesh*, const void*, uint64_t>;
+
+    // Update without the sync, what BeginFrame runs on a worker.
+    void Simulate(float deltaTime);
+    void ExtractEntity(RenderSnapshot& snapshot, uint32_t index);
+    void AttachToRoot(EntityHandle handle);
+
+    // entities made through the world pin it through their control blocks,
+    // so it is released last no matter who still holds one
+    std::shared_ptr<WorldArena> arena_ = std::make_shared<WorldArena>();
+    EntityStore store_;
+    ParamBinder binder_{store_};
+    std::vector<std::shared_ptr<LightEntity>> lights_;
+    std::vector<EntityHandle> pendingDestroy_;
     std::shared_ptr<BaseEntity> worldRoot_;
-    Camera camera_;
+    Camera defaultCamera_;
+    Camera* camera_ = &defaultCamera_;
+    ClusteredLighting lighting_;
+    SpatialIndex spatial_;
+    BehaviorSystem behaviors_;
+    TweenSystem tweens_;
+    // declared after the store it reads, so it is stopped first
+    Autosave autosave_{*this};
+    float fixedStep_ = 1.0f / 60.0f;
+    float accumulator_ = 0.0f;
+    float alpha_ = 0.0f;
+    int lastSteps_ = 0;
+    std::vector<EntityHandle> visible_;
+    bool cullingEnabled_ = true;
+    size_t visibleCount_ = 0;
+
+    // batch of each key in the snapshot being extracted
+    std::map<BatchKey, uint32_t> batchSlots_;
+    RenderSnapshot front_;
+    RenderSnapshot back_;
+    JobCounter updating_;
+    bool pipelined_ = true;
+    GLuint instanceBuffer_ = 0;
+    size_t instanceCapacity_ = 0;
+    size_t drawCalls_ = 0;
+    size_t instancedCount_ = 0;
 };
 
 #endif // WORLD_HPP
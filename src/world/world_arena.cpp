@@ -0,0 +1,51 @@
+#include "world_arena.hpp"
+#include <new>
+
+namespace {
+
+// first chunk; the monotonic buffer grows the next ones geometrically
+constexpr size_t kInitialChunkBytes = 64 * 1024;
+
+std::pmr::pool_options PoolOptions() {
+    std::pmr::pool_options options;
+    // entities with their control block and a param map's bucket array stay pooled
+    options.largest_required_pool_block = 4096;
+    return options;
+}
+
+} // namespace
+
+void* WorldArena::Upstream::do_allocate(size_t bytes, size_t alignment) {
+    reserved += bytes;
+    ++chunks;
+    return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+void WorldArena::Upstream::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    reserved -= bytes;
+    --chunks;
+    ::operator delete(pointer, bytes, std::align_val_t(alignment));
+}
+
+WorldArena::WorldArena() : chunks_(kInitialChunkBytes, &upstream_), pools_(PoolOptions(), &chunks_) {}
+
+bool WorldArena::Reset() {
+    if (liveAllocations_ != 0)
+        return false;
+    pools_.release();
+    chunks_.release();
+    return true;
+}
+
+void* WorldArena::do_allocate(size_t bytes, size_t alignment) {
+    void* pointer = pools_.allocate(bytes, alignment);
+    liveBytes_ += bytes;
+    ++liveAllocations_;
+    return pointer;
+}
+
+void WorldArena::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    pools_.deallocate(pointer, bytes, alignment);
+    liveBytes_ -= bytes;
+    --liveAllocations_;
+}
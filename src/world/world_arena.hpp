@@ -0,0 +1,76 @@
+#ifndef WORLD_ARENA_HPP
+#define WORLD_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+//
+// === WorldArena ===
+// Memory resource for everything a World allocates per entity: the entity
+// objects with their shared_ptr control blocks, names and param maps. Memory
+// comes from large chunks handed out by bumping a pointer; freed blocks go to
+// per size free lists and are reused by the next allocation of that size, so
+// churn doesn't grow the arena. Reset() gives every chunk back at once.
+//
+// Not thread safe, like the rest of World.
+//
+class WorldArena : public std::pmr::memory_resource {
+  public:
+    WorldArena();
+
+    // Frees all chunks in one go. Only possible once nothing allocated from
+    // the arena is alive; returns false and keeps everything otherwise.
+    bool Reset();
+
+    [[nodiscard]] size_t GetLiveBytes() const { return liveBytes_; }
+    [[nodiscard]] size_t GetLiveAllocations() const { return liveAllocations_; }
+    // Bytes taken from the system in chunks.
+    [[nodiscard]] size_t GetReservedBytes() const { return upstream_.reserved; }
+    [[nodiscard]] size_t GetChunkCount() const { return upstream_.chunks; }
+
+  private:
+    // new/delete, counting what the chunks cost
+    struct Upstream : std::pmr::memory_resource {
+        size_t reserved = 0;
+        size_t chunks = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+
+    Upstream upstream_;
+    std::pmr::monotonic_buffer_resource chunks_;
+    std::pmr::unsynchronized_pool_resource pools_;
+    size_t liveBytes_ = 0;
+    size_t liveAllocations_ = 0;
+};
+
+//
+// === ArenaAllocator ===
+// Allocator for std::allocate_shared that holds on to the arena, so an entity
+// still referenced after its World is gone keeps the memory it lives in.
+//
+template <typename T> class ArenaAllocator {
+  public:
+    using value_type = T;
+
+    explicit ArenaAllocator(std::shared_ptr<WorldArena> arena) : arena_(std::move(arena)) {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T* pointer, size_t count) { arena_->deallocate(pointer, count * sizeof(T), alignof(T)); }
+
+    template <typename U> bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+
+  private:
+    template <typename> friend class ArenaAllocator;
+    std::shared_ptr<WorldArena> arena_;
+};
+
+#endif // WORLD_ARENA_HPP